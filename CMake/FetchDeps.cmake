@@ -13,4 +13,5 @@ set(GLFW_BUILD_EXAMPLES OFF CACHE BOOL "" FORCE)
 # Make GLFW available
 FetchContent_MakeAvailable(glfw)
 
-find_package(OpenGL REQUIRED)
\ No newline at end of file
+find_package(OpenGL REQUIRED OPTIONAL_COMPONENTS EGL)
+find_package(Threads REQUIRED)
\ No newline at end of file
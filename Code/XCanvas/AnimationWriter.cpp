@@ -0,0 +1,463 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "AnimationWriter.hpp"
+#include "ColorQuantizer.hpp"
+#include "Deflate.hpp"
+#include "ImageStreamWriter.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace X {
+    static void PutBE32(vector<u8>& out, u32 value) {
+        out.push_back(CAST<u8>(value >> 24));
+        out.push_back(CAST<u8>(value >> 16));
+        out.push_back(CAST<u8>(value >> 8));
+        out.push_back(CAST<u8>(value));
+    }
+
+    static void PutBE16(vector<u8>& out, u32 value) {
+        out.push_back(CAST<u8>(value >> 8));
+        out.push_back(CAST<u8>(value));
+    }
+
+    static void PutLE16(vector<u8>& out, u32 value) {
+        out.push_back(CAST<u8>(value));
+        out.push_back(CAST<u8>(value >> 8));
+    }
+
+    // Browsers show GIF delays of one hundredth or less as about a tenth of a second, so nothing shorter is written
+    static constexpr u32 kMinGifDelay = 2;
+
+    /// Whole ticks of @p rate per second between two times, rounded at both ends so lengths never drift
+    static u32 Ticks(f64 start, f64 end, f64 rate) {
+        const i64 ticks = std::llround(end * rate) - std::llround(start * rate);
+        return CAST<u32>(X_CLAMP(ticks, i64 {0}, i64 {65535}));
+    }
+
+    /**
+     * @brief GIF's variable-width LZW over palette indices, as the code size byte and data sub-blocks.
+     *
+     * The dictionary is a hash of (prefix code, index) pairs. When it fills at 4095 codes a clear code starts over.
+     */
+    static void CompressLzw(const u8* indices, size_t count, u32 minCodeSize, vector<u8>& out) {
+        static constexpr u32 kMaxCode   = 4095;
+        static constexpr u32 kTableBits = 13;
+        static constexpr u32 kTableSize = 1u << kTableBits;
+        static constexpr u32 kEmpty     = 0xFFFFFFFF;
+
+        const u32 clearCode = 1u << minCodeSize;
+        const u32 endCode   = clearCode + 1;
+        vector<u32> keys(kTableSize);
+        vector<u16> codes(kTableSize);
+        u32 width = 0;
+        u32 next  = 0;
+
+        vector<u8> stream;
+        u64 bits     = 0;
+        u32 bitCount = 0;
+        const auto emit = [&](u32 code) {
+            bits |= CAST<u64>(code) << bitCount;
+            bitCount += width;
+            while (bitCount >= 8) {
+                stream.push_back(CAST<u8>(bits));
+                bits >>= 8;
+                bitCount -= 8;
+            }
+        };
+        const auto reset = [&] {
+            std::fill(keys.begin(), keys.end(), kEmpty);
+            width = minCodeSize + 1;
+            next  = endCode + 1;
+        };
+
+        reset();
+        emit(clearCode);
+        u32 prefix = indices[0];
+        for (size_t i = 1; i < count; ++i) {
+            const u32 key = prefix << 8 | indices[i];
+            u32 slot      = (key * 2654435761u) >> (32 - kTableBits);
+            while (keys[slot] != kEmpty && keys[slot] != key) {
+                slot = (slot + 1) & (kTableSize - 1);
+            }
+            if (keys[slot] == key) {
+                prefix = codes[slot];
+                continue;
+            }
+
+            emit(prefix);
+            if (next <= kMaxCode) {
+                keys[slot]  = key;
+                codes[slot] = CAST<u16>(next);
+                // The decoder adds each code one step later, so it widens after reading the code that follows
+                if (next == (1u << width) && width < 12) { ++width; }
+                ++next;
+            } else {
+                emit(clearCode);
+                reset();
+            }
+            prefix = indices[i];
+        }
+        emit(prefix);
+        emit(endCode);
+        if (bitCount > 0) { stream.push_back(CAST<u8>(bits)); }
+
+        out.push_back(CAST<u8>(minCodeSize));
+        for (size_t offset = 0; offset < stream.size(); offset += 255) {
+            const size_t length = X_MIN(stream.size() - offset, size_t {255});
+            out.push_back(CAST<u8>(length));
+            out.insert(out.end(), stream.data() + offset, stream.data() + offset + length);
+        }
+        out.push_back(0);
+    }
+
+    AnimationWriter::AnimationWriter(JobSystem* jobs) : mJobSystem(jobs) {}
+
+    AnimationWriter::~AnimationWriter() {
+        if (mFile.is_open()) { Close(); }
+    }
+
+    bool AnimationWriter::Open(const string& path, AnimationFormat format, u32 width, u32 height, u32 playCount) {
+        if (mFile.is_open()) { Close(); }
+        if (width == 0 || height == 0 || width > 65535 || height > 65535) {
+            std::cerr << "Cannot write a " << width << "x" << height << " animation to " << path << "\n";
+            return false;
+        }
+
+        mFile.open(path, std::ios::binary | std::ios::trunc);
+        if (!mFile) {
+            std::cerr << "Failed to open " << path << " for writing\n";
+            return false;
+        }
+
+        mPath          = path;
+        mFormat        = format;
+        mWidth         = width;
+        mHeight        = height;
+        mPlayCount     = playCount;
+        mPrevious      = nullptr;
+        mHeld          = nullptr;
+        mTime          = 0.0;
+        mHasPending    = false;
+        mFramesWritten = 0;
+        mSequence      = 0;
+
+        vector<u8> header;
+        if (format == AnimationFormat::GIF) {
+            header.insert(header.end(), {'G', 'I', 'F', '8', '9', 'a'});
+            PutLE16(header, width);
+            PutLE16(header, height);
+            header.insert(header.end(), {0, 0, 0});  // No global palette, every frame brings its own
+
+            // NETSCAPE2.0 counts repeats after the first play; without it viewers play once
+            if (playCount != 1) {
+                header.insert(header.end(), {0x21, 0xFF, 11, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0'});
+                header.insert(header.end(), {3, 1});
+                PutLE16(header, playCount == 0 ? 0 : playCount - 1);
+                header.push_back(0);
+            }
+            mFile.write(RCAST<const char*>(header.data()), CAST<std::streamsize>(header.size()));
+            return CheckFile();
+        }
+
+        static constexpr u8 kSignature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        mFile.write(RCAST<const char*>(kSignature), sizeof(kSignature));
+        PutBE32(header, width);
+        PutBE32(header, height);
+        header.insert(header.end(), {8, 6, 0, 0, 0});  // 8-bit RGBA, deflate, adaptive filtering, no interlace
+        WriteChunk("IHDR", header.data(), header.size());
+
+        // The frame count isn't known yet; Close() rewrites this chunk in place
+        mControlOffset = mFile.tellp();
+        vector<u8> control;
+        PutBE32(control, 0);
+        PutBE32(control, playCount);
+        WriteChunk("acTL", control.data(), control.size());
+        return CheckFile();
+    }
+
+    bool AnimationWriter::AddFrame(const Image& frame, f64 duration) {
+        if (!mFile.is_open()) {
+            std::cerr << "AddFrame() called on an animation that isn't open\n";
+            return false;
+        }
+        if (frame.GetWidth() != mWidth || frame.GetHeight() != mHeight) {
+            std::cerr << "Skipping a " << frame.GetWidth() << "x" << frame.GetHeight() << " frame of the " << mWidth
+                      << "x" << mHeight << " animation " << mPath << "\n";
+            return false;
+        }
+
+        auto image      = make_shared<const Image>(frame);
+        const f64 start = mTime;
+        mTime += X_MAX(duration, 0.0);
+        if (mFormat != AnimationFormat::GIF) { return Submit(std::move(image), start, mTime); }
+
+        // A frame only goes out once the next one starts at least kMinGifDelay after it. One that starts sooner
+        // replaces it, showing from the held frame's start, which caps the animation at 50 fps.
+        if (mHeld && Ticks(mHeldStart, start, 100.0) < kMinGifDelay) {
+            mHeld = std::move(image);
+            return CheckFile();
+        }
+        const bool written = !mHeld || Submit(std::move(mHeld), mHeldStart, start);
+        mHeld              = std::move(image);
+        mHeldStart         = start;
+        return written;
+    }
+
+    bool AnimationWriter::Submit(shared_ptr<const Image> frame, f64 start, f64 end) {
+        auto slot           = make_unique<Slot>();
+        slot->frame         = std::move(frame);
+        slot->previous      = mPrevious;
+        slot->encoded.start = start;
+        slot->encoded.end   = end;
+        mPrevious           = slot->frame;
+
+        if (!mJobSystem) {
+            Encode(*slot);
+            Finish(*slot);
+            return CheckFile();
+        }
+
+        Slot* pending = slot.get();
+        mJobSystem->Schedule([this, pending] { Encode(*pending); }, pending->counter);
+        mSlots.push_back(std::move(slot));
+
+        // Keep every worker busy plus one frame queued, without holding more frames than that in memory
+        const size_t maxInFlight = mJobSystem->GetWorkerCount() + 2;
+        while (!mSlots.empty() && (mSlots.front()->counter.IsDone() || mSlots.size() > maxInFlight)) {
+            mJobSystem->Wait(mSlots.front()->counter);
+            Finish(*mSlots.front());
+            mSlots.pop_front();
+        }
+        return CheckFile();
+    }
+
+    bool AnimationWriter::Close() {
+        if (!mFile.is_open()) return false;
+
+        if (mHeld) { Submit(std::move(mHeld), mHeldStart, mTime); }
+
+        while (!mSlots.empty()) {
+            mJobSystem->Wait(mSlots.front()->counter);
+            Finish(*mSlots.front());
+            mSlots.pop_front();
+        }
+        if (mHasPending) { WritePending(); }
+        mPrevious = nullptr;
+
+        if (mFramesWritten == 0) {
+            std::cerr << "No frames were added to " << mPath << "\n";
+            mFile.close();
+            return false;
+        }
+
+        if (mFormat == AnimationFormat::GIF) {
+            mFile.put(0x3B);
+        } else {
+            WriteChunk("IEND", nullptr, 0);
+            mFile.seekp(mControlOffset);
+            vector<u8> control;
+            PutBE32(control, mFramesWritten);
+            PutBE32(control, mPlayCount);
+            WriteChunk("acTL", control.data(), control.size());
+        }
+
+        mFile.close();
+        return CheckFile();
+    }
+
+    void AnimationWriter::Encode(Slot& slot) const {
+        const Image& frame    = *slot.frame;
+        EncodedFrame& encoded = slot.encoded;
+        encoded.width         = mWidth;
+        encoded.height        = mHeight;
+
+        // Shrink to the rows, then the columns, that differ from the previous frame
+        if (const Image* previous = slot.previous.get()) {
+            const size_t stride = frame.GetStride();
+            u32 top             = 0;
+            while (top < mHeight && std::memcmp(frame.GetRow(top), previous->GetRow(top), stride) == 0) {
+                ++top;
+            }
+            if (top == mHeight) {
+                encoded.unchanged = true;
+                return;
+            }
+            u32 bottom = mHeight - 1;
+            while (std::memcmp(frame.GetRow(bottom), previous->GetRow(bottom), stride) == 0) {
+                --bottom;
+            }
+
+            u32 left  = mWidth;
+            u32 right = 0;
+            for (u32 y = top; y <= bottom; ++y) {
+                const u32* row   = RCAST<const u32*>(frame.GetRow(y));
+                const u32* above = RCAST<const u32*>(previous->GetRow(y));
+                for (u32 x = 0; x < left; ++x) {
+                    if (row[x] != above[x]) {
+                        left = x;
+                        break;
+                    }
+                }
+                for (u32 x = mWidth - 1; x > right; --x) {
+                    if (row[x] != above[x]) {
+                        right = x;
+                        break;
+                    }
+                }
+            }
+            right = X_MAX(right, left);
+
+            encoded.x      = left;
+            encoded.y      = top;
+            encoded.width  = right - left + 1;
+            encoded.height = bottom - top + 1;
+        }
+
+        if (mFormat == AnimationFormat::GIF) {
+            EncodeGif(frame, slot.previous.get(), encoded);
+        } else {
+            EncodeApng(frame, encoded);
+        }
+    }
+
+    void AnimationWriter::EncodeGif(const Image& frame, const Image* previous, EncodedFrame& encoded) const {
+        // Unchanged pixels become transparent and leave the previous frame showing; everything else is opaque
+        const size_t count = CAST<size_t>(encoded.width) * encoded.height;
+        vector<u32> pixels(count);
+        for (u32 y = 0; y < encoded.height; ++y) {
+            const u32* row   = RCAST<const u32*>(frame.GetRow(encoded.y + y)) + encoded.x;
+            const u32* above = previous ? RCAST<const u32*>(previous->GetRow(encoded.y + y)) + encoded.x : nullptr;
+            u32* out         = pixels.data() + CAST<size_t>(y) * encoded.width;
+            for (u32 x = 0; x < encoded.width; ++x) {
+                out[x] = above && row[x] == above[x] ? 0 : row[x] | 0xFF000000;
+            }
+        }
+
+        ColorQuantizer quantizer;
+        quantizer.Build(pixels.data(), count);
+        vector<u8> indices(count);
+        quantizer.Map(pixels.data(), encoded.width, encoded.height, encoded.x, encoded.y, mDithering, indices.data());
+
+        const vector<u32>& palette = quantizer.GetPalette();
+        const bool transparent     = quantizer.HasTransparency();
+        const size_t entries       = palette.size() + (transparent ? 1 : 0);
+        u32 bits                   = 1;
+        while ((1u << bits) < entries) {
+            ++bits;
+        }
+
+        vector<u8>& out = encoded.bytes;
+        // Graphic control extension: keep the frame when the next is drawn, the delay is filled in when written
+        out.insert(out.end(), {0x21, 0xF9, 4, CAST<u8>(1 << 2 | (transparent ? 1 : 0)), 0, 0});
+        out.push_back(CAST<u8>(quantizer.GetTransparentIndex()));
+        out.push_back(0);
+
+        out.push_back(0x2C);
+        PutLE16(out, encoded.x);
+        PutLE16(out, encoded.y);
+        PutLE16(out, encoded.width);
+        PutLE16(out, encoded.height);
+        out.push_back(CAST<u8>(0x80 | (bits - 1)));  // Local palette of 2^bits entries
+        for (u32 i = 0; i < (1u << bits); ++i) {
+            const u32 color = i < palette.size() ? palette[i] : 0;
+            out.insert(out.end(), {CAST<u8>(color), CAST<u8>(color >> 8), CAST<u8>(color >> 16)});
+        }
+
+        CompressLzw(indices.data(), count, X_MAX(bits, 2u), out);
+    }
+
+    void AnimationWriter::EncodeApng(const Image& frame, EncodedFrame& encoded) const {
+        const size_t pixelBytes = CAST<size_t>(encoded.width) * 4;
+        const size_t rowBytes   = 1 + pixelBytes;
+        vector<u8> filtered(rowBytes * encoded.height);
+        vector<u8> scratch(pixelBytes * 4);
+        const vector<u8> zeros(pixelBytes, 0);
+        for (u32 y = 0; y < encoded.height; ++y) {
+            const u8* row   = frame.GetRow(encoded.y + y) + CAST<size_t>(encoded.x) * 4;
+            const u8* above = y > 0 ? row - frame.GetStride() : zeros.data();
+            PngStreamWriter::FilterRow(row, above, pixelBytes, scratch.data(), filtered.data() + y * rowBytes);
+        }
+
+        encoded.bytes.assign({0x78, 0x01});  // zlib, 32K window
+        Deflate::Compress(filtered.data(), filtered.size(), 0, true, encoded.bytes);
+        PutBE32(encoded.bytes, Deflate::Adler32(1, filtered.data(), filtered.size()));
+    }
+
+    void AnimationWriter::Finish(Slot& slot) {
+        slot.frame    = nullptr;
+        slot.previous = nullptr;
+        if (slot.encoded.unchanged && mHasPending) {
+            mPending.end = slot.encoded.end;
+            return;
+        }
+
+        if (mHasPending) { WritePending(); }
+        mPending    = std::move(slot.encoded);
+        mHasPending = true;
+    }
+
+    void AnimationWriter::WritePending() {
+        EncodedFrame& frame = mPending;
+        mHasPending         = false;
+
+        if (mFormat == AnimationFormat::GIF) {
+            // Hundredths of a second. Only the last frame can be shorter than the minimum, see AddFrame().
+            const u32 delay = X_MAX(Ticks(frame.start, frame.end, 100.0), kMinGifDelay);
+            frame.bytes[4]  = CAST<u8>(delay);
+            frame.bytes[5]  = CAST<u8>(delay >> 8);
+            mFile.write(RCAST<const char*>(frame.bytes.data()), CAST<std::streamsize>(frame.bytes.size()));
+            ++mFramesWritten;
+            return;
+        }
+
+        vector<u8> control;
+        PutBE32(control, mSequence++);
+        PutBE32(control, frame.width);
+        PutBE32(control, frame.height);
+        PutBE32(control, frame.x);
+        PutBE32(control, frame.y);
+        PutBE16(control, Ticks(frame.start, frame.end, 1000.0));  // Delay in milliseconds
+        PutBE16(control, 1000);
+        control.insert(control.end(), {0, 0});  // Leave the frame in place, replace the rectangle's pixels
+        WriteChunk("fcTL", control.data(), control.size());
+
+        // The first frame doubles as the still image for viewers without APNG support
+        if (mFramesWritten == 0) {
+            WriteChunk("IDAT", frame.bytes.data(), frame.bytes.size());
+        } else {
+            vector<u8> sequence;
+            PutBE32(sequence, mSequence++);
+            WriteChunk("fdAT", frame.bytes.data(), frame.bytes.size(), sequence.data(), sequence.size());
+        }
+        ++mFramesWritten;
+    }
+
+    void AnimationWriter::WriteChunk(
+      const char* type, const u8* data, size_t size, const u8* prefix, size_t prefixSize) {
+        vector<u8> header;
+        PutBE32(header, CAST<u32>(prefixSize + size));
+        header.insert(header.end(), type, type + 4);
+        if (prefix) { header.insert(header.end(), prefix, prefix + prefixSize); }
+
+        u32 crc = Deflate::Crc32(0, header.data() + 4, header.size() - 4);
+        crc     = Deflate::Crc32(crc, data, size);
+
+        vector<u8> footer;
+        PutBE32(footer, crc);
+
+        mFile.write(RCAST<const char*>(header.data()), CAST<std::streamsize>(header.size()));
+        if (size > 0) { mFile.write(RCAST<const char*>(data), CAST<std::streamsize>(size)); }
+        mFile.write(RCAST<const char*>(footer.data()), CAST<std::streamsize>(footer.size()));
+    }
+
+    bool AnimationWriter::CheckFile() {
+        if (mFile) return true;
+
+        std::cerr << "Failed to write " << mPath << "\n";
+        return false;
+    }
+}  // namespace X
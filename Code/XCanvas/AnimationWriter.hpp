@@ -0,0 +1,109 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+#include "Image.hpp"
+#include "JobSystem.hpp"
+
+#include <deque>
+#include <fstream>
+
+namespace X {
+    enum class AnimationFormat : u8 { GIF, APNG };
+
+    /**
+     * @brief Writes a sequence of RGBA8 frames to an animated GIF or APNG.
+     *
+     * Every frame after the first stores only the rectangle that changed since its predecessor, and a frame that
+     * changed nothing just extends how long the previous one shows. GIF frames each get a palette from
+     * ColorQuantizer: exact for rectangles of up to 255 colors, ordered-dithered otherwise. Unchanged pixels
+     * inside the rectangle stay transparent so the previous frame shows through. GIF has no partial alpha, so its
+     * frames are written opaque. APNG frames are lossless.
+     *
+     * GIF delays are whole hundredths of a second, and browsers play anything under two hundredths at about a
+     * tenth. GIFs are therefore capped at 50 fps: a frame starting less than two hundredths after the one before
+     * replaces it, so a 60 fps capture keeps two frames in three.
+     *
+     * AddFrame() copies the frame and, with a job system, encodes it as a job of its own. A frame depends only on
+     * itself and its predecessor, so several encode at once while finished ones are written in order. This is
+     * meant for exports: one frame's encode is long enough to hold up a WaitFrame() that helps with pending jobs.
+     */
+    class AnimationWriter {
+    public:
+        explicit AnimationWriter(JobSystem* jobs = nullptr);
+        ~AnimationWriter();
+
+        AnimationWriter(const AnimationWriter&)            = delete;
+        AnimationWriter& operator=(const AnimationWriter&) = delete;
+
+        /// @brief Start a @p width x @p height animation at @p path that plays @p playCount times, 0 for forever
+        bool Open(const string& path, AnimationFormat format, u32 width, u32 height, u32 playCount = 0);
+
+        /// @brief Append @p frame, shown for @p duration seconds. Blocks while too many earlier frames are encoding.
+        /// GIF frames are held until the next one shows whether they last long enough.
+        bool AddFrame(const Image& frame, f64 duration);
+
+        /// @brief Write the remaining frames and finish the file
+        bool Close();
+
+        /// @brief Dither GIF frames with more colors than a palette holds (on by default). Call before Open().
+        void SetDithering(bool enabled) {
+            mDithering = enabled;
+        }
+
+        /// @brief Frames in the file so far; unchanged frames merged into their predecessor don't count
+        X_ND u32 GetFramesWritten() const {
+            return mFramesWritten;
+        }
+
+    private:
+        struct EncodedFrame {
+            vector<u8> bytes;  // GIF: control extension, descriptor, palette and LZW data; APNG: the zlib stream
+            u32 x {0}, y {0}, width {0}, height {0};
+            bool unchanged {false};
+            f64 start {0.0}, end {0.0};
+        };
+
+        struct Slot {
+            shared_ptr<const Image> frame;
+            shared_ptr<const Image> previous;  // Null for the first frame
+            EncodedFrame encoded;
+            JobCounter counter;
+        };
+
+        /// @brief Queue @p frame, shown from @p start to @p end, for encoding
+        bool Submit(shared_ptr<const Image> frame, f64 start, f64 end);
+        void Encode(Slot& slot) const;
+        void EncodeGif(const Image& frame, const Image* previous, EncodedFrame& encoded) const;
+        void EncodeApng(const Image& frame, EncodedFrame& encoded) const;
+        void Finish(Slot& slot);
+        void WritePending();
+        /// @brief Write a PNG chunk whose data is @p prefix followed by @p data
+        void WriteChunk(
+          const char* type, const u8* data, size_t size, const u8* prefix = nullptr, size_t prefixSize = 0);
+        bool CheckFile();
+
+        JobSystem* mJobSystem;
+        std::ofstream mFile;
+        string mPath;
+        AnimationFormat mFormat {AnimationFormat::GIF};
+        u32 mWidth {0};
+        u32 mHeight {0};
+        bool mDithering {true};
+
+        std::deque<unique_ptr<Slot>> mSlots;  // Frames encoding, oldest first
+        shared_ptr<const Image> mPrevious;
+        shared_ptr<const Image> mHeld;  // GIF frame waiting to learn whether the next starts too soon after it
+        f64 mHeldStart {0.0};
+        f64 mTime {0.0};
+        EncodedFrame mPending;  // Written once the next frame shows whether it only extends this one
+        bool mHasPending {false};
+        u32 mFramesWritten {0};
+        u32 mSequence {0};                  // APNG chunk sequence number
+        std::streamoff mControlOffset {0};  // Of APNG's acTL chunk, rewritten with the frame count by Close()
+        u32 mPlayCount {0};
+    };
+}  // namespace X
@@ -4,11 +4,25 @@
 
 #include "Application.hpp"
 #include "Canvas.hpp"
+#include "Clock.hpp"
+#include "OpenGLRenderDevice.hpp"
 
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <random>
 #include <stdexcept>
 #include <sstream>
 
+#if defined(X_HAS_EGL)
+    #define EGL_NO_X11
+    #define GLFW_EXPOSE_NATIVE_EGL
+    #include <GLFW/glfw3native.h>
+    #include <EGL/eglext.h>
+#endif
+
 namespace X {
     Application::Application(i32 argc, char* argv[]) {
         if (argc <= 0) { throw std::runtime_error("Attempted to initialize app with args length of zero or less."); }
@@ -22,6 +36,12 @@ namespace X {
             err << "Failed to capture correct number of arguments. Captured " << mArgs.size() << ", expected " << argc;
             throw std::runtime_error(err.str());
         }
+
+        mJobSystem  = make_unique<JobSystem>();
+        mImageSaver = make_unique<ImageSaver>(mJobSystem.get());
+
+        std::random_device device;
+        mSeed = (CAST<u64>(device()) << 32) | device();
     }
 
     Application::Application(i32 argc, char* argv[], const string& title) : Application(argc, argv) {
@@ -29,37 +49,162 @@ namespace X {
     }
 
     Application::~Application() {
+        StopRenderThread();
+        mImageSaver.reset();  // Finishes queued writes, which still encode on the workers
+        mJobSystem.reset();   // Join workers before anything their jobs might reference goes away
         if (mRootCanvas) { mRootCanvas.reset(); }  // Make sure canvas is reset before GLFW destroys the window context
+        ShutdownHeadless();
         if (mWindow) { glfwDestroyWindow(mWindow); }
-        glfwTerminate();
+        if (!mHeadless) { glfwTerminate(); }
     }
 
     void Application::OnStartup() {
         std::cout << " -- XCanvas application initialized: " << mTitle << "\n";
-        std::cout << " -- Created window with dimensions: " << mWidth << "x" << mHeight << "\n";
+        const char* target = mHeadless ? "offscreen target" : "window";
+        std::cout << " -- Created " << target << " with dimensions: " << mWidth << "x" << mHeight << "\n";
     }
 
     bool Application::Run() {
-        mRunning       = true;
-        mLastFrameTime = glfwGetTime();
+        mRunning = true;
         {
+            if (mHeadless && mUseRenderThread) {
+                std::cerr << "Render thread is not supported in headless mode, rendering on the main thread\n";
+                mUseRenderThread = false;
+            }
             Initialize();
 
             OnStartup();
 
-            while (mRunning && !glfwWindowShouldClose(mWindow)) {
-                const f64 currentTime = glfwGetTime();
-                const auto dT         = CAST<f32>(currentTime - mLastFrameTime);
-                mLastFrameTime        = currentTime;
-
-                OnUpdate(dT);
-                OnPaint(GetRootCanvas());
+            // Created after OnStartup() so the header captures a seed the app may have set there
+            if (!mRecordingPath.empty() && !mInputPlayer) {
+                mInputRecorder = make_unique<InputRecorder>(mRecordingPath, mSeed, mWidth, mHeight);
+            }
+            if (!mCanvasRecordingPath.empty()) {
+                mCanvasRecorder = make_unique<CommandStreamRecorder>(mCanvasRecordingPath);
+                mRootCanvas->SetRecorder(mCanvasRecorder.get());
+            }
 
-                glfwSwapBuffers(mWindow);
-                glfwPollEvents();
+            mLastFrameTime   = Clock::Now();
+            mLastPresentTime = mLastFrameTime;
+            if (mUseRenderThread) { StartRenderThread(); }
+
+            while (mRunning && !ShouldClose()) {
+                if (mInputPlayer) {
+                    if (mWindow) { glfwPollEvents(); }  // Keep the window system serviced; live input is discarded
+                    if (!mInputPlayer->ReadFrame(mReplayFrame)) break;
+                    if (mReplayFrame.width != mWidth || mReplayFrame.height != mHeight) {
+                        HandleResize(mReplayFrame.width, mReplayFrame.height);
+                    }
+                } else if (mRemoteCanvas) {
+                    // Frames come at the producer's pace; poll in between so the window stays responsive
+                    if (mWindow) { glfwPollEvents(); }
+                    if (!mRemoteCanvas->WaitForFrame(0.05)) continue;
+                } else if (mRenderMode == RenderMode::OnDemand && mWindow && !mCanvasPlayer) {
+                    WaitForRedraw();
+                } else {
+                    // Delay the frame start as the pacing mode asks, then sample input as late as possible
+                    mFramePacer.WaitForFrameStart();
+                    if (mWindow) { glfwPollEvents(); }
+                }
+                if (!mRunning || ShouldClose()) break;
+                if (mCanvasPlayer) {
+                    if (mCanvasReplayFrame == mCanvasPlayer->GetFrameCount()) break;
+                    const u32 width  = mCanvasPlayer->GetFrameWidth(mCanvasReplayFrame);
+                    const u32 height = mCanvasPlayer->GetFrameHeight(mCanvasReplayFrame);
+                    if (width != mWidth || height != mHeight) { HandleResize(width, height); }
+                } else if (mRemoteCanvas) {
+                    const u32 width  = mRemoteCanvas->GetFrameWidth();
+                    const u32 height = mRemoteCanvas->GetFrameHeight();
+                    if (width != mWidth || height != mHeight) { HandleResize(width, height); }
+                }
+
+                DispatchInput();
+                RunPostedJobs(mMainThreadJobs);
+                if (!mRenderThreadRunning) { RunPostedJobs(mRenderThreadJobs); }
+
+                const f64 currentTime = Clock::Now();
+                const f64 dT          = mInputPlayer ? mReplayFrame.deltaTime : currentTime - mLastFrameTime;
+                mLastFrameTime        = currentTime;
+                if (mInputRecorder) { mInputRecorder->EndFrame(dT, mWidth, mHeight); }
+
+                f32 alpha = 1.0f;
+                if (mFixedTimestep > 0.0) {
+                    mAccumulator += dT;
+                    for (u32 step = 0; step < mMaxStepsPerFrame && mAccumulator >= mFixedTimestep; ++step) {
+                        OnUpdate(CAST<f32>(mFixedTimestep));
+                        mAccumulator -= mFixedTimestep;
+                    }
+                    // Over the step cap, drop the backlog instead of spiraling
+                    if (mAccumulator >= mFixedTimestep) { mAccumulator = std::fmod(mAccumulator, mFixedTimestep); }
+                    alpha = CAST<f32>(mAccumulator / mFixedTimestep);
+                } else {
+                    OnUpdate(CAST<f32>(dT));
+                }
+
+                if (mCanvasPlayer) {
+                    mRootCanvas->Begin();
+                    if (!mCanvasPlayer->Replay(mCanvasReplayFrame, *mRootCanvas)) {
+                        std::cerr << "Canvas stream frame " << mCanvasReplayFrame << " is damaged\n";
+                    }
+                    mRootCanvas->End();
+                    ++mCanvasReplayFrame;
+                } else if (mRemoteCanvas) {
+                    mRemoteCanvas->ExecuteFrame(*mRootCanvas);
+                } else {
+                    OnPaint(GetRootCanvas(), alpha);
+                }
+                mJobSystem->WaitFrame();
+
+                if (mUseRenderThread) {
+                    const u64 published = mPublishedFrames.fetch_add(1, std::memory_order_acq_rel) + 1;
+                    mPublishedFrames.notify_one();
+
+                    // Don't run more than one frame ahead of the render thread unless explicitly uncapped
+                    if (mFramePacer.GetMode() != PacingMode::Uncapped) {
+                        u64 consumed = mConsumedFrames.load(std::memory_order_acquire);
+                        while (consumed < published && mRenderThreadRunning.load(std::memory_order_acquire)) {
+                            mConsumedFrames.wait(consumed, std::memory_order_acquire);
+                            consumed = mConsumedFrames.load(std::memory_order_acquire);
+                        }
+                    }
+                    continue;
+                }
+
+                if (mDamageTracking && !mRootCanvas->HasDamage()) {
+                    // Nothing changed; skip presenting and sleep until the next refresh or input instead of spinning
+                    if (mRenderMode == RenderMode::Continuous && mWindow) { glfwWaitEventsTimeout(mRefreshInterval); }
+                    continue;
+                }
+
+                const f64 workTime = Clock::Now() - currentTime;
+                Present();
+                TrackInputLatency();
+
+                EndFrame(workTime, Clock::Now());
             }
 
+            StopRenderThread();
+            ReleaseLatencyQueries();
+            if (mReadback) {
+                mReadback->Flush();
+                mReadback.reset();
+            }
+            mFrameCapture.reset();
+            if (mAnimation) {
+                mAnimation->Close();
+                mAnimation.reset();
+            }
+            mImageSaver->Flush();
+            DestroyOffscreenTarget();
             OnShutdown();
+
+            mInputRecorder.reset();
+            if (mCanvasRecorder) {
+                mRootCanvas->SetRecorder(nullptr);
+                mCanvasRecorder.reset();
+            }
+            mRemoteCanvas.reset();
+            if (mInputPlayer || mCanvasPlayer) { PrintReplaySummary(); }
         }
         mRunning = false;
 
@@ -68,19 +213,134 @@ namespace X {
 
     void Application::Quit() {
         mRunning = false;
+        if (mWindow) { glfwPostEmptyEvent(); }  // Wake WaitForRedraw()
+    }
+
+    void Application::SetFramePacing(PacingMode mode, f64 targetFps) {
+        mFramePacer.SetMode(mode, targetFps);
+        if (!mWindow) return;
+
+        // The swap interval belongs to the context, which the render thread owns while it runs
+        if (mRenderThreadRunning) {
+            mPendingSwapInterval = mFramePacer.GetSwapInterval();
+        } else {
+            glfwSwapInterval(mFramePacer.GetSwapInterval());
+        }
+    }
+
+    void Application::PostToMainThread(Job job) {
+        mMainThreadJobs.Push(std::move(job));
+        if (mRenderMode == RenderMode::OnDemand) { RequestRedraw(); }
+    }
+
+    void Application::RequestScreenshot(FrameCallback callback) {
+        PostToRenderThread([this, callback = std::move(callback)]() mutable {
+            mScreenshotRequests.push_back(std::move(callback));
+            // An unchanged scene would otherwise never present another frame to capture. Invalidating here, ahead of
+            // the next frame this thread executes, can't be consumed by a frame that won't serve the request.
+            if (mRootCanvas) { mRootCanvas->Invalidate(); }
+        });
+    }
+
+    void Application::SaveScreenshot(const string& path, ImageFormat format) {
+        RequestScreenshot([this, path, format](const Image& frame, u64) { mImageSaver->Save(frame, path, format); });
+    }
+
+    void Application::SetFrameCapture(unique_ptr<FrameCapture> capture) {
+        // Shared so the posted job stays copyable
+        PostToRenderThread([this, capture = shared_ptr<FrameCapture>(std::move(capture))] { mFrameCapture = capture; });
+    }
+
+    void Application::PostToRenderThread(Job job) {
+        mRenderThreadJobs.Push(std::move(job));
+        if (mRenderMode == RenderMode::OnDemand) { RequestRedraw(); }
+    }
+
+    void Application::RunPostedJobs(MpscQueue<Job>& queue) const {
+        // Always make progress, but stop once over budget so a burst of uploads can't stall the frame
+        const f64 deadline = Clock::Now() + mPostedJobBudget;
+        Job job;
+        while (queue.TryPop(job)) {
+            job();
+            if (Clock::Now() >= deadline) break;
+        }
+    }
+
+    void Application::RequestRedraw() {
+        mRedrawRequested.store(true, std::memory_order_release);
+        if (mWindow) { glfwPostEmptyEvent(); }
+    }
+
+    void Application::RequestRedrawAfter(f64 seconds) {
+        const f64 deadline = Clock::Now() + X_MAX(seconds, 0.0);
+        if (mRedrawDeadline <= 0.0 || deadline < mRedrawDeadline) { mRedrawDeadline = deadline; }
+    }
+
+    void Application::WaitForRedraw() {
+        // Input callbacks raise mRedrawRequested while events are processed here
+        glfwPollEvents();
+
+        while (!mRedrawRequested.exchange(false, std::memory_order_acq_rel)) {
+            if (!mRunning || glfwWindowShouldClose(mWindow)) return;
+
+            if (mRedrawDeadline > 0.0) {
+                const f64 remaining = mRedrawDeadline - Clock::Now();
+                if (remaining <= 0.0) {
+                    mRedrawDeadline = 0.0;
+                    return;
+                }
+                glfwWaitEventsTimeout(remaining);
+            } else {
+                glfwWaitEvents();
+            }
+        }
     }
 
     void Application::Initialize() {
+        const bool needsContext = mCanvasBackend == CanvasBackend::OpenGL;
+        if (!needsContext && !mHeadless) {
+            throw std::runtime_error("The software and null canvas backends require headless mode");
+        }
+
+        if (!mHeadless) {
+            InitializeWindow();
+        } else if (needsContext) {
+            InitializeHeadless();
+        }
+
+        mRootCanvas = std::make_unique<Canvas>(mWidth, mHeight, mCanvasBackend);
+        mRootCanvas->SetDamageTracking(mDamageTracking);
+        mRootCanvas->SetJobSystem(mJobSystem.get());
+        if (needsContext) { mReadback = make_unique<AsyncReadback>(); }
+        if (mHeadless) {
+            EnsureOffscreenTarget();
+        } else if (mDamageTracking) {
+            SetupDamagePresentation();
+        }
+    }
+
+    void Application::InitializeWindow() {
         if (!glfwInit()) { throw std::runtime_error("Failed to initialize GLFW"); }
 
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        if (mInputPlayer) { glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE); }
 #ifdef __APPLE__
         glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
+#if defined(X_HAS_EGL)
+        // Swap-with-damage is an EGL extension, prefer an EGL context when damage tracking is requested
+        if (mDamageTracking) { glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API); }
+#endif
 
         mWindow = glfwCreateWindow((i32)mWidth, (i32)mHeight, mTitle.c_str(), nullptr, nullptr);
+#if defined(X_HAS_EGL)
+        if (!mWindow && mDamageTracking) {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_NATIVE_CONTEXT_API);
+            mWindow = glfwCreateWindow((i32)mWidth, (i32)mHeight, mTitle.c_str(), nullptr, nullptr);
+        }
+#endif
         if (!mWindow) {
             glfwTerminate();
             throw std::runtime_error("Failed to create GLFW window");
@@ -89,61 +349,597 @@ namespace X {
         glfwMakeContextCurrent(mWindow);
         glfwSetWindowUserPointer(mWindow, this);
 
-        SetupOpenGL();
+        SetupOpenGL((GLADloadproc)glfwGetProcAddress);
 
         glfwSetKeyCallback(mWindow, KeyCallback);
         glfwSetMouseButtonCallback(mWindow, MouseButtonCallback);
         glfwSetCursorPosCallback(mWindow, CursorPosCallback);
+        glfwSetScrollCallback(mWindow, ScrollCallback);
         glfwSetFramebufferSizeCallback(mWindow, FramebufferSizeCallback);
+        glfwSetWindowRefreshCallback(mWindow, WindowRefreshCallback);
+
+        if (const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor()); mode && mode->refreshRate > 0) {
+            mRefreshInterval = 1.0 / mode->refreshRate;
+        }
+        mFramePacer.SetRefreshInterval(mRefreshInterval);
+        glfwSwapInterval(mFramePacer.GetSwapInterval());
+    }
 
-        glfwSwapInterval(1);
+    void Application::InitializeHeadless() {
+#if defined(X_HAS_EGL)
+        // Mesa's surfaceless platform needs no display server at all; anything else goes through the default display
+        EGLDisplay display           = EGL_NO_DISPLAY;
+        const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        if (clientExtensions && std::strstr(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+            const auto getPlatformDisplay =
+              RCAST<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+            if (getPlatformDisplay) {
+                display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            }
+        }
+        if (display == EGL_NO_DISPLAY) { display = eglGetDisplay(EGL_DEFAULT_DISPLAY); }
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+            throw std::runtime_error("Failed to initialize EGL display");
+        }
+        mEGLDisplay = display;
+
+        if (!eglBindAPI(EGL_OPENGL_API)) { throw std::runtime_error("EGL display does not support desktop OpenGL"); }
+
+        const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+        const bool surfaceless = extensions && std::strstr(extensions, "EGL_KHR_surfaceless_context");
+
+        // Rendering goes to a framebuffer object, the surface (if any) only exists to make the context current
+        const EGLint configAttributes[] = {EGL_SURFACE_TYPE,
+                                           surfaceless ? 0 : EGL_PBUFFER_BIT,
+                                           EGL_RENDERABLE_TYPE,
+                                           EGL_OPENGL_BIT,
+                                           EGL_RED_SIZE,
+                                           8,
+                                           EGL_GREEN_SIZE,
+                                           8,
+                                           EGL_BLUE_SIZE,
+                                           8,
+                                           EGL_NONE};
+        EGLConfig config   = nullptr;
+        EGLint configCount = 0;
+        if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+            throw std::runtime_error("No suitable EGL config for headless rendering");
+        }
+
+        // Software renderers such as llvmpipe may stop at 4.5
+        for (const EGLint minor : {6, 5}) {
+            const EGLint contextAttributes[] = {EGL_CONTEXT_MAJOR_VERSION,
+                                                4,
+                                                EGL_CONTEXT_MINOR_VERSION,
+                                                minor,
+                                                EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                                EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                                EGL_NONE};
+            mEGLContext = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+            if (mEGLContext != EGL_NO_CONTEXT) break;
+        }
+        if (mEGLContext == EGL_NO_CONTEXT) { throw std::runtime_error("Failed to create headless OpenGL 4.5 context"); }
 
-        mRootCanvas = std::make_unique<Canvas>(mWidth, mHeight);
+        if (!surfaceless) {
+            const EGLint surfaceAttributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+            mEGLSurface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+            if (mEGLSurface == EGL_NO_SURFACE) { throw std::runtime_error("Failed to create EGL pbuffer surface"); }
+        }
+
+        const EGLSurface surface = surfaceless ? EGL_NO_SURFACE : mEGLSurface;
+        if (!eglMakeCurrent(display, surface, surface, mEGLContext)) {
+            throw std::runtime_error("Failed to make headless context current");
+        }
+
+        SetupOpenGL((GLADloadproc)eglGetProcAddress);
+#else
+        throw std::runtime_error("Headless mode requires a build with EGL");
+#endif
     }
 
-    void Application::SetupOpenGL() const {
-        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-            glfwDestroyWindow(mWindow);
-            glfwTerminate();
-            throw std::runtime_error("Failed to initialize GLAD");
+    void Application::ShutdownHeadless() {
+#if defined(X_HAS_EGL)
+        if (!mHeadless || !mEGLDisplay) return;
+
+        eglMakeCurrent(mEGLDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (mEGLSurface) { eglDestroySurface(mEGLDisplay, mEGLSurface); }
+        if (mEGLContext) { eglDestroyContext(mEGLDisplay, mEGLContext); }
+        eglTerminate(mEGLDisplay);
+
+        mEGLDisplay = nullptr;
+        mEGLSurface = nullptr;
+        mEGLContext = nullptr;
+#endif
+    }
+
+    void Application::SetHeadless(bool enabled) {
+        mHeadless = enabled;
+        if (mHeadless) { mFramePacer.SetMode(PacingMode::Uncapped, 0.0); }
+    }
+
+    void Application::EnsureOffscreenTarget() {
+        if (mCanvasBackend != CanvasBackend::OpenGL) return;
+        if (mOffscreenFramebuffer != 0 && mOffscreenWidth == mWidth && mOffscreenHeight == mHeight) return;
+        DestroyOffscreenTarget();
+
+        glGenRenderbuffers(1, &mOffscreenRenderbuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, mOffscreenRenderbuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, (GLsizei)mWidth, (GLsizei)mHeight);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glGenFramebuffers(1, &mOffscreenFramebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, mOffscreenFramebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, mOffscreenRenderbuffer);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            throw std::runtime_error("Headless framebuffer is incomplete");
+        }
+
+        mOffscreenWidth  = mWidth;
+        mOffscreenHeight = mHeight;
+        if (auto* device = DCAST<OpenGLRenderDevice*>(&mRootCanvas->GetDevice())) {
+            device->SetOutputFramebuffer(mOffscreenFramebuffer);
+        }
+    }
+
+    void Application::DestroyOffscreenTarget() {
+        if (mOffscreenFramebuffer != 0) { glDeleteFramebuffers(1, &mOffscreenFramebuffer); }
+        if (mOffscreenRenderbuffer != 0) { glDeleteRenderbuffers(1, &mOffscreenRenderbuffer); }
+        mOffscreenFramebuffer  = 0;
+        mOffscreenRenderbuffer = 0;
+    }
+
+    void Application::CaptureFrame(u64 index) {
+        const bool deliver = mHeadless && (mFrameCallback || !mFrameOutputPrefix.empty() || !mAnimationPath.empty());
+        if (!deliver && mScreenshotRequests.empty() && !mFrameCapture) return;
+
+        // The null backend produces no pixels to capture
+        if (mCanvasBackend == CanvasBackend::Null) {
+            mScreenshotRequests.clear();
+            return;
         }
 
+        auto handle = [this, deliver, capture = mFrameCapture, requests = std::move(mScreenshotRequests)](
+                        const Image& frame, u64 tag) {
+            if (deliver) { DeliverFrame(frame, tag); }
+            if (capture) { capture->Submit(frame); }
+            for (const auto& request : requests) {
+                request(frame, tag);
+            }
+        };
+        mScreenshotRequests.clear();
+
+        if (const Image* image = mRootCanvas->GetImage()) {
+            handle(*image, index);
+            return;
+        }
+
+        // Read before the swap, while the back buffer still holds this frame
+        const GLuint framebuffer = mHeadless ? mOffscreenFramebuffer : 0;
+        mReadback->Read(framebuffer,
+                        mRootCanvas->GetFrameWidth(),
+                        mRootCanvas->GetFrameHeight(),
+                        index,
+                        std::move(handle));
+    }
+
+    void Application::DeliverFrame(const Image& frame, u64 index) {
+        if (mFrameCallback) { mFrameCallback(frame, index); }
+        if (!mFrameOutputPrefix.empty()) {
+            char name[32];
+            std::snprintf(name,
+                          sizeof(name),
+                          "%06llu.%s",
+                          CAST<unsigned long long>(index),
+                          ImageStreamWriter::GetExtension(mFrameOutputFormat));
+            mImageSaver->Save(frame, mFrameOutputPrefix + name, mFrameOutputFormat);
+        }
+        if (!mAnimationPath.empty()) {
+            if (!mAnimation) {
+                mAnimation = make_unique<AnimationWriter>(mJobSystem.get());
+                if (!mAnimation->Open(mAnimationPath, mAnimationFormat, frame.GetWidth(), frame.GetHeight())) {
+                    mAnimation.reset();
+                    mAnimationPath.clear();  // Reported already; don't retry every frame
+                    return;
+                }
+            }
+            mAnimation->AddFrame(frame, mAnimationFrameDuration);
+        }
+    }
+
+    bool Application::ShouldClose() const {
+        return mWindow && glfwWindowShouldClose(mWindow);
+    }
+
+    void Application::SetupOpenGL(GLADloadproc loader) const {
+        // The destructor releases the window or headless context
+        if (!gladLoadGLLoader(loader)) { throw std::runtime_error("Failed to initialize GLAD"); }
+
         glViewport(0, 0, (i32)mWidth, (i32)mHeight);
 
-        // Enable depth testing (common OpenGL setup)
-        glEnable(GL_DEPTH_TEST);
+        // No depth testing, Canvas batches rely on painter's order
+        glDisable(GL_DEPTH_TEST);
 
-        // Enable blending for transparency
+        // Enable blending for transparency. Alpha composites source-over so offscreen targets read back as opaque
+        // wherever an opaque background was drawn.
         glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    }
+
+    void Application::StartRenderThread() {
+        mRootCanvas->SetDeferredSubmission(true);
+        mPublishedFrames = 0;
+        mConsumedFrames  = 0;
+
+        // Hand the context over; it can only be current on one thread at a time
+        glfwMakeContextCurrent(nullptr);
+        mRenderThreadRunning = true;
+        mRenderThread        = std::thread(&Application::RenderThreadMain, this);
+    }
+
+    void Application::StopRenderThread() {
+        if (!mRenderThread.joinable()) return;
+
+        mRenderThreadRunning = false;
+        mPublishedFrames.fetch_add(1);
+        mPublishedFrames.notify_one();
+        mRenderThread.join();
+
+        // Take the context back so GL objects can be destroyed from this thread
+        glfwMakeContextCurrent(mWindow);
+        mRootCanvas->SetDeferredSubmission(false);
+    }
+
+    void Application::RenderThreadMain() {
+        glfwMakeContextCurrent(mWindow);
+        glfwSwapInterval(mFramePacer.GetSwapInterval());
+
+        u64 seen = 0;
+        while (true) {
+            mPublishedFrames.wait(seen, std::memory_order_acquire);
+            seen = mPublishedFrames.load(std::memory_order_acquire);
+            if (!mRenderThreadRunning.load(std::memory_order_acquire)) break;
+
+            if (const i32 interval = mPendingSwapInterval.exchange(-1); interval >= 0) { glfwSwapInterval(interval); }
+            RunPostedJobs(mRenderThreadJobs);
+
+            // Release the main thread as soon as the frame is ours so it can record the next one meanwhile. Frames
+            // where OnPaint() recorded nothing still count as consumed.
+            const bool acquired = mRootCanvas->AcquirePending();
+            mConsumedFrames.store(seen, std::memory_order_release);
+            mConsumedFrames.notify_one();
+            if (!acquired) continue;
+
+            const f64 workStart = Clock::Now();
+            mRootCanvas->ExecuteAcquired();
+            if (mDamageTracking && !mRootCanvas->HasDamage()) continue;
+
+            const f64 workTime = Clock::Now() - workStart;
+            Present();
+            TrackInputLatency();
+
+            EndFrame(workTime, Clock::Now());
+        }
+
+        glfwMakeContextCurrent(nullptr);
+
+        // Unblock a main thread waiting on a frame that will never be consumed
+        mConsumedFrames.store(UINT64_MAX, std::memory_order_release);
+        mConsumedFrames.notify_one();
+    }
+
+    void Application::SetupDamagePresentation() {
+#if defined(X_HAS_EGL)
+        if (glfwGetWindowAttrib(mWindow, GLFW_CONTEXT_CREATION_API) != GLFW_EGL_CONTEXT_API) return;
+
+        EGLDisplay display = glfwGetEGLDisplay();
+        EGLSurface surface = glfwGetEGLSurface(mWindow);
+        if (display == EGL_NO_DISPLAY || surface == EGL_NO_SURFACE) return;
+
+        const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+        if (!extensions) return;
+
+        void* swapWithDamage = nullptr;
+        if (std::strstr(extensions, "EGL_KHR_swap_buffers_with_damage")) {
+            swapWithDamage = RCAST<void*>(eglGetProcAddress("eglSwapBuffersWithDamageKHR"));
+        } else if (std::strstr(extensions, "EGL_EXT_swap_buffers_with_damage")) {
+            swapWithDamage = RCAST<void*>(eglGetProcAddress("eglSwapBuffersWithDamageEXT"));
+        }
+        if (!swapWithDamage) return;
+
+        mEGLDisplay            = display;
+        mEGLSurface            = surface;
+        mSwapBuffersWithDamage = swapWithDamage;
+#endif
+    }
+
+    void Application::Present() {
+        // Hand out earlier reads first so frames reach their callbacks in order
+        if (mReadback) { mReadback->Poll(); }
+        CaptureFrame(mFrameIndex++);
+        if (mHeadless) return;
+
+#if defined(X_HAS_EGL)
+        if (mSwapBuffersWithDamage) {
+            // EGL damage rects are x, y, width, height with a bottom-left origin
+            const auto& damage = mRootCanvas->GetDamage();
+            vector<EGLint> rects;
+            rects.reserve(damage.size() * 4);
+            const auto height  = (f32)mRootCanvas->GetFrameHeight();
+            for (const auto& region : damage) {
+                const auto x0 = (EGLint)std::floor(region.left);
+                const auto x1 = (EGLint)std::ceil(region.right);
+                const auto y0 = (EGLint)std::floor(height - region.bottom);
+                const auto y1 = (EGLint)std::ceil(height - region.top);
+                rects.insert(rects.end(), {x0, y0, x1 - x0, y1 - y0});
+            }
+
+            const auto swapWithDamage = RCAST<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(mSwapBuffersWithDamage);
+            if (swapWithDamage(mEGLDisplay, mEGLSurface, rects.data(), (EGLint)damage.size())) return;
+        }
+#endif
+        glfwSwapBuffers(mWindow);
+    }
+
+    void Application::QueueInput(const InputEvent& event) {
+        // Keep the cursor move in order relative to the event that ends its run
+        if (event.type != InputEventType::CursorMove) { FlushCursorMove(); }
+        if (!mInputEvents.TryPush(event)) { ++mDroppedInputEvents; }
+        mRedrawRequested = true;
+    }
+
+    void Application::FlushCursorMove() {
+        if (!mHasPendingCursorMove) return;
+        mHasPendingCursorMove = false;
+        QueueInput(mPendingCursorMove);
+    }
+
+    void Application::DispatchInput() {
+        FlushCursorMove();
+        if (mDroppedInputEvents > 0) {
+            std::cerr << "Input queue overflowed, dropped " << mDroppedInputEvents << " events\n";
+            mDroppedInputEvents = 0;
+        }
+
+        InputEvent event;
+        f64 oldestInput = 0.0;
+        if (mInputPlayer) {
+            while (mInputEvents.TryPop(event)) {}
+
+            oldestInput = mReplayFrame.events.empty() ? 0.0 : Clock::Now();
+            for (auto& recorded : mReplayFrame.events) {
+                recorded.timestamp = oldestInput;
+                DeliverInput(recorded);
+            }
+        } else {
+            while (mInputEvents.TryPop(event)) {
+                if (oldestInput == 0.0) { oldestInput = event.timestamp; }
+                DeliverInput(event);
+            }
+        }
+
+        // Whatever End() submits next is the first frame that can reflect these events
+        if (oldestInput > 0.0) { mRootCanvas->MarkInput(oldestInput); }
+    }
+
+    void Application::DeliverInput(const InputEvent& event) {
+        if (mInputRecorder) { mInputRecorder->Record(event); }
+
+        mInputState.Apply(event);
+        switch (event.type) {
+            case InputEventType::KeyPress:
+                OnKeyPress(event.code);
+                break;
+            case InputEventType::KeyRelease:
+                OnKeyRelease(event.code);
+                break;
+            case InputEventType::KeyRepeat:
+                OnKeyRepeat(event.code);
+                break;
+            case InputEventType::MouseButtonPress:
+                OnMouseButtonPress(event.code);
+                break;
+            case InputEventType::MouseButtonRelease:
+                OnMouseButtonRelease(event.code);
+                break;
+            case InputEventType::CursorMove:
+                OnCursorMove(event.x, event.y);
+                break;
+            case InputEventType::Scroll:
+                OnScroll(event.x, event.y);
+                break;
+        }
+    }
+
+    void Application::HandleResize(u32 width, u32 height) {
+        mWidth  = width;
+        mHeight = height;
+        mRootCanvas->Resize(width, height);
+        if (mHeadless) { EnsureOffscreenTarget(); }
+        OnWindowResize(width, height);
+        mRedrawRequested = true;
+    }
+
+    void Application::ReplayInput(const string& path) {
+        mInputPlayer = make_unique<InputPlayer>(path);
+        mSeed        = mInputPlayer->GetSeed();
+        mWidth       = mInputPlayer->GetWidth();
+        mHeight      = mInputPlayer->GetHeight();
+        mFramePacer.SetMode(PacingMode::Uncapped, 0.0);
+    }
+
+    void Application::ReplayCanvas(const string& path) {
+        mCanvasPlayer = make_unique<CommandStreamPlayer>(path);
+        if (mCanvasPlayer->GetFrameCount() > 0) {
+            mWidth  = mCanvasPlayer->GetFrameWidth(0);
+            mHeight = mCanvasPlayer->GetFrameHeight(0);
+        }
+        mCanvasReplayFrame = 0;
+        mFramePacer.SetMode(PacingMode::Uncapped, 0.0);
+    }
+
+    void Application::ServeRemoteCanvas(const string& socketPath) {
+        mRemoteCanvas = make_unique<RemoteCanvasServer>(socketPath);
+    }
+
+    void Application::ServeSharedCanvas(const string& name) {
+        mRemoteCanvas = make_unique<SharedCanvasServer>(name);
+    }
+
+    void Application::PrintReplaySummary() const {
+        const auto print = [](const char* name, const Histogram& histogram) {
+            std::cout << std::fixed << std::setprecision(2) << name << ": mean " << histogram.GetMean() * 1000.0
+                      << " ms, p50 " << histogram.GetPercentile(0.5) * 1000.0 << " ms, p95 "
+                      << histogram.GetPercentile(0.95) * 1000.0 << " ms, p99 " << histogram.GetPercentile(0.99) * 1000.0
+                      << " ms, max " << histogram.GetMax() * 1000.0 << " ms\n";
+        };
+
+        std::cout << "Replayed " << mFrameStats.GetFrameTimes().GetCount() << " frames\n";
+        print("Frame time", mFrameStats.GetFrameTimes());
+        print("Work time", mFrameStats.GetWorkTimes());
+    }
+
+    void Application::TrackInputLatency() {
+        // Harvest finished queries in order, without ever waiting on the GPU
+        while (!mLatencyQueries.empty()) {
+            const LatencyQuery& pending = mLatencyQueries.front();
+
+            GLint available = GL_FALSE;
+            glGetQueryObjectiv(pending.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) break;
+
+            GLuint64 gpuTime = 0;
+            glGetQueryObjectui64v(pending.query, GL_QUERY_RESULT, &gpuTime);
+            const f64 completed = pending.cpuIssueTime + CAST<f64>(CAST<i64>(gpuTime) - pending.gpuIssueTime) * 1e-9;
+            {
+                std::lock_guard lock(mFrameStatsMutex);
+                mFrameStats.AddInputLatency(completed - pending.inputTime);
+            }
+
+            mFreeLatencyQueries.push_back(pending.query);
+            mLatencyQueries.erase(mLatencyQueries.begin());
+        }
+
+        const f64 inputTime = mRootCanvas->GetExecutedInputTime();
+        if (inputTime <= 0.0) return;
+
+        // CPU backends have finished the frame by the time it's presented
+        if (mCanvasBackend != CanvasBackend::OpenGL) {
+            std::lock_guard lock(mFrameStatsMutex);
+            mFrameStats.AddInputLatency(Clock::Now() - inputTime);
+            return;
+        }
+        if (mLatencyQueries.size() >= kMaxLatencyQueries) return;
+
+        LatencyQuery query {};
+        if (mFreeLatencyQueries.empty()) {
+            glGenQueries(1, &query.query);
+        } else {
+            query.query = mFreeLatencyQueries.back();
+            mFreeLatencyQueries.pop_back();
+        }
+        query.inputTime = inputTime;
+
+        // Pair the GPU clock with ours so the result can be expressed in Clock::Now() time
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        query.cpuIssueTime = Clock::Now();
+        query.gpuIssueTime = gpuNow;
+
+        glQueryCounter(query.query, GL_TIMESTAMP);
+        mLatencyQueries.push_back(query);
+    }
+
+    void Application::EndFrame(f64 workTime, f64 presentTime) {
+        mFramePacer.EndFrame(workTime, presentTime);
+
+        std::lock_guard lock(mFrameStatsMutex);
+        mFrameStats.AddFrame(presentTime - mLastPresentTime, workTime);
+        mLastPresentTime = presentTime;
+    }
+
+    void Application::ReleaseLatencyQueries() {
+        for (const auto& pending : mLatencyQueries) {
+            glDeleteQueries(1, &pending.query);
+        }
+        if (!mFreeLatencyQueries.empty()) {
+            glDeleteQueries(CAST<GLsizei>(mFreeLatencyQueries.size()), mFreeLatencyQueries.data());
+        }
+        mLatencyQueries.clear();
+        mFreeLatencyQueries.clear();
     }
 
     void Application::KeyCallback(GLFWwindow* window, i32 key, i32 scancode, i32 action, i32 mods) {
         auto* app = CAST<Application*>(glfwGetWindowUserPointer(window));
-        if (app) {
-            if (action == GLFW_PRESS) { app->OnKeyPress(key); }
+        if (!app || key < 0) return;  // GLFW_KEY_UNKNOWN
+
+        InputEvent event;
+        if (action == GLFW_PRESS) {
+            event.type = InputEventType::KeyPress;
+        } else if (action == GLFW_REPEAT) {
+            event.type = InputEventType::KeyRepeat;
+        } else {
+            event.type = InputEventType::KeyRelease;
         }
+        event.code      = CAST<u16>(key);
+        event.mods      = CAST<u16>(mods);
+        event.timestamp = Clock::Now();
+        app->QueueInput(event);
     }
 
     void Application::MouseButtonCallback(GLFWwindow* window, i32 button, i32 action, i32 mods) {
         auto* app = CAST<Application*>(glfwGetWindowUserPointer(window));
-        if (app) { app->OnMouseButtonPress(button); }
+        if (!app) return;
+
+        InputEvent event;
+        event.type = action == GLFW_PRESS ? InputEventType::MouseButtonPress : InputEventType::MouseButtonRelease;
+        event.code = CAST<u16>(button);
+        event.mods = CAST<u16>(mods);
+        // Report the button at the position it was clicked, not wherever a later move in this frame ended up
+        glfwGetCursorPos(window, &event.x, &event.y);
+        event.timestamp = Clock::Now();
+        app->QueueInput(event);
     }
 
     void Application::CursorPosCallback(GLFWwindow* window, f64 xpos, f64 ypos) {
         auto* app = CAST<Application*>(glfwGetWindowUserPointer(window));
-        if (app) { app->OnCursorMove(xpos, ypos); }
+        if (!app) return;
+
+        // Only the latest position of a run of moves is queued; high-rate mice report hundreds per frame. The run
+        // keeps the arrival time of its first move so latency is measured from the oldest unreflected input.
+        app->mPendingCursorMove.type = InputEventType::CursorMove;
+        app->mPendingCursorMove.x    = xpos;
+        app->mPendingCursorMove.y    = ypos;
+        if (!app->mHasPendingCursorMove) { app->mPendingCursorMove.timestamp = Clock::Now(); }
+        app->mHasPendingCursorMove = true;
+        app->mRedrawRequested      = true;
+    }
+
+    void Application::ScrollCallback(GLFWwindow* window, f64 xoffset, f64 yoffset) {
+        auto* app = CAST<Application*>(glfwGetWindowUserPointer(window));
+        if (!app) return;
+
+        InputEvent event;
+        event.type      = InputEventType::Scroll;
+        event.x         = xoffset;
+        event.y         = yoffset;
+        event.timestamp = Clock::Now();
+        app->QueueInput(event);
     }
 
     void Application::FramebufferSizeCallback(GLFWwindow* window, i32 width, i32 height) {
+        auto* app = CAST<Application*>(glfwGetWindowUserPointer(window));
+        // While replaying, window sizes come from the recording
+        if (app && !app->mInputPlayer) { app->HandleResize(width, height); }
+
+        // Canvas sets its own viewport per frame; this is only for code drawing outside it
+        if (app && !app->mRenderThreadRunning) { glViewport(0, 0, width, height); }
+    }
+
+    void Application::WindowRefreshCallback(GLFWwindow* window) {
         auto* app = CAST<Application*>(glfwGetWindowUserPointer(window));
         if (app) {
-            app->mWidth  = width;
-            app->mHeight = height;
-            app->GetRootCanvas()->Resize(width, height);
-            app->OnWindowResize(width, height);
+            if (app->mRootCanvas) { app->mRootCanvas->Invalidate(); }
+            app->mRedrawRequested = true;
         }
-
-        glViewport(0, 0, width, height);
     }
 }  // namespace X
\ No newline at end of file
@@ -8,59 +8,423 @@
 #include <GLFW/glfw3.h>
 
 #include "Shared.hpp"
+#include "AnimationWriter.hpp"
+#include "AsyncReadback.hpp"
+#include "Canvas.hpp"
+#include "CommandStream.hpp"
 #include "Input.hpp"
+#include "InputRecording.hpp"
+#include "FrameCapture.hpp"
+#include "FramePacer.hpp"
+#include "FrameStats.hpp"
+#include "Image.hpp"
+#include "ImageSaver.hpp"
+#include "JobSystem.hpp"
+#include "MpscQueue.hpp"
+#include "RemoteCanvas.hpp"
+#include "SharedCanvas.hpp"
+#include "SpscRing.hpp"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 namespace X {
-    class Canvas;
+
+    /// @brief How Application::Run() decides when to produce a frame
+    enum class RenderMode {
+        Continuous,  ///< Update and paint every refresh, for animation
+        OnDemand,    ///< Block until input, a timer or RequestRedraw() invalidates the frame
+    };
 
     class Application {
     public:
+        /// @brief Receives a headless frame or screenshot and the index of the frame it came from, counting from 0
+        using FrameCallback = std::function<void(const Image& frame, u64 index)>;
+
         explicit Application(i32 argc, char* argv[]);
         explicit Application(i32 argc, char* argv[], const string& title);
         virtual ~Application();
 
         virtual void OnUpdate(f32 dT) {};
         virtual void OnPaint(Canvas* canvas) {}
+        /// @brief Paint with the fraction (0-1) of a fixed step not yet simulated, see SetFixedTimestep()
+        virtual void OnPaint(Canvas* canvas, f32 alpha) {
+            OnPaint(canvas);
+        }
         virtual void OnStartup();
         virtual void OnShutdown() {}
         virtual void OnKeyPress(u32 keyCode) {}
+        virtual void OnKeyRelease(u32 keyCode) {}
+        virtual void OnKeyRepeat(u32 keyCode) {}
         virtual void OnMouseButtonPress(u32 buttonCode) {}
+        virtual void OnMouseButtonRelease(u32 buttonCode) {}
         virtual void OnWindowResize(u32 width, u32 height) {}
+        /// @brief Called at most once per run of consecutive cursor moves, with the latest position
         virtual void OnCursorMove(f64 posX, f64 posY) {}
+        virtual void OnScroll(f64 offsetX, f64 offsetY) {}
 
         bool Run();
         void Quit();
 
+        void SetRenderMode(RenderMode mode) {
+            mRenderMode = mode;
+        }
+
+        X_ND RenderMode GetRenderMode() const {
+            return mRenderMode;
+        }
+
+        /**
+         * @brief Move GL submission and presentation to a dedicated render thread. Call before Run().
+         *
+         * OnUpdate() and OnPaint() stay on the main thread, where the root canvas only records. Finished frames are
+         * handed over through a lock-free triple buffer and executed by the render thread, which owns the GL
+         * context. Recording frame N+1 overlaps executing frame N; unless pacing is Uncapped the main thread never
+         * runs more than one frame ahead.
+         */
+        void SetRenderThread(bool enabled) {
+            mUseRenderThread = enabled;
+        }
+
+        /// @brief Select vsync, uncapped, a fixed @p targetFps cap or late-start scheduling. Defaults to VSync.
+        void SetFramePacing(PacingMode mode, f64 targetFps = 0.0);
+
+        /**
+         * @brief Call OnUpdate() with a constant @p step (seconds) instead of the frame delta. 0 disables.
+         *
+         * Each frame runs as many steps as the elapsed time covers, up to @p maxStepsPerFrame; time beyond that is
+         * dropped so a slow frame can't snowball into ever more simulation work. OnPaint() receives the leftover
+         * fraction of a step for interpolating between the last two simulation states.
+         */
+        void SetFixedTimestep(f64 step, u32 maxStepsPerFrame = 8) {
+            mFixedTimestep    = step;
+            mMaxStepsPerFrame = X_MAX(maxStepsPerFrame, 1u);
+            mAccumulator      = 0.0;
+        }
+
+        /// @brief Snapshot of the frame statistics; with a render thread they are collected there
+        X_ND FrameStats GetFrameStats() const {
+            std::lock_guard lock(mFrameStatsMutex);
+            return mFrameStats;
+        }
+
+        void ResetFrameStats() {
+            std::lock_guard lock(mFrameStatsMutex);
+            mFrameStats.Reset();
+        }
+
+        /// @brief Schedule a frame in OnDemand mode. Safe to call from any thread.
+        void RequestRedraw();
+
+        /// @brief Schedule a frame @p seconds from now in OnDemand mode, e.g. for a blinking cursor. Main thread only.
+        void RequestRedrawAfter(f64 seconds);
+
         X_ND Canvas* GetRootCanvas() const {
             return mRootCanvas.get();
         }
 
+        /// @brief Shared worker pool. Jobs scheduled without a counter are waited on at the end of every frame.
+        X_ND JobSystem& GetJobSystem() const {
+            return *mJobSystem;
+        }
+
+        /// @brief Held keys/buttons, cursor position and modifiers as of the input delivered so far this frame
+        X_ND const InputState& GetInput() const {
+            return mInputState;
+        }
+
+        X_ND bool IsKeyDown(u16 key) const {
+            return mInputState.IsKeyDown(key);
+        }
+
+        X_ND bool IsMouseButtonDown(u16 button) const {
+            return mInputState.IsMouseButtonDown(button);
+        }
+
+        /// @brief Run @p job on the main thread at the start of an upcoming frame. Any thread, never blocks.
+        void PostToMainThread(Job job);
+
+        /**
+         * @brief Run @p job on the thread that owns the GL context, e.g. to upload data loaded elsewhere.
+         *
+         * That is the render thread when SetRenderThread() is enabled, the main thread otherwise. Any thread, never
+         * blocks.
+         */
+        void PostToRenderThread(Job job);
+
+        /// @brief Time each frame may spend running posted jobs per queue (default 2 ms); the rest waits a frame
+        void SetPostedJobBudget(f64 seconds) {
+            mPostedJobBudget = seconds;
+        }
+
+        /// @brief Seed for the app's own randomness, random by default. Replaying a recording restores its seed.
+        X_ND u64 GetSeed() const {
+            return mSeed;
+        }
+
+        void SetSeed(u64 seed) {
+            mSeed = seed;
+        }
+
+        /// @brief Write all input, window sizes and each frame's dT to @p path (see InputRecorder). Call before Run().
+        void RecordInput(const string& path) {
+            mRecordingPath = path;
+        }
+
+        /**
+         * @brief Drive the app from a recording made with RecordInput() instead of live input. Call before Run().
+         *
+         * The window stays hidden, pacing is uncapped and dT comes from the recording, so an app whose randomness
+         * derives from GetSeed() reruns the session frame for frame as fast as it can render. Run() returns at the end
+         * of the recording and prints the frame time distribution to stdout for comparison between builds.
+         */
+        void ReplayInput(const string& path);
+
+        /// @brief Write every root canvas frame's draw calls to @p path (see CommandStreamRecorder). Call before Run().
+        void RecordCanvas(const string& path) {
+            mCanvasRecordingPath = path;
+        }
+
+        /**
+         * @brief Paint the frames of a stream made with RecordCanvas() instead of calling OnPaint(). Call before Run().
+         *
+         * Each frame replays at the size it was recorded at, with uncapped pacing. Run() returns after the last one and
+         * prints the frame time distribution, so a captured scene doubles as a benchmark; combined with SetHeadless()
+         * and SetFrameOutput() it renders the scene offline. Throws if @p path isn't a command stream.
+         */
+        void ReplayCanvas(const string& path);
+
+        /**
+         * @brief Paint the frames a RemoteCanvas in another process sends to @p socketPath, instead of OnPaint().
+         *
+         * Each frame is painted as it arrives, at the size it was drawn at; in between the app only services its
+         * window. Producers may come and go while the app runs. Throws if @p socketPath can't be listened on. Call
+         * before Run().
+         */
+        void ServeRemoteCanvas(const string& socketPath);
+
+        /// @brief Like ServeRemoteCanvas(), for a SharedCanvas on this host. Throws if ring @p name can't be created.
+        void ServeSharedCanvas(const string& name);
+
         X_ND vector<string> GetArgs() const& {
             return mArgs;
         }
 
+        /// @brief Window or offscreen size to start with. Call before Run().
+        void SetSize(u32 width, u32 height) {
+            mWidth  = width;
+            mHeight = height;
+        }
+
+        /**
+         * @brief Render offscreen with no window and no display server. Call before Run().
+         *
+         * The context comes from EGL, on Mesa's surfaceless platform where available and a pbuffer on the default
+         * display otherwise, so it also runs on GPU-less machines through llvmpipe. Frames render into a framebuffer
+         * object of the app's size and are read back asynchronously for SetFrameCallback() and SetFrameOutput()
+         * instead of being swapped, so they arrive a frame or two late; the last ones are delivered when Run()
+         * returns. Pacing is uncapped and there is no window input: pair it with ReplayInput() or call Quit() when
+         * done. Run() throws if the build has no EGL.
+         */
+        void SetHeadless(bool enabled);
+
+        X_ND bool IsHeadless() const {
+            return mHeadless;
+        }
+
+        /// @brief Root canvas backend. Software and Null need no GPU or EGL but require headless mode.
+        void SetCanvasBackend(CanvasBackend backend) {
+            mCanvasBackend = backend;
+        }
+
+        void SetFrameCallback(FrameCallback callback) {
+            mFrameCallback = std::move(callback);
+        }
+
+        /// @brief Write every headless frame to "<pathPrefix>NNNNNN.<extension>" in the background, see GetImageSaver()
+        void SetFrameOutput(const string& pathPrefix, ImageFormat format = ImageFormat::PPM) {
+            mFrameOutputPrefix = pathPrefix;
+            mFrameOutputFormat = format;
+        }
+
+        /// @brief Collect every headless frame into an animation at @p path, finished when Run() returns
+        void SetAnimationOutput(const string& path, AnimationFormat format, f64 frameDuration = 1.0 / 60.0) {
+            mAnimationPath          = path;
+            mAnimationFormat        = format;
+            mAnimationFrameDuration = frameDuration;
+        }
+
+        /**
+         * @brief Capture the next presented frame, windowed or headless, and pass it to @p callback.
+         *
+         * OpenGL frames come back through an AsyncReadback a frame or two later, without stalling the loop; software
+         * frames right away. The callback runs on the thread presenting frames, the render thread when there is one.
+         * Nothing is captured with the null backend.
+         */
+        void RequestScreenshot(FrameCallback callback);
+
+        /// @brief RequestScreenshot() straight into a file, encoded and written by GetImageSaver()
+        void SaveScreenshot(const string& path, ImageFormat format = ImageFormat::PNG);
+
+        /**
+         * @brief Stream every presented frame into @p capture, windowed or headless; nullptr stops. Any thread.
+         *
+         * Frames take the screenshot path: OpenGL ones come back through the AsyncReadback ring while the next
+         * frames render, so capturing costs the presenting thread one copy per frame rather than a stall. Only
+         * presented frames are captured, so for a constant frame rate use continuous rendering without damage
+         * tracking. The previous capture is closed, once its queued frames are written, when it's replaced or Run()
+         * returns. Nothing is captured with the null backend.
+         */
+        void SetFrameCapture(unique_ptr<FrameCapture> capture);
+
+        /**
+         * @brief Background image writer shared by frame output and screenshots, encoding on GetJobSystem().
+         *
+         * Saving costs the calling thread one copy of the image; Run() returns only once everything queued is on disk.
+         */
+        X_ND ImageSaver& GetImageSaver() const {
+            return *mImageSaver;
+        }
+
         void SetTitle(const string& title) {
             mTitle = title;
         }
 
+        /**
+         * @brief Repaint and present only what changed each frame (see Canvas::SetDamageTracking). Call before Run().
+         *
+         * Frames with no damage skip the swap entirely. Where the platform supports EGL_KHR_swap_buffers_with_damage
+         * the changed regions are also passed on to the compositor.
+         */
+        void SetDamageTracking(bool enabled) {
+            mDamageTracking = enabled;
+        }
+
     protected:
         u32 mWidth {1280};
         u32 mHeight {720};
 
     private:
         void Initialize();
-        void SetupOpenGL() const;
+        void InitializeWindow();
+        void InitializeHeadless();
+        void ShutdownHeadless();
+        void EnsureOffscreenTarget();
+        void DestroyOffscreenTarget();
+        void CaptureFrame(u64 index);
+        void DeliverFrame(const Image& frame, u64 index);
+        X_ND bool ShouldClose() const;
+        void SetupOpenGL(GLADloadproc loader) const;
+        void SetupDamagePresentation();
+        void Present();
+        void WaitForRedraw();
+        void RunPostedJobs(MpscQueue<Job>& queue) const;
+        void QueueInput(const InputEvent& event);
+        void FlushCursorMove();
+        void DispatchInput();
+        void DeliverInput(const InputEvent& event);
+        void HandleResize(u32 width, u32 height);
+        void PrintReplaySummary() const;
+        void TrackInputLatency();
+        /// @brief Feed a presented frame to the pacer and the statistics, on the thread that presented it
+        void EndFrame(f64 workTime, f64 presentTime);
+        void ReleaseLatencyQueries();
+        void StartRenderThread();
+        void StopRenderThread();
+        void RenderThreadMain();
 
         static void KeyCallback(GLFWwindow* window, i32 key, i32 scancode, i32 action, i32 mods);
         static void MouseButtonCallback(GLFWwindow* window, i32 button, i32 action, i32 mods);
         static void CursorPosCallback(GLFWwindow* window, f64 xpos, f64 ypos);
+        static void ScrollCallback(GLFWwindow* window, f64 xoffset, f64 yoffset);
         static void FramebufferSizeCallback(GLFWwindow* window, i32 width, i32 height);
+        static void WindowRefreshCallback(GLFWwindow* window);
 
         GLFWwindow* mWindow {nullptr};
         string mTitle {"XCanvas Application"};
         bool mRunning {false};
         vector<string> mArgs;
         f64 mLastFrameTime {0.0};
+        f64 mRefreshInterval {1.0 / 60.0};
+        f64 mLastPresentTime {0.0};
+        f64 mFixedTimestep {0.0};
+        f64 mAccumulator {0.0};
+        u32 mMaxStepsPerFrame {8};
+        RenderMode mRenderMode {RenderMode::Continuous};
+        FramePacer mFramePacer;
+        FrameStats mFrameStats;
+        mutable std::mutex mFrameStatsMutex;
+        std::atomic<bool> mRedrawRequested {true};
+        f64 mRedrawDeadline {0.0};
         unique_ptr<Canvas> mRootCanvas;
+        unique_ptr<JobSystem> mJobSystem;
+        unique_ptr<ImageSaver> mImageSaver;
+        MpscQueue<Job> mMainThreadJobs;
+        MpscQueue<Job> mRenderThreadJobs;
+        f64 mPostedJobBudget {0.002};
+
+        // Window callbacks only queue events; DispatchInput() delivers them once per frame
+        SpscRing<InputEvent, 1024> mInputEvents;
+        InputEvent mPendingCursorMove;
+        bool mHasPendingCursorMove {false};
+        InputState mInputState;
+        u64 mDroppedInputEvents {0};
+
+        u64 mSeed {0};
+        string mRecordingPath;
+        unique_ptr<InputRecorder> mInputRecorder;
+        unique_ptr<InputPlayer> mInputPlayer;
+        InputFrame mReplayFrame;
+        string mCanvasRecordingPath;
+        unique_ptr<CommandStreamRecorder> mCanvasRecorder;
+        unique_ptr<CommandStreamPlayer> mCanvasPlayer;
+        u32 mCanvasReplayFrame {0};
+        unique_ptr<RemoteFrameSource> mRemoteCanvas;
+
+        // GPU timestamps written after the swap of frames that reflected new input, harvested by TrackInputLatency()
+        struct LatencyQuery {
+            u32 query;
+            f64 inputTime;
+            f64 cpuIssueTime;  // Clock::Now() and GL_TIMESTAMP sampled together when the query was issued
+            i64 gpuIssueTime;
+        };
+        static constexpr u32 kMaxLatencyQueries = 8;
+        vector<LatencyQuery> mLatencyQueries;  // In flight, oldest first
+        vector<u32> mFreeLatencyQueries;
+
+        bool mUseRenderThread {false};
+        std::thread mRenderThread;
+        std::atomic<bool> mRenderThreadRunning {false};
+        std::atomic<u64> mPublishedFrames {0};  // Frames handed off by the main thread
+        std::atomic<u64> mConsumedFrames {0};   // Frames picked up by the render thread
+        std::atomic<i32> mPendingSwapInterval {-1};
+
+        bool mDamageTracking {false};
+        // EGL objects for swap-with-damage, only resolved when the window's context is EGL (see Present()), or owned
+        // by the headless context
+        void* mEGLDisplay {nullptr};
+        void* mEGLSurface {nullptr};
+        void* mEGLContext {nullptr};
+        void* mSwapBuffersWithDamage {nullptr};
+
+        bool mHeadless {false};
+        CanvasBackend mCanvasBackend {CanvasBackend::OpenGL};
+        FrameCallback mFrameCallback;
+        string mFrameOutputPrefix;
+        ImageFormat mFrameOutputFormat {ImageFormat::PPM};
+        string mAnimationPath;
+        AnimationFormat mAnimationFormat {AnimationFormat::GIF};
+        f64 mAnimationFrameDuration {1.0 / 60.0};
+        unique_ptr<AnimationWriter> mAnimation;  // Opened by the first frame, encodes on mJobSystem
+        u64 mFrameIndex {0};
+        unique_ptr<AsyncReadback> mReadback;         // OpenGL backend only, owned by the presenting thread
+        vector<FrameCallback> mScreenshotRequests;  // Presenting thread only, see RequestScreenshot()
+        shared_ptr<FrameCapture> mFrameCapture;     // Presenting thread only; readbacks in flight hold it too
+        GLuint mOffscreenFramebuffer {0};
+        GLuint mOffscreenRenderbuffer {0};
+        u32 mOffscreenWidth {0};
+        u32 mOffscreenHeight {0};
     };
 }  // namespace X
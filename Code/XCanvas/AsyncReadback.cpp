@@ -0,0 +1,101 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "AsyncReadback.hpp"
+
+#include <cstring>
+#include <iostream>
+
+namespace X {
+    AsyncReadback::AsyncReadback(u32 bufferCount) : mSlots(X_MAX(bufferCount, 1u)) {
+        for (auto& slot : mSlots) {
+            glGenBuffers(1, &slot.buffer);
+        }
+    }
+
+    AsyncReadback::~AsyncReadback() {
+        for (auto& slot : mSlots) {
+            if (slot.fence) { glDeleteSync(slot.fence); }
+            glDeleteBuffers(1, &slot.buffer);
+        }
+    }
+
+    void AsyncReadback::Read(GLuint framebuffer, u32 width, u32 height, u64 tag, Callback callback) {
+        if (width == 0 || height == 0) return;
+
+        if (mPendingCount == mSlots.size()) {
+            ++mStallCount;
+            CompleteOldest(true);
+        }
+
+        Slot& slot      = mSlots[(mOldest + mPendingCount) % mSlots.size()];
+        const auto size = CAST<size_t>(width) * height * 4;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        if (slot.capacity < size) {
+            glBufferData(GL_PIXEL_PACK_BUFFER, CAST<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+            slot.capacity = size;
+        }
+
+        // With a pack buffer bound the pointer is an offset into it, so this returns before the pixels are copied
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, (GLsizei)width, (GLsizei)height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        slot.fence    = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot.width    = width;
+        slot.height   = height;
+        slot.tag      = tag;
+        slot.callback = std::move(callback);
+        ++mPendingCount;
+    }
+
+    void AsyncReadback::Poll() {
+        while (mPendingCount > 0 && CompleteOldest(false)) {}
+    }
+
+    void AsyncReadback::Flush() {
+        while (mPendingCount > 0) {
+            CompleteOldest(true);
+        }
+    }
+
+    bool AsyncReadback::CompleteOldest(bool wait) {
+        Slot& slot = mSlots[mOldest];
+
+        // The flush bit makes sure the fence actually reaches the GPU, a frame without a swap may never submit it
+        const GLuint64 timeout = wait ? GL_TIMEOUT_IGNORED : 0;
+        const GLenum status    = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+        if (status == GL_TIMEOUT_EXPIRED) return false;
+        if (status == GL_WAIT_FAILED) { std::cerr << "AsyncReadback - waiting on a readback fence failed\n"; }
+
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        // GL rows run bottom-up; flip while copying out of the mapping
+        const auto size = CAST<GLsizeiptr>(CAST<size_t>(slot.width) * slot.height * 4);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        const auto* pixels = CAST<const u8*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+        const bool mapped  = pixels != nullptr;
+        if (mapped) {
+            mImage.Resize(slot.width, slot.height);
+            const size_t stride = mImage.GetStride();
+            for (u32 y = 0; y < slot.height; ++y) {
+                std::memcpy(mImage.GetRow(slot.height - 1 - y), pixels + y * stride, stride);
+            }
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        } else {
+            std::cerr << "AsyncReadback - failed to map a readback buffer\n";
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        mOldest = (mOldest + 1) % CAST<u32>(mSlots.size());
+        --mPendingCount;
+
+        // Released before the callback runs, so the callback may issue another Read()
+        Callback callback = std::move(slot.callback);
+        if (callback && mapped) { callback(mImage, slot.tag); }
+        return true;
+    }
+}  // namespace X
@@ -0,0 +1,73 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include "Shared.hpp"
+#include "Image.hpp"
+
+#include <functional>
+
+namespace X {
+    /**
+     * @brief Non-blocking framebuffer readback through a ring of pixel pack buffers.
+     *
+     * Read() queues a glReadPixels into the next buffer of the ring and fences it, returning right away; the copy
+     * happens on the GPU's timeline. Poll() hands every read whose fence has signaled to its callback, oldest first,
+     * usually a frame or two after it was issued. Only when every buffer is still in flight does Read() wait, on the
+     * oldest one; GetStallCount() counts those waits so the ring can be sized.
+     *
+     * GL context thread only, and callbacks run there. The Image passed to a callback is top-down RGBA8 and only
+     * valid during the call.
+     */
+    class AsyncReadback {
+    public:
+        using Callback = std::function<void(const Image& image, u64 tag)>;
+
+        explicit AsyncReadback(u32 bufferCount = 3);
+        ~AsyncReadback();
+
+        AsyncReadback(const AsyncReadback&)            = delete;
+        AsyncReadback& operator=(const AsyncReadback&) = delete;
+
+        /// @brief Read @p width x @p height pixels of @p framebuffer's read buffer; @p tag is passed through
+        void Read(GLuint framebuffer, u32 width, u32 height, u64 tag, Callback callback);
+
+        /// @brief Deliver every completed read without waiting on the GPU
+        void Poll();
+
+        /// @brief Wait for and deliver every read still in flight
+        void Flush();
+
+        X_ND u32 GetPendingCount() const {
+            return mPendingCount;
+        }
+
+        X_ND u64 GetStallCount() const {
+            return mStallCount;
+        }
+
+    private:
+        struct Slot {
+            GLuint buffer {0};
+            size_t capacity {0};
+            GLsync fence {nullptr};
+            u32 width {0};
+            u32 height {0};
+            u64 tag {0};
+            Callback callback;
+        };
+
+        /// @brief Deliver the oldest pending read, waiting for it if @p wait is set. False if it wasn't ready.
+        bool CompleteOldest(bool wait);
+
+        vector<Slot> mSlots;
+        u32 mOldest {0};
+        u32 mPendingCount {0};
+        u64 mStallCount {0};
+        Image mImage;
+    };
+}  // namespace X
@@ -3,214 +3,279 @@
 //
 
 #include "Canvas.hpp"
-#include "Shaders.hpp"
+#include "CommandStream.hpp"
+#include "OpenGLRenderDevice.hpp"
+#include "SoftwareRasterizer.hpp"
 
 #include <iostream>
-#include <cmath>
 
 namespace X {
-    Canvas::Canvas(u32 width, u32 height) : mWidth(width), mHeight(height) {
-        InitShaders();
-        SetupBuffers();
+    static unique_ptr<RenderDevice> CreateRenderDevice(CanvasBackend backend) {
+        switch (backend) {
+            case CanvasBackend::Software:
+                return make_unique<SoftwareRasterizer>();
+            case CanvasBackend::Null:
+                return make_unique<NullRenderDevice>();
+            case CanvasBackend::OpenGL:
+            default:
+                return make_unique<OpenGLRenderDevice>();
+        }
     }
 
-    Canvas::~Canvas() {
-        glDeleteVertexArrays(1, &mVAO);
-        glDeleteBuffers(1, &mVBO);
-        glDeleteProgram(mShaderProgram);
+    Canvas::Canvas(u32 width, u32 height, CanvasBackend backend)
+        : Canvas(width, height, CreateRenderDevice(backend)) {}
+
+    Canvas::Canvas(u32 width, u32 height, unique_ptr<RenderDevice> device)
+        : mWidth(width), mHeight(height), mDevice(std::move(device)) {
+        X_ASSERT(mDevice, "Canvas::Canvas() - device cannot be null!");
+        SetTarget(nullptr);
     }
 
-    void Canvas::Clear(const Color& clearColor) const {
-        if (mShaderProgram == 0) { std::cout << "Canvas::Clear() - No currently bound shader program\n"; }
-        glClearColor(clearColor.R(), clearColor.G(), clearColor.B(), clearColor.A());
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    void Canvas::Clear(const Color& clearColor) {
+        if (!mRecording) {
+            mDevice->Clear(clearColor, mWidth, mHeight);
+            return;
+        }
+
+        // Everything recorded so far would be painted over, drop it
+        CanvasFrame& frame = mFrames.GetWriteBuffer();
+        frame.queue.Reset();
+        frame.clearColor   = clearColor;
+        frame.clearPending = true;
     }
 
     void Canvas::Resize(u32 width, u32 height) {
         if (width <= 0 || height <= 0) return;
-        mWidth  = width;
-        mHeight = height;
+        mWidth      = width;
+        mHeight     = height;
+        mFullDamage = true;
     }
 
-    void Canvas::Begin() const {
-        glUseProgram(mShaderProgram);
-        glBindVertexArray(mVAO);
+    void Canvas::SetDamageTracking(bool enabled) {
+        if (enabled == mDamageTracking) return;
+        mDamageTracking = enabled;
+        mFullDamage     = true;
+        mPreviousSignatures.clear();
     }
 
-    void Canvas::End() const {
-        if (mVAO != 0) glBindVertexArray(0);
-        if (mShaderProgram != 0) glUseProgram(0);
+    void Canvas::Begin() {
+        CanvasFrame& frame = mFrames.GetWriteBuffer();
+        frame.queue.Reset();
+        frame.clearPending = false;
+        mRecording         = true;
+        SetTarget(&frame.queue);
     }
 
-    void Canvas::DrawLine(const f32 x0, const f32 y0, const f32 x1, const f32 y1) const {
-        const vector<f32> vertices = {ScreenToClipX(x0), ScreenToClipY(y0), ScreenToClipX(x1), ScreenToClipY(y1)};
-        glUniform4f(mColorLocation, mStrokeColor.R(), mStrokeColor.G(), mStrokeColor.B(), mStrokeColor.A());
-        DrawVertices(vertices, GL_LINES);
-    }
+    void Canvas::End() {
+        CanvasFrame& frame = mFrames.GetWriteBuffer();
+        frame.width        = mWidth;
+        frame.height       = mHeight;
+        frame.inputTime    = mInputTime;
+        mInputTime         = 0.0;
+        mRecording         = false;
+        SetTarget(nullptr);
+        if (mRecorder) { mRecorder->Record(frame, true); }
+
+        if (mDeferredSubmission) {
+            mFrames.Publish();
+            return;
+        }
 
-    void Canvas::DrawLine(const Point& start, const Point& end) const {
-        DrawLine(start.x, start.y, end.x, end.y);
+        ExecuteFrame(frame);
     }
 
-    void Canvas::DrawRectangle(f32 x, f32 y, f32 width, f32 height, bool filled) const {
-        vector<f32> vertices;
-
-        if (filled) {
-            // Two triangles for filled rectangle
-            vertices = {ScreenToClipX(x),
-                        ScreenToClipY(y),
-                        ScreenToClipX(x + width),
-                        ScreenToClipY(y),
-                        ScreenToClipX(x + width),
-                        ScreenToClipY(y + height),
+    bool Canvas::AcquirePending() {
+        return mFrames.Acquire();
+    }
 
-                        ScreenToClipX(x),
-                        ScreenToClipY(y),
-                        ScreenToClipX(x + width),
-                        ScreenToClipY(y + height),
-                        ScreenToClipX(x),
-                        ScreenToClipY(y + height)};
+    void Canvas::ExecuteAcquired() {
+        ExecuteFrame(mFrames.GetReadBuffer());
+    }
 
-            glUniform4f(mColorLocation, mFillColor.R(), mFillColor.G(), mFillColor.B(), mFillColor.A());
-            DrawVertices(vertices, GL_TRIANGLES);
-        } else {
-            // Line loop for outline
-            vertices = {ScreenToClipX(x),
-                        ScreenToClipY(y),
-                        ScreenToClipX(x + width),
-                        ScreenToClipY(y),
-                        ScreenToClipX(x + width),
-                        ScreenToClipY(y + height),
-                        ScreenToClipX(x),
-                        ScreenToClipY(y + height)};
+    void Canvas::Execute(const CommandList& list) {
+        X_ASSERT(mRecording, "Canvas::Execute() must be called between Begin() and End()");
+        Append(list.GetQueue());
+    }
 
-            glUniform4f(mColorLocation, mStrokeColor.R(), mStrokeColor.G(), mStrokeColor.B(), mStrokeColor.A());
-            DrawVertices(vertices, GL_LINE_LOOP);
+    void Canvas::Execute(const vector<CommandList>& lists) {
+        for (const auto& list : lists) {
+            Execute(list);
         }
     }
 
-    void Canvas::DrawCircle(f32 x, f32 y, f32 radius, u32 segments, bool filled) const {
-        vector<f32> vertices;
+    void Canvas::Execute(const DrawCommand* commands, u32 count, const Point* points, u32 pointCount) {
+        X_ASSERT(mRecording, "Canvas::Execute() must be called between Begin() and End()");
+        Append(commands, count, points, pointCount);
+    }
 
-        if (filled) {
-            // Triangle fan for filled circle
-            vertices.push_back(ScreenToClipX(x));
-            vertices.push_back(ScreenToClipY(y));
+    bool Canvas::OnQueueFull() {
+        // Submitting early is only possible when this thread owns the context
+        if (mDeferredSubmission) { return CommandList::OnQueueFull(); }
 
-            for (int i = 0; i <= segments; ++i) {
-                const f32 angle = 2.0f * M_PI * i / segments;
-                vertices.push_back(ScreenToClipX(x + radius * cos(angle)));
-                vertices.push_back(ScreenToClipY(y + radius * sin(angle)));
-            }
+        CanvasFrame& frame = mFrames.GetWriteBuffer();
+        frame.width        = mWidth;
+        frame.height       = mHeight;
+        if (mRecorder) { mRecorder->Record(frame, false); }
+        ExecuteFrame(frame);
+        frame.queue.Reset();
 
-            glUniform4f(mColorLocation, mFillColor.R(), mFillColor.G(), mFillColor.B(), mFillColor.A());
-            DrawVertices(vertices, GL_TRIANGLE_FAN);
-        } else {
-            // Line loop for outline
-            for (int i = 0; i < segments; ++i) {
-                const f32 angle = 2.0f * M_PI * i / segments;
-                vertices.push_back(ScreenToClipX(x + radius * cos(angle)));
-                vertices.push_back(ScreenToClipY(y + radius * sin(angle)));
-            }
-
-            glUniform4f(mColorLocation, mStrokeColor.R(), mStrokeColor.G(), mStrokeColor.B(), mStrokeColor.A());
-            DrawVertices(vertices, GL_LINE_LOOP);
-        }
+        return true;
     }
 
-    void Canvas::DrawPolygon(const vector<Point>& points, bool filled) const {
-        if (points.size() < 3) return;
-
-        vector<f32> vertices;
-
-        if (filled) {
-            // Simple triangle fan (works for convex polygons)
-            for (const auto& point : points) {
-                vertices.push_back(ScreenToClipX(point.x));
-                vertices.push_back(ScreenToClipY(point.y));
+    void Canvas::ExecuteFrame(CanvasFrame& frame) {
+        mFrameWidth        = frame.width;
+        mFrameHeight       = frame.height;
+        mExecutedInputTime = frame.inputTime;
+        mBatches.clear();
+        mCulledCount = 0;
+
+        CommandQueue& queue = frame.queue;
+        Rect cullRect(0.0f, 0.0f, (f32)mFrameWidth, (f32)mFrameHeight);
+        if (mDamageTracking) {
+            ComputeDamage(frame);
+            if (mDamage.empty()) {
+                frame.clearPending = false;
+                return;
             }
 
-            glUniform4f(mColorLocation, mFillColor.R(), mFillColor.G(), mFillColor.B(), mFillColor.A());
-            DrawVertices(vertices, GL_TRIANGLE_FAN);
-        } else {
-            for (const auto& point : points) {
-                vertices.push_back(ScreenToClipX(point.x));
-                vertices.push_back(ScreenToClipY(point.y));
+            cullRect = mDamage[0];
+            for (const auto& region : mDamage) {
+                cullRect = cullRect.Union(region);
             }
-
-            glUniform4f(mColorLocation, mStrokeColor.R(), mStrokeColor.G(), mStrokeColor.B(), mStrokeColor.A());
-            DrawVertices(vertices, GL_LINE_LOOP);
         }
-    }
 
-    void Canvas::InitShaders() {
-        const GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertexShader, 1, &Shaders::kVertexShaderSource, nullptr);
-        glCompileShader(vertexShader);
-
-        GLint success;
-        glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            char infoLog[512];
-            glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-            std::cerr << "Vertex shader compilation failed:\n" << infoLog << std::endl;
+        if (!queue.IsEmpty()) {
+            if (mOcclusionCulling) { mCoverage.Reset(mFrameWidth, mFrameHeight); }
+            mCulledCount = queue.Cull(cullRect, mOcclusionCulling ? &mCoverage : nullptr);
         }
 
-        const GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragmentShader, 1, &Shaders::kFragmentShaderSource, nullptr);
-        glCompileShader(fragmentShader);
-
-        glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            char infoLog[512];
-            glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-            std::cerr << "Fragment shader compilation failed:\n" << infoLog << std::endl;
+        if (!queue.IsEmpty()) {
+            queue.Sort(mReorderCommands);
+
+            // Size every command's output up front. Offsets are exact, so tessellation can write straight into the
+            // upload buffer from any number of threads and the result is already in submission order.
+            const auto& keys = queue.GetSortedKeys();
+            const auto count = CAST<u32>(keys.size());
+            u32 vertexCount  = 0;
+            mVertexOffsets.resize(count);
+            for (u32 i = 0; i < count; ++i) {
+                const DrawCommand& command = queue.GetCommand(SortKey::GetSequence(keys[i]));
+                const u32 vertices         = Tessellator::CountVertices(command);
+                mVertexOffsets[i]          = vertexCount;
+                if (vertices == 0) continue;
+
+                const u32 state = command.GetState();
+                if (mBatches.empty() || mBatches.back().state != state) {
+                    mBatches.push_back({command.pipeline, command.blend, state, vertexCount, 0});
+                }
+                mBatches.back().vertexCount += vertices;
+                vertexCount += vertices;
+            }
+            mVertices.resize(vertexCount);
+
+            const auto tessellate = [this, &queue, &keys](u32 begin, u32 end) {
+                for (u32 i = begin; i < end; ++i) {
+                    const DrawCommand& command = queue.GetCommand(SortKey::GetSequence(keys[i]));
+                    Tessellator::Tessellate(command, queue.GetPoints(), mVertices.data() + mVertexOffsets[i]);
+                }
+            };
+
+            if (mJobSystem && count >= kParallelTessellationThreshold) {
+                mJobSystem->ParallelFor(count, kTessellationGrainSize, tessellate);
+            } else {
+                tessellate(0, count);
+            }
         }
 
-        mShaderProgram = glCreateProgram();
-        glAttachShader(mShaderProgram, vertexShader);
-        glAttachShader(mShaderProgram, fragmentShader);
-        glLinkProgram(mShaderProgram);
+        RenderFrame render;
+        render.width       = mFrameWidth;
+        render.height      = mFrameHeight;
+        render.vertices    = mVertices.data();
+        render.vertexCount = queue.IsEmpty() ? 0 : CAST<u32>(mVertices.size());
+        render.batches     = &mBatches;
+        render.damage      = mDamageTracking ? &mDamage : nullptr;
+        render.clearColor  = frame.clearPending ? &frame.clearColor : nullptr;
+        render.jobs        = mJobSystem;
+        mDevice->Submit(render);
+        frame.clearPending = false;
+    }
+
+    void Canvas::ComputeDamage(const CanvasFrame& frame) {
+        mDamage.clear();
 
-        glGetProgramiv(mShaderProgram, GL_LINK_STATUS, &success);
-        if (!success) {
-            char infoLog[512];
-            glGetProgramInfoLog(mShaderProgram, 512, nullptr, infoLog);
-            std::cerr << "Shader program linking failed:\n" << infoLog << std::endl;
+        mSignatures.clear();
+        for (u32 i = 0; i < frame.queue.GetCount(); ++i) {
+            mSignatures.push_back({frame.queue.GetCommandHash(i), frame.queue.GetCommand(i).bounds});
         }
 
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-
-        mColorLocation = glGetUniformLocation(mShaderProgram, "uColor");
-    }
+        const bool clearChanged = frame.clearPending != mPreviousClearPending ||
+                                  (frame.clearPending && frame.clearColor != mPreviousClearColor);
+        mPreviousClearPending = frame.clearPending;
+        mPreviousClearColor   = frame.clearColor;
 
-    void Canvas::SetupBuffers() {
-        glGenVertexArrays(1, &mVAO);
-        glGenBuffers(1, &mVBO);
+        if (mFullDamage.exchange(false) || clearChanged) {
+            mDamage.emplace_back(0.0f, 0.0f, (f32)mFrameWidth, (f32)mFrameHeight);
+            std::swap(mSignatures, mPreviousSignatures);
+            return;
+        }
 
-        glBindVertexArray(mVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+        // Align both frames' command lists, looking a few entries ahead to resynchronize after insertions and
+        // removals. Unmatched commands damage their bounds. A pixel outside every damaged rect is covered by the
+        // same commands in the same order in both frames, so it can't have changed.
+        static constexpr size_t kLookahead = 8;
+
+        const auto& current  = mSignatures;
+        const auto& previous = mPreviousSignatures;
+        size_t i = 0, j = 0;
+        while (i < current.size() && j < previous.size()) {
+            if (current[i].hash == previous[j].hash) {
+                ++i, ++j;
+                continue;
+            }
 
-        // Position attribute
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(f32), (void*)nullptr);
-        glEnableVertexAttribArray(0);
+            size_t removed = 0, inserted = 0;
+            for (size_t k = 1; k <= kLookahead && !removed && !inserted; ++k) {
+                if (j + k < previous.size() && previous[j + k].hash == current[i].hash) removed = k;
+                else if (i + k < current.size() && current[i + k].hash == previous[j].hash) inserted = k;
+            }
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
-    }
+            if (removed) {
+                for (; removed > 0; --removed) AddDamage(previous[j++].bounds);
+            } else if (inserted) {
+                for (; inserted > 0; --inserted) AddDamage(current[i++].bounds);
+            } else {
+                AddDamage(current[i++].bounds);
+                AddDamage(previous[j++].bounds);
+            }
+        }
+        for (; i < current.size(); ++i) AddDamage(current[i].bounds);
+        for (; j < previous.size(); ++j) AddDamage(previous[j].bounds);
 
-    void Canvas::DrawVertices(const vector<f32>& vertices, GLenum mode) const {
-        glBindBuffer(GL_ARRAY_BUFFER, mVBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(f32), vertices.data(), GL_DYNAMIC_DRAW);
-        glDrawArrays(mode, 0, vertices.size() / 2);
+        std::swap(mSignatures, mPreviousSignatures);
     }
 
-    f32 Canvas::ScreenToClipX(f32 x) const {
-        return (2.0f * x / (f32)mWidth) - 1.0f;
-    }
+    void Canvas::AddDamage(const Rect& region) {
+        Rect clipped = region.Intersect({0.0f, 0.0f, (f32)mFrameWidth, (f32)mFrameHeight});
+        if (clipped.IsEmpty()) return;
+
+        // Fold into any overlapping region, repeating since the grown rect may now touch others
+        for (size_t i = 0; i < mDamage.size();) {
+            if (mDamage[i].Overlaps(clipped)) {
+                clipped = clipped.Union(mDamage[i]);
+                mDamage.erase(mDamage.begin() + (i64)i);
+                i = 0;
+            } else {
+                ++i;
+            }
+        }
+        mDamage.push_back(clipped);
 
-    f32 Canvas::ScreenToClipY(f32 y) const {
-        return 1.0f - (2.0f * y / (f32)mHeight);
+        if (mDamage.size() > kMaxDamageRects) {
+            Rect bounds = mDamage[0];
+            for (const auto& rect : mDamage) {
+                bounds = bounds.Union(rect);
+            }
+            mDamage.assign(1, bounds);
+        }
     }
 }  // namespace X
\ No newline at end of file
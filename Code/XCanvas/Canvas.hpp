@@ -4,41 +4,119 @@
 
 #pragma once
 
-#include <glad/glad.h>
-
 #include "Shared.hpp"
 #include "Color.hpp"
 #include "Point.hpp"
+#include "CommandList.hpp"
+#include "CommandQueue.hpp"
+#include "Tessellator.hpp"
+#include "TripleBuffer.hpp"
+#include "JobSystem.hpp"
+#include "RenderDevice.hpp"
+
+#include <atomic>
 
 namespace X {
-    class Canvas {
+    class CommandStreamRecorder;
+
+    /**
+     * @brief Immediate-style drawing API backed by a deferred command queue.
+     *
+     * Draw calls between Begin() and End() are recorded, not executed. End() sorts the queue into state batches
+     * (see SortKey), tessellates it into a single vertex buffer and submits the batches to the canvas' RenderDevice.
+     * Lists recorded elsewhere, possibly on other threads, are merged in with Execute().
+     *
+     * With deferred submission enabled, End() never touches the device: the recorded frame is handed to another
+     * thread through a TripleBuffer and executed there by AcquirePending() and ExecuteAcquired().
+     */
+    class Canvas : protected CommandList, public FrameTarget {
     public:
-        Canvas(u32 width, u32 height);
-        ~Canvas();
+        using CommandList::DrawCircle;
+        using CommandList::DrawLine;
+        using CommandList::DrawPolygon;
+        using CommandList::DrawRectangle;
+        using CommandList::SetFillColor;
+        using CommandList::SetStrokeColor;
+        using CommandList::SetStrokeWidth;
+
+        /// @brief Create the backend's device. OpenGL needs a current context, the others don't.
+        Canvas(u32 width, u32 height, CanvasBackend backend = CanvasBackend::OpenGL);
 
-        void Clear(const Color& clearColor = Colors::Black) const;
+        /// @brief Draw through a caller-provided @p device
+        Canvas(u32 width, u32 height, unique_ptr<RenderDevice> device);
+
+        void Clear(const Color& clearColor = Colors::Black) override;
         void Resize(u32 width, u32 height);
 
-        void Begin() const;
-        void End() const;
+        void Begin() override;
+        void End() override;
+
+        /// @brief Append pre-recorded commands to the current frame, as if drawn here at this point
+        void Execute(const CommandList& list);
+
+        /// @brief Append several lists in the order given, between Begin() and End()
+        void Execute(const vector<CommandList>& lists);
 
-        void SetFillColor(const Color& fillColor) {
-            mFillColor = fillColor;
+        /// @brief Append commands stored outside a CommandList, such as in shared memory (see SharedCanvas)
+        void Execute(const DrawCommand* commands, u32 count, const Point* points, u32 pointCount) override;
+
+        /**
+         * @brief Publish frames from End() instead of executing them (off by default).
+         *
+         * The thread owning the GL context then calls AcquirePending() and ExecuteAcquired(). Recording and
+         * execution may run concurrently; while enabled, Clear() must be called between Begin() and End().
+         */
+        void SetDeferredSubmission(const bool enabled) {
+            mDeferredSubmission = enabled;
+        }
+
+        X_ND bool IsDeferredSubmissionEnabled() const {
+            return mDeferredSubmission;
         }
 
-        void SetStrokeColor(const Color& strokeColor) {
-            mStrokeColor = strokeColor;
+        /// @brief Take ownership of the newest frame published by End(). Returns false if there is none.
+        bool AcquirePending();
+
+        /// @brief Execute the frame taken by AcquirePending(). GL context thread only.
+        void ExecuteAcquired();
+
+        /// @brief Tag the next frame End() submits as reflecting input that arrived at @p timestamp (Clock::Now())
+        void MarkInput(const f64 timestamp) {
+            if (mInputTime == 0.0 || timestamp < mInputTime) { mInputTime = timestamp; }
         }
 
-        void SetStrokeWidth(const f32 width) {
-            mStrokeWidth = width;
+        /// @brief MarkInput() timestamp carried by the last executed frame, 0 if it reflected no new input
+        X_ND f64 GetExecutedInputTime() const {
+            return mExecutedInputTime;
         }
 
-        void DrawLine(f32 x0, f32 y0, f32 x1, f32 y1) const;
-        void DrawLine(const Point& start, const Point& end) const;
-        void DrawRectangle(f32 x, f32 y, f32 width, f32 height, bool filled = true) const;
-        void DrawCircle(f32 x, f32 y, f32 radius, u32 segments, bool filled = true) const;
-        void DrawPolygon(const vector<Point>& points, bool filled = true) const;
+        /// @brief Write every frame End() finishes to @p recorder, which must outlive it; nullptr stops
+        void SetRecorder(CommandStreamRecorder* recorder) {
+            mRecorder = recorder;
+        }
+
+        /// @brief Tessellate large frames in parallel on @p jobs; nullptr keeps it on the executing thread
+        void SetJobSystem(JobSystem* jobs) {
+            mJobSystem = jobs;
+        }
+
+        X_ND RenderDevice& GetDevice() const {
+            return *mDevice;
+        }
+
+        X_ND CanvasBackend GetBackend() const {
+            return mDevice->GetBackend();
+        }
+
+        /// @brief Image holding the last executed frame if the device renders into memory, otherwise nullptr
+        X_ND const Image* GetImage() const {
+            return mDevice->GetImage();
+        }
+
+        /// @brief Allow End() to reorder non-overlapping commands to build larger batches (on by default)
+        void SetCommandReordering(const bool enabled) {
+            mReorderCommands = enabled;
+        }
 
         X_ND u32 GetWidth() const {
             return mWidth;
@@ -48,25 +126,114 @@ namespace X {
             return mHeight;
         }
 
+        /// @brief Width of the last executed frame, which lags GetWidth() under deferred submission
+        X_ND u32 GetFrameWidth() const {
+            return mFrameWidth;
+        }
+
+        /// @brief Height of the last executed frame, which lags GetHeight() under deferred submission
+        X_ND u32 GetFrameHeight() const {
+            return mFrameHeight;
+        }
+
+        /// @brief Drop draws hidden behind later opaque fills before tessellating them (off by default)
+        void SetOcclusionCulling(const bool enabled) {
+            mOcclusionCulling = enabled;
+        }
+
+        /**
+         * @brief Only re-render what changed since the previous frame (off by default).
+         *
+         * Each End() diffs the recorded commands against the previous frame and has the device repaint just the
+         * damaged regions, e.g. under glScissor into a persistent offscreen buffer that is then copied to the window.
+         * A frame with no changes never reaches the device and HasDamage() returns false.
+         */
+        void SetDamageTracking(bool enabled);
+
+        X_ND bool IsDamageTrackingEnabled() const {
+            return mDamageTracking;
+        }
+
+        /// @brief Force the next End() to repaint everything, e.g. after the window contents were lost
+        void Invalidate() {
+            mFullDamage = true;
+        }
+
+        /// @brief False if the last End() produced an image identical to the one before it
+        X_ND bool HasDamage() const {
+            return !mDamage.empty();
+        }
+
+        /// @brief Regions (screen space) repainted by the last End()
+        X_ND const vector<Rect>& GetDamage() const {
+            return mDamage;
+        }
+
+        /// @brief Number of draws skipped by viewport and occlusion culling in the last End()
+        X_ND u32 GetCulledCount() const {
+            return mCulledCount;
+        }
+
+        /// @brief Number of batches (draw calls on OpenGL) submitted by the last End()
+        X_ND u32 GetBatchCount() const {
+            return CAST<u32>(mBatches.size());
+        }
+
+    protected:
+        bool OnQueueFull() override;
+
+        CommandList& GetRecorder() override {
+            return *this;
+        }
+
     private:
-        void InitShaders();
-        void SetupBuffers();
-        void DrawVertices(const vector<f32>& vertices, GLenum mode) const;
+        void ExecuteFrame(CanvasFrame& frame);
 
-        X_ND f32 ScreenToClipX(f32 x) const;
-        X_ND f32 ScreenToClipY(f32 y) const;
+        void ComputeDamage(const CanvasFrame& frame);
+        void AddDamage(const Rect& region);
 
         u32 mWidth;
         u32 mHeight;
 
-        Color mFillColor {Colors::Transparent};
-        Color mStrokeColor {Colors::Transparent};
-        f32 mStrokeWidth {0.0f};
-
-        GLuint mShaderProgram {0};
-        GLuint mVAO {0};
-        GLuint mVBO {0};
-
-        GLint mColorLocation {0};
+        // Recording side; the write slot is the frame being recorded
+        TripleBuffer<CanvasFrame> mFrames;
+        bool mRecording {false};
+        f64 mInputTime {0.0};
+        bool mDeferredSubmission {false};
+        CommandStreamRecorder* mRecorder {nullptr};
+
+        // Execution side, owned by the thread executing frames (the GL context thread for OpenGL)
+        unique_ptr<RenderDevice> mDevice;
+        u32 mFrameWidth {0};
+        u32 mFrameHeight {0};
+        f64 mExecutedInputTime {0.0};
+        CoverageMask mCoverage;
+        u32 mCulledCount {0};
+        // Below this many commands fanning out costs more than it saves
+        static constexpr u32 kParallelTessellationThreshold = 512;
+        static constexpr u32 kTessellationGrainSize         = 128;
+
+        JobSystem* mJobSystem {nullptr};
+        vector<u32> mVertexOffsets;
+        vector<Vertex> mVertices;
+        vector<DrawBatch> mBatches;
+        bool mReorderCommands {true};
+        bool mOcclusionCulling {false};
+
+        /// @brief Enough to describe a command's pixels when diffing frames
+        struct CommandSignature {
+            u64 hash;
+            Rect bounds;
+        };
+
+        static constexpr u32 kMaxDamageRects = 4;
+
+        bool mDamageTracking {false};
+        std::atomic<bool> mFullDamage {true};
+        vector<Rect> mDamage;
+        vector<CommandSignature> mSignatures;
+        vector<CommandSignature> mPreviousSignatures;
+        Color mPreviousClearColor {Colors::Black};
+        bool mPreviousClearPending {false};
     };
 }  // namespace X
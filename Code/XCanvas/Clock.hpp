@@ -0,0 +1,18 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+
+#include <chrono>
+
+namespace X::Clock {
+    /// @brief Monotonic high-resolution time in seconds. Unlike glfwGetTime() it works without GLFW initialized.
+    inline f64 Now() {
+        using namespace std::chrono;
+        static const auto epoch = steady_clock::now();
+        return duration<f64>(steady_clock::now() - epoch).count();
+    }
+}  // namespace X::Clock
@@ -0,0 +1,310 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "ColorQuantizer.hpp"
+
+#include <algorithm>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #define X_QUANTIZE_AVX2
+    #include <immintrin.h>
+#endif
+
+namespace X {
+    static constexpr u32 kOpaqueAlpha = 0x80000000;  // Pixels at or above are opaque
+    static constexpr u32 kExactSlots  = 1024;
+
+    static constexpr u8 kBayer[8][8] = {
+      {0, 32, 8, 40, 2, 34, 10, 42},
+      {48, 16, 56, 24, 50, 18, 58, 26},
+      {12, 44, 4, 36, 14, 46, 6, 38},
+      {60, 28, 52, 20, 62, 30, 54, 22},
+      {3, 35, 11, 43, 1, 33, 9, 41},
+      {51, 19, 59, 27, 49, 17, 57, 25},
+      {15, 47, 7, 39, 13, 45, 5, 37},
+      {63, 31, 55, 23, 61, 29, 53, 21},
+    };
+
+    static u32 Bin(u32 r, u32 g, u32 b) {
+        return (r >> 3) << 10 | (g >> 3) << 5 | (b >> 3);
+    }
+
+    static u32 HashColor(u32 color) {
+        return (color * 2654435761u) >> 22;  // Top 10 bits, one per slot
+    }
+
+    // Bin indices of a run of pixels, transparent ones going to the extra bin past the 5:5:5 ones. Returns how many
+    // pixels were done; the caller bins the rest.
+
+    using BinKernel = size_t (*)(const u32* pixels, size_t count, u32* bins);
+
+    static size_t BinPixelsNone(const u32*, size_t, u32*) {
+        return 0;
+    }
+
+#if defined(X_QUANTIZE_AVX2)
+    __attribute__((target("avx2"))) static size_t BinPixelsAvx2(const u32* pixels, size_t count, u32* bins) {
+        const __m256i redMask   = _mm256_set1_epi32(0xF8);
+        const __m256i greenMask = _mm256_set1_epi32(0x3E0);
+        const __m256i blueMask  = _mm256_set1_epi32(0x1F);
+        const __m256i clear     = _mm256_set1_epi32(CAST<i32>(1u << 15));
+        const __m256i zero      = _mm256_setzero_si256();
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m256i pixel  = _mm256_loadu_si256(RCAST<const __m256i*>(pixels + i));
+            const __m256i red    = _mm256_slli_epi32(_mm256_and_si256(pixel, redMask), 7);
+            const __m256i green  = _mm256_and_si256(_mm256_srli_epi32(pixel, 6), greenMask);
+            const __m256i blue   = _mm256_and_si256(_mm256_srli_epi32(pixel, 19), blueMask);
+            const __m256i bin    = _mm256_or_si256(red, _mm256_or_si256(green, blue));
+            const __m256i opaque = _mm256_cmpgt_epi32(zero, pixel);  // Alpha's top bit is the sign bit
+            _mm256_storeu_si256(RCAST<__m256i*>(bins + i), _mm256_blendv_epi8(clear, bin, opaque));
+        }
+        return i;
+    }
+#endif
+
+    static BinKernel SelectBinKernel() {
+#if defined(X_QUANTIZE_AVX2)
+        __builtin_cpu_init();  // Runs from a static initializer, possibly before libgcc's own
+        if (__builtin_cpu_supports("avx2")) { return BinPixelsAvx2; }
+#endif
+        return BinPixelsNone;
+    }
+
+    static const BinKernel kBinKernel = SelectBinKernel();
+
+    void ColorQuantizer::Build(const u32* pixels, size_t count, u32 maxColors) {
+        maxColors = X_CLAMP(maxColors, 2u, 256u);
+        mPalette.clear();
+        mTransparent = false;
+        mExact       = BuildExact(pixels, count, maxColors);
+        if (!mExact) { BuildMedianCut(pixels, count, maxColors); }
+    }
+
+    bool ColorQuantizer::BuildExact(const u32* pixels, size_t count, u32 maxColors) {
+        mExactKeys.assign(kExactSlots, 0);
+        mExactIndex.assign(kExactSlots, 0);
+
+        u32 previous = 0;  // Keys always have alpha set, so this matches none
+        for (size_t i = 0; i < count; ++i) {
+            if (pixels[i] < kOpaqueAlpha) {
+                mTransparent = true;
+                continue;
+            }
+            const u32 key = pixels[i] | 0xFF000000;
+            if (key == previous) continue;
+            previous = key;
+
+            u32 slot = HashColor(key);
+            while (mExactKeys[slot] != 0 && mExactKeys[slot] != key) {
+                slot = (slot + 1) & (kExactSlots - 1);
+            }
+            if (mExactKeys[slot] == key) continue;
+            if (mPalette.size() == maxColors) {
+                mPalette.clear();
+                return false;
+            }
+            mExactKeys[slot]  = key;
+            mExactIndex[slot] = CAST<u8>(mPalette.size());
+            mPalette.push_back(key);
+        }
+
+        if (mPalette.size() + (mTransparent ? 1 : 0) > maxColors) {
+            mPalette.clear();
+            return false;
+        }
+        return true;
+    }
+
+    i32 ColorQuantizer::FindExact(u32 color) const {
+        u32 slot = HashColor(color);
+        while (mExactKeys[slot] != 0) {
+            if (mExactKeys[slot] == color) return mExactIndex[slot];
+            slot = (slot + 1) & (kExactSlots - 1);
+        }
+        return -1;
+    }
+
+    void ColorQuantizer::BuildMedianCut(const u32* pixels, size_t count, u32 maxColors) {
+        mHistogram.assign(kBins + 1, 0);
+        u32 bins[256];
+        for (size_t begin = 0; begin < count; begin += 256) {
+            const size_t length = X_MIN(count - begin, size_t {256});
+            size_t i            = kBinKernel(pixels + begin, length, bins);
+            for (; i < length; ++i) {
+                const u32 pixel = pixels[begin + i];
+                bins[i] = pixel < kOpaqueAlpha ? kBins : Bin(pixel & 0xFF, (pixel >> 8) & 0xFF, (pixel >> 16) & 0xFF);
+            }
+            for (i = 0; i < length; ++i) {
+                ++mHistogram[bins[i]];
+            }
+        }
+        mTransparent = mHistogram[kBins] > 0;
+
+        mBinIndex.assign(kBins, 0);
+        Box all {{0, 0, 0}, {31, 31, 31}, {}, {}, 0};
+        Shrink(all);
+        if (all.count == 0) return;
+
+        // Split the box with the most pixels times longest side, along that side at the median, until the palette
+        // is full or every box holds a single bin
+        const u32 limit = maxColors - (mTransparent ? 1 : 0);
+        vector<Box> boxes {all};
+        while (boxes.size() < limit) {
+            i32 best      = -1;
+            u64 bestScore = 0;
+            u32 bestAxis  = 0;
+            for (size_t i = 0; i < boxes.size(); ++i) {
+                for (u32 axis = 0; axis < 3; ++axis) {
+                    const u32 side  = boxes[i].maximum[axis] - boxes[i].minimum[axis];
+                    const u64 score = boxes[i].count * side;
+                    if (score > bestScore) {
+                        best      = CAST<i32>(i);
+                        bestScore = score;
+                        bestAxis  = axis;
+                    }
+                }
+            }
+            if (best < 0) break;
+
+            Box box = boxes[best];
+            u64 marginal[32] {};
+            for (u32 r = box.minimum[0]; r <= box.maximum[0]; ++r) {
+                for (u32 g = box.minimum[1]; g <= box.maximum[1]; ++g) {
+                    for (u32 b = box.minimum[2]; b <= box.maximum[2]; ++b) {
+                        const u32 coordinates[3] = {r, g, b};
+                        marginal[coordinates[bestAxis]] += mHistogram[r << 10 | g << 5 | b];
+                    }
+                }
+            }
+
+            // Both halves keep at least one occupied slice
+            u32 split       = box.minimum[bestAxis];
+            u64 accumulated = marginal[split];
+            while (split + 1 < box.maximum[bestAxis] && accumulated * 2 < box.count) {
+                accumulated += marginal[++split];
+            }
+
+            Box upper          = box;
+            box.hi[bestAxis]   = CAST<u8>(split);
+            upper.lo[bestAxis] = CAST<u8>(split + 1);
+            Shrink(box);
+            Shrink(upper);
+            boxes[best] = box;
+            boxes.push_back(upper);
+        }
+
+        for (const Box& box : boxes) {
+            u64 sums[3] = {};
+            for (u32 r = box.minimum[0]; r <= box.maximum[0]; ++r) {
+                for (u32 g = box.minimum[1]; g <= box.maximum[1]; ++g) {
+                    for (u32 b = box.minimum[2]; b <= box.maximum[2]; ++b) {
+                        const u64 pixelCount = mHistogram[r << 10 | g << 5 | b];
+                        sums[0] += pixelCount * (r * 8 + 4);
+                        sums[1] += pixelCount * (g * 8 + 4);
+                        sums[2] += pixelCount * (b * 8 + 4);
+                    }
+                }
+            }
+            const auto channel = [&](u32 axis) {
+                return CAST<u32>((sums[axis] + box.count / 2) / box.count);
+            };
+
+            const auto index = CAST<u8>(mPalette.size());
+            mPalette.push_back(0xFF000000 | channel(2) << 16 | channel(1) << 8 | channel(0));
+            for (u32 r = box.lo[0]; r <= box.hi[0]; ++r) {
+                for (u32 g = box.lo[1]; g <= box.hi[1]; ++g) {
+                    std::fill_n(mBinIndex.begin() + (r << 10 | g << 5 | box.lo[2]), box.hi[2] - box.lo[2] + 1, index);
+                }
+            }
+        }
+    }
+
+    void ColorQuantizer::Shrink(Box& box) const {
+        box.count = 0;
+        for (u32 axis = 0; axis < 3; ++axis) {
+            box.minimum[axis] = box.hi[axis];
+            box.maximum[axis] = box.lo[axis];
+        }
+        for (u32 r = box.lo[0]; r <= box.hi[0]; ++r) {
+            for (u32 g = box.lo[1]; g <= box.hi[1]; ++g) {
+                for (u32 b = box.lo[2]; b <= box.hi[2]; ++b) {
+                    const u32 pixelCount = mHistogram[r << 10 | g << 5 | b];
+                    if (pixelCount == 0) continue;
+
+                    box.count += pixelCount;
+                    const u32 coordinates[3] = {r, g, b};
+                    for (u32 axis = 0; axis < 3; ++axis) {
+                        box.minimum[axis] = X_MIN(box.minimum[axis], CAST<u8>(coordinates[axis]));
+                        box.maximum[axis] = X_MAX(box.maximum[axis], CAST<u8>(coordinates[axis]));
+                    }
+                }
+            }
+        }
+    }
+
+    void ColorQuantizer::Map(const u32* pixels, u32 width, u32 height, u32 originX, u32 originY, bool dither, u8* out) {
+        const auto transparent = CAST<u8>(GetTransparentIndex());
+        const size_t count     = CAST<size_t>(width) * height;
+
+        if (mExact) {
+            u32 previous = 0;
+            u8 index     = 0;
+            for (size_t i = 0; i < count; ++i) {
+                if (pixels[i] < kOpaqueAlpha) {
+                    out[i] = transparent;
+                    continue;
+                }
+                const u32 key = pixels[i] | 0xFF000000;
+                if (key != previous) {
+                    previous = key;
+                    index    = CAST<u8>(FindExact(key));
+                }
+                out[i] = index;
+            }
+            return;
+        }
+
+        // Sums of the undithered colors mapped to each entry, for one k-means step once all are mapped
+        u64 sums[256][3] = {};
+        u64 counts[256]  = {};
+        for (u32 y = 0; y < height; ++y) {
+            const u8* threshold = kBayer[(originY + y) & 7];
+            for (u32 x = 0; x < width; ++x) {
+                const size_t i  = CAST<size_t>(y) * width + x;
+                const u32 pixel = pixels[i];
+                if (pixel < kOpaqueAlpha) {
+                    out[i] = transparent;
+                    continue;
+                }
+
+                const i32 r = pixel & 0xFF, g = (pixel >> 8) & 0xFF, b = (pixel >> 16) & 0xFF;
+                u8 index;
+                if (dither) {
+                    // About one bin of spread either way, centered on the pixel's color
+                    const i32 offset = (threshold[(originX + x) & 7] >> 2) - 8;
+                    index            = mBinIndex[Bin(X_CLAMP(r + offset, 0, 255),
+                                                     X_CLAMP(g + offset, 0, 255),
+                                                     X_CLAMP(b + offset, 0, 255))];
+                } else {
+                    index = mBinIndex[Bin(r, g, b)];
+                }
+                out[i] = index;
+                sums[index][0] += r;
+                sums[index][1] += g;
+                sums[index][2] += b;
+                ++counts[index];
+            }
+        }
+
+        for (size_t i = 0; i < mPalette.size(); ++i) {
+            if (counts[i] == 0) continue;
+            const auto channel = [&](u32 axis) {
+                return CAST<u32>((sums[i][axis] + counts[i] / 2) / counts[i]);
+            };
+            mPalette[i] = 0xFF000000 | channel(2) << 16 | channel(1) << 8 | channel(0);
+        }
+    }
+}  // namespace X
@@ -0,0 +1,72 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+
+namespace X {
+    /**
+     * @brief Reduces RGBA8 pixels to a palette of at most 256 colors, for GIF and other indexed formats.
+     *
+     * Pixels are u32 as loaded from memory (0xAABBGGRR). Those with alpha below 128 are transparent: they don't
+     * count toward the palette and map to GetTransparentIndex(), one past the last color. When the opaque pixels
+     * have few enough distinct colors, as UI frames usually do, the palette is exactly those colors and mapping is
+     * lossless. Otherwise the colors are histogrammed at 5 bits per channel and split by median cut, mapping uses
+     * optional 8x8 ordered dithering, and Map() refines each color to the mean of the pixels mapped to it.
+     */
+    class ColorQuantizer {
+    public:
+        /// @brief Choose the palette for @p count pixels, at most @p maxColors entries including the transparent one
+        void Build(const u32* pixels, size_t count, u32 maxColors = 256);
+
+        /**
+         * @brief Write the palette index of each pixel of a @p width x @p height block to @p out.
+         *
+         * @p originX and @p originY place the block in the image so the dither pattern stays fixed to the image
+         * rather than the block. Refines the palette of a lossy Build(), so read GetPalette() afterwards.
+         */
+        void Map(const u32* pixels, u32 width, u32 height, u32 originX, u32 originY, bool dither, u8* out);
+
+        /// @brief Opaque colors, 0xFFBBGGRR
+        X_ND const vector<u32>& GetPalette() const {
+            return mPalette;
+        }
+
+        X_ND bool HasTransparency() const {
+            return mTransparent;
+        }
+
+        X_ND u32 GetTransparentIndex() const {
+            return CAST<u32>(mPalette.size());
+        }
+
+        /// @brief Whether every opaque pixel maps to its own color
+        X_ND bool IsExact() const {
+            return mExact;
+        }
+
+    private:
+        static constexpr u32 kBins = 1u << 15;
+
+        struct Box {
+            u8 lo[3], hi[3];            // Cell in bin coordinates, inclusive; the cells partition the histogram
+            u8 minimum[3], maximum[3];  // Bounds of the occupied bins inside the cell
+            u64 count;
+        };
+
+        bool BuildExact(const u32* pixels, size_t count, u32 maxColors);
+        void BuildMedianCut(const u32* pixels, size_t count, u32 maxColors);
+        void Shrink(Box& box) const;
+        X_ND i32 FindExact(u32 color) const;
+
+        vector<u32> mPalette;
+        bool mTransparent {false};
+        bool mExact {false};
+        vector<u32> mHistogram;  // Pixels per 5:5:5 bin, then one bin collecting the transparent ones
+        vector<u8> mBinIndex;    // Palette index of every bin, lossy palettes only
+        vector<u32> mExactKeys;  // Open-addressed color table, exact palettes only
+        vector<u8> mExactIndex;
+    };
+}  // namespace X
@@ -0,0 +1,130 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "CommandList.hpp"
+
+#include <iostream>
+
+namespace X {
+    // A list always records into its own storage after copying or moving; only Canvas retargets it
+    CommandList::CommandList(const CommandList& other)
+        : mFillColor(other.mFillColor), mStrokeColor(other.mStrokeColor), mStrokeWidth(other.mStrokeWidth),
+          mStorage(other.mStorage), mTarget(&mStorage) {}
+
+    CommandList& CommandList::operator=(const CommandList& other) {
+        if (this != &other) {
+            mFillColor   = other.mFillColor;
+            mStrokeColor = other.mStrokeColor;
+            mStrokeWidth = other.mStrokeWidth;
+            mStorage     = other.mStorage;
+        }
+        return *this;
+    }
+
+    CommandList::CommandList(CommandList&& other) noexcept
+        : mFillColor(other.mFillColor), mStrokeColor(other.mStrokeColor), mStrokeWidth(other.mStrokeWidth),
+          mStorage(std::move(other.mStorage)), mTarget(&mStorage) {}
+
+    CommandList& CommandList::operator=(CommandList&& other) noexcept {
+        if (this != &other) {
+            mFillColor   = other.mFillColor;
+            mStrokeColor = other.mStrokeColor;
+            mStrokeWidth = other.mStrokeWidth;
+            mStorage     = std::move(other.mStorage);
+        }
+        return *this;
+    }
+
+    void CommandList::Reset() {
+        mStorage.Reset();
+    }
+
+    void CommandList::DrawLine(const f32 x0, const f32 y0, const f32 x1, const f32 y1) {
+        DrawCommand command;
+        command.shape     = ShapeType::Line;
+        command.params[0] = x0, command.params[1] = y0, command.params[2] = x1, command.params[3] = y1;
+        command.bounds    = Rect(X_MIN(x0, x1), X_MIN(y0, y1), X_MAX(x0, x1), X_MAX(y0, y1));
+        Record(command, false);
+    }
+
+    void CommandList::DrawLine(const Point& start, const Point& end) {
+        DrawLine(start.x, start.y, end.x, end.y);
+    }
+
+    void CommandList::DrawRectangle(f32 x, f32 y, f32 width, f32 height, bool filled) {
+        DrawCommand command;
+        command.shape     = ShapeType::Rectangle;
+        command.params[0] = x, command.params[1] = y, command.params[2] = width, command.params[3] = height;
+        command.bounds    = Rect::FromSize(x, y, width, height);
+        Record(command, filled);
+    }
+
+    void CommandList::DrawCircle(f32 x, f32 y, f32 radius, u32 segments, bool filled) {
+        if (segments < 3) return;
+        // Remote and recorded frames with more are rejected as damaged
+        segments = X_MIN(segments, DrawCommand::kMaxCircleSegments);
+
+        DrawCommand command;
+        command.shape     = ShapeType::Circle;
+        command.params[0] = x, command.params[1] = y, command.params[2] = radius, command.params[3] = (f32)segments;
+        command.bounds    = Rect(x - radius, y - radius, x + radius, y + radius);
+        Record(command, filled);
+    }
+
+    void CommandList::DrawPolygon(const vector<Point>& points, bool filled) {
+        if (points.size() < 3) return;
+
+        DrawCommand command;
+        command.shape      = ShapeType::Polygon;
+        command.pointCount = CAST<u32>(points.size());
+
+        Rect bounds(points[0].x, points[0].y, points[0].x, points[0].y);
+        for (const auto& point : points) {
+            bounds = bounds.Union({point.x, point.y, point.x, point.y});
+        }
+        command.bounds = bounds;
+
+        Record(command, filled, &points);
+    }
+
+    bool CommandList::OnQueueFull() {
+        std::cerr << "CommandList::Record() - Command queue full, dropping draw\n";
+        return false;
+    }
+
+    void CommandList::Append(const DrawCommand* commands, u32 count, const Point* points, u32 pointCount) {
+        X_ASSERT(mTarget != nullptr, "Commands must be appended between Begin() and End()");
+        if (!mTarget) return;
+
+        while (true) {
+            const u32 appended = mTarget->Append(commands, count, points, pointCount);
+            if (appended == count || !OnQueueFull()) return;
+            commands += appended;
+            count -= appended;
+        }
+    }
+
+    void CommandList::Append(const CommandQueue& queue) {
+        Append(queue.GetCommands(), queue.GetCount(), queue.GetPoints().data(), CAST<u32>(queue.GetPoints().size()));
+    }
+
+    void CommandList::Record(DrawCommand& command, bool filled, const vector<Point>* points) {
+        X_ASSERT(mTarget != nullptr, "Canvas draw calls must be made between Begin() and End()");
+        if (!mTarget) return;
+
+        const Color& color = filled ? mFillColor : mStrokeColor;
+        command.pipeline   = filled ? Pipeline::Triangles : Pipeline::Lines;
+        command.blend      = color.A() < 1.0f ? BlendMode::Translucent : BlendMode::Opaque;
+        command.color      = color.ToU32_ABGR();
+
+        // Lines rasterize up to a pixel outside their mathematical extent
+        if (!filled || command.shape == ShapeType::Line) { command.bounds = command.bounds.Inflate(1.0f); }
+
+        // Sequence numbers are limited by the sort key, see SortKey
+        if (mTarget->IsFull() && !OnQueueFull()) return;
+
+        if (points) { command.firstPoint = mTarget->PushPoints(*points); }
+        mTarget->Push(command);
+    }
+}  // namespace X
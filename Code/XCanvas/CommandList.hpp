@@ -0,0 +1,124 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+#include "Color.hpp"
+#include "Point.hpp"
+#include "CommandQueue.hpp"
+
+namespace X {
+    /**
+     * @brief Recorder for the Canvas drawing API that makes no GL calls.
+     *
+     * A standalone CommandList can be filled on any thread; separate lists may be recorded concurrently. Hand the
+     * finished lists to Canvas::Execute() between Canvas::Begin() and End(), which appends them in the order given so
+     * the result is deterministic regardless of which thread finished first.
+     *
+     * Canvas, RemoteCanvas and SharedCanvas build on CommandList through protected inheritance and re-expose only the
+     * drawing API; their draw calls record straight into the frame being built.
+     */
+    class CommandList {
+    public:
+        CommandList() : mTarget(&mStorage) {}
+        virtual ~CommandList() = default;
+
+        CommandList(const CommandList& other);
+        CommandList& operator=(const CommandList& other);
+        CommandList(CommandList&& other) noexcept;
+        CommandList& operator=(CommandList&& other) noexcept;
+
+        /// @brief Discard everything recorded so far. Keeps allocations and the current colors.
+        void Reset();
+
+        void SetFillColor(const Color& fillColor) {
+            mFillColor = fillColor;
+        }
+
+        void SetStrokeColor(const Color& strokeColor) {
+            mStrokeColor = strokeColor;
+        }
+
+        void SetStrokeWidth(const f32 width) {
+            mStrokeWidth = width;
+        }
+
+        void DrawLine(f32 x0, f32 y0, f32 x1, f32 y1);
+        void DrawLine(const Point& start, const Point& end);
+        void DrawRectangle(f32 x, f32 y, f32 width, f32 height, bool filled = true);
+        void DrawCircle(f32 x, f32 y, f32 radius, u32 segments, bool filled = true);
+        void DrawPolygon(const vector<Point>& points, bool filled = true);
+
+        X_ND const CommandQueue& GetQueue() const {
+            return mStorage;
+        }
+
+    protected:
+        /// @brief Redirect recording into @p target; nullptr rejects draw calls
+        void SetTarget(CommandQueue* target) {
+            mTarget = target;
+        }
+
+        /// @brief Called when the target queue can't take another command. Return true once space was made.
+        virtual bool OnQueueFull();
+
+        /// @brief Append commands to the target queue, going through OnQueueFull() each time it fills
+        void Append(const DrawCommand* commands, u32 count, const Point* points, u32 pointCount);
+        void Append(const CommandQueue& queue);
+
+        Color mFillColor {Colors::Transparent};
+        Color mStrokeColor {Colors::Transparent};
+        f32 mStrokeWidth {0.0f};
+
+    private:
+        void Record(DrawCommand& command, bool filled, const vector<Point>* points = nullptr);
+
+        CommandQueue mStorage;
+        CommandQueue* mTarget;
+    };
+
+    /// @brief Everything recorded between Canvas::Begin() and Canvas::End()
+    struct CanvasFrame {
+        /// @brief Largest width or height, the smallest maximum texture size OpenGL 4.5 guarantees
+        static constexpr u32 kMaxSize = 16384;
+
+        X_ND static bool IsValidSize(u64 width, u64 height) {
+            return width > 0 && width <= kMaxSize && height > 0 && height <= kMaxSize;
+        }
+
+        CommandQueue queue;
+        Color clearColor {Colors::Black};
+        bool clearPending {false};
+        u32 width {0};
+        u32 height {0};
+        f64 inputTime {0.0};  // Arrival of the oldest input this frame is the first to reflect, 0 if none
+    };
+
+    class CommandStreamDecoder;
+
+    /**
+     * @brief What executing a recorded or remote frame needs from Canvas.
+     *
+     * CommandStreamDecoder and the RemoteCanvas and SharedCanvas servers draw through this interface, which keeps
+     * them free of link dependencies on Canvas and its render devices.
+     */
+    class FrameTarget {
+    public:
+        virtual ~FrameTarget() = default;
+
+        virtual void Clear(const Color& clearColor) = 0;
+        virtual void Begin()                        = 0;
+        virtual void End()                          = 0;
+
+        /// @brief Append commands stored outside a CommandList, between Begin() and End()
+        virtual void Execute(const DrawCommand* commands, u32 count, const Point* points, u32 pointCount) = 0;
+
+    protected:
+        friend class CommandStreamDecoder;
+
+        /// @brief List the individual draw calls of the frame being built are recorded into
+        virtual CommandList& GetRecorder() = 0;
+    };
+}  // namespace X
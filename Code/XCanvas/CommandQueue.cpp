@@ -0,0 +1,240 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "CommandQueue.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace X {
+    /// @brief Conservative rect guaranteed to be fully painted by an opaque command, empty if there's none cheaply
+    static Rect GetOpaqueInterior(const DrawCommand& command) {
+        if (command.pipeline != Pipeline::Triangles || command.blend != BlendMode::Opaque) return {};
+
+        const f32* p = command.params;
+        switch (command.shape) {
+            case ShapeType::Rectangle:
+                return command.bounds;
+            case ShapeType::Circle: {
+                // Square inscribed in the inner circle of the tessellated polygon
+                const f32 inradius = std::fabs(p[2]) * std::cos(CAST<f32>(M_PI) / p[3]);
+                const f32 halfSide = inradius * 0.70710678f;
+                return {p[0] - halfSide, p[1] - halfSide, p[0] + halfSide, p[1] + halfSide};
+            }
+            default:
+                return {};
+        }
+    }
+
+    /// @brief FNV-1a over raw bytes
+    static u64 HashBytes(const void* data, size_t size, u64 hash = 0xCBF29CE484222325ull) {
+        const auto* bytes = CAST<const u8*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+    void RadixSort(vector<u64>& keys, vector<u64>& scratch) {
+        const size_t count = keys.size();
+        if (count < 2) return;
+        scratch.resize(count);
+
+        // Build all eight digit histograms in a single read of the keys
+        u32 histograms[8][256];
+        std::memset(histograms, 0, sizeof(histograms));
+        for (const u64 key : keys) {
+            for (u32 digit = 0; digit < 8; ++digit) {
+                ++histograms[digit][(key >> (digit * 8)) & 0xFF];
+            }
+        }
+
+        u64* src = keys.data();
+        u64* dst = scratch.data();
+        for (u32 digit = 0; digit < 8; ++digit) {
+            u32* histogram = histograms[digit];
+            const u32 shift = digit * 8;
+
+            // Every key has the same value for this digit, the pass would be a no-op
+            if (histogram[(src[0] >> shift) & 0xFF] == count) continue;
+
+            u32 offset = 0;
+            for (u32 bucket = 0; bucket < 256; ++bucket) {
+                const u32 bucketCount = histogram[bucket];
+                histogram[bucket]     = offset;
+                offset += bucketCount;
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                const u64 key                          = src[i];
+                dst[histogram[(key >> shift) & 0xFF]++] = key;
+            }
+
+            std::swap(src, dst);
+        }
+
+        if (src != keys.data()) { std::memcpy(keys.data(), src, count * sizeof(u64)); }
+    }
+
+    void CommandQueue::Reset() {
+        mCommands.clear();
+        mPoints.clear();
+        mKeys.clear();
+    }
+
+    void CommandQueue::Push(const DrawCommand& command) {
+        mCommands.push_back(command);
+    }
+
+    u32 CommandQueue::PushPoints(const vector<Point>& points) {
+        const auto first = CAST<u32>(mPoints.size());
+        mPoints.insert(mPoints.end(), points.begin(), points.end());
+        return first;
+    }
+
+    u32 CommandQueue::Cull(const Rect& viewport, CoverageMask* occlusion) {
+        const auto count = CAST<u32>(mCommands.size());
+        if (count == 0) return 0;
+
+        // Walk back to front so later draws occlude earlier ones, flagging culled commands in the key scratch
+        mKeys.assign(count, 0);
+        for (u32 i = count; i-- > 0;) {
+            const DrawCommand& command = mCommands[i];
+            if (!command.bounds.Overlaps(viewport)) {
+                mKeys[i] = 1;
+                continue;
+            }
+
+            if (!occlusion) continue;
+            if (occlusion->IsOccluded(command.bounds.Intersect(viewport))) {
+                mKeys[i] = 1;
+                continue;
+            }
+
+            const Rect interior = GetOpaqueInterior(command);
+            if (!interior.IsEmpty()) { occlusion->Cover(interior); }
+        }
+
+        // Compact in place, preserving submission order
+        u32 kept = 0;
+        for (u32 i = 0; i < count; ++i) {
+            if (mKeys[i] == 0) { mCommands[kept++] = mCommands[i]; }
+        }
+        mCommands.resize(kept);
+        mKeys.clear();
+
+        return count - kept;
+    }
+
+    u64 CommandQueue::GetCommandHash(u32 sequence) const {
+        const DrawCommand& command = mCommands[sequence];
+
+        const u32 header[3] = {CAST<u32>(command.shape), command.GetState(), command.color};
+        u64 hash            = HashBytes(header, sizeof(header));
+        hash                = HashBytes(command.params, sizeof(command.params), hash);
+        hash                = HashBytes(&command.bounds, sizeof(Rect), hash);
+        if (command.pointCount > 0) {
+            hash = HashBytes(mPoints.data() + command.firstPoint, command.pointCount * sizeof(Point), hash);
+        }
+
+        return hash;
+    }
+
+    u32 CommandQueue::Append(const CommandQueue& other) {
+        return Append(other.mCommands.data(),
+               CAST<u32>(other.mCommands.size()),
+               other.mPoints.data(),
+               CAST<u32>(other.mPoints.size()));
+    }
+
+    u32 CommandQueue::Append(const DrawCommand* commands, u32 count, const Point* points, u32 pointCount) {
+        const size_t room = kMaxCommands - X_MIN(mCommands.size(), CAST<size_t>(kMaxCommands));
+        count             = CAST<u32>(X_MIN(CAST<size_t>(count), room));
+
+        // Only take the points the appended commands use. When the queue fills, the caller retries the rest after
+        // OnQueueFull(), and copying all of @p points each time would repeat them.
+        u32 firstPoint = pointCount;
+        u32 endPoint   = 0;
+        for (u32 i = 0; i < count; ++i) {
+            if (commands[i].pointCount == 0) continue;
+            firstPoint = X_MIN(firstPoint, commands[i].firstPoint);
+            endPoint   = X_MAX(endPoint, commands[i].firstPoint + commands[i].pointCount);
+        }
+        if (firstPoint >= endPoint) { firstPoint = endPoint = 0; }
+
+        const auto pointBase = CAST<u32>(mPoints.size());
+        mCommands.reserve(mCommands.size() + count);
+        for (u32 i = 0; i < count; ++i) {
+            DrawCommand command = commands[i];
+            command.firstPoint  = command.firstPoint - firstPoint + pointBase;
+            mCommands.push_back(command);
+        }
+        mPoints.insert(mPoints.end(), points + firstPoint, points + endPoint);
+
+        return count;
+    }
+
+    void CommandQueue::Sort(bool reorder) {
+        mKeys.clear();
+        mKeys.reserve(mCommands.size());
+
+        if (reorder && AssignLayers()) {
+            RadixSort(mKeys, mScratch);
+            return;
+        }
+
+        // Strict painter's order, keys are already sorted
+        mKeys.clear();
+        for (u32 i = 0; i < mCommands.size(); ++i) {
+            mKeys.push_back(SortKey::Make(0, 0, i));
+        }
+    }
+
+    bool CommandQueue::AssignLayers() {
+        for (u32 i = 0; i < mLayerCount; ++i) {
+            mLayers[i].clear();
+        }
+        mLayerCount = 0;
+
+        for (u32 sequence = 0; sequence < mCommands.size(); ++sequence) {
+            const DrawCommand& command = mCommands[sequence];
+            const u32 state            = command.GetState();
+
+            // Find the lowest layer that keeps this command after everything it overlaps. Overlapping a region of
+            // the same state allows sharing its layer (the sequence bits keep the pair ordered), a different state
+            // forces the layer above. Layer l can demand at most l + 1, so the scan stops once nothing below can
+            // raise the result.
+            u32 layer = 0;
+            for (u32 l = mLayerCount; l-- > 0;) {
+                if (layer >= l + 1) break;
+                for (const auto& region : mLayers[l]) {
+                    if (!region.bounds.Overlaps(command.bounds)) continue;
+                    layer = X_MAX(layer, region.state == state ? l : l + 1);
+                }
+            }
+
+            if (layer > SortKey::kMaxLayer) return false;
+
+            if (layer >= mLayerCount) {
+                mLayerCount = layer + 1;
+                if (mLayers.size() < mLayerCount) { mLayers.resize(mLayerCount); }
+            }
+
+            auto& regions = mLayers[layer];
+            bool merged   = false;
+            for (auto& region : regions) {
+                if (region.state == state) {
+                    region.bounds = region.bounds.Union(command.bounds);
+                    merged        = true;
+                    break;
+                }
+            }
+            if (!merged) { regions.push_back({state, command.bounds}); }
+
+            mKeys.push_back(SortKey::Make(layer, state, sequence));
+        }
+
+        return true;
+    }
+}  // namespace X
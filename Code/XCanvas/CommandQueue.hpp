@@ -0,0 +1,157 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+#include "Point.hpp"
+#include "Rect.hpp"
+#include "CoverageMask.hpp"
+
+namespace X {
+    enum class ShapeType : u8 { Line, Rectangle, Circle, Polygon };
+
+    /// @brief Primitive pipeline a command is drawn with. Fills tessellate to triangles, strokes to lines.
+    enum class Pipeline : u8 { Triangles = 0, Lines = 1 };
+
+    enum class BlendMode : u8 { Opaque = 0, Translucent = 1 };
+
+    /// @brief A single recorded draw call. Shapes are stored unexpanded and only tessellated at flush time.
+    struct DrawCommand {
+        /// @brief Far more than a circle ever needs; decoders reject larger counts rather than size a huge buffer
+        static constexpr u32 kMaxCircleSegments = 1u << 16;
+
+        ShapeType shape {ShapeType::Line};
+        Pipeline pipeline {Pipeline::Triangles};
+        BlendMode blend {BlendMode::Opaque};
+        u16 texture {0};
+        u32 color {0};     // Packed RGBA8, see Color::ToU32_ABGR()
+        f32 params[4] {};  // Line: x0, y0, x1, y1 | Rectangle: x, y, w, h | Circle: x, y, radius, segments
+        u32 firstPoint {0};
+        u32 pointCount {0};
+        Rect bounds;
+
+        /// @brief Pipeline, blend and texture packed together; commands with equal state can share a batch
+        X_ND u32 GetState() const {
+            return (CAST<u32>(pipeline) << 16) | (CAST<u32>(blend) << 14) | (texture & 0x3FFFu);
+        }
+    };
+
+    /**
+     * @brief 64-bit draw sort key, most significant field first:
+     *
+     *  | layer (20) | pipeline (4) | blend (2) | texture (14) | sequence (24) |
+     *
+     * The layer is the painter's-order depth: a command only lands in a higher layer when it overlaps an earlier
+     * command with different state. Sorting by key therefore groups equal state inside a layer while keeping every
+     * overlapping pair in submission order.
+     */
+    namespace SortKey {
+        static constexpr u32 kSequenceBits = 24;
+        static constexpr u32 kTextureBits  = 14;
+        static constexpr u32 kBlendBits    = 2;
+        static constexpr u32 kPipelineBits = 4;
+        static constexpr u32 kLayerBits    = 20;
+
+        static constexpr u32 kMaxLayer = (1u << kLayerBits) - 1;
+
+        static constexpr u64 Make(u32 layer, u32 state, u32 sequence) {
+            return (CAST<u64>(layer) << (64 - kLayerBits)) | (CAST<u64>(state) << kSequenceBits) | sequence;
+        }
+
+        static constexpr u32 GetSequence(u64 key) {
+            return CAST<u32>(key & ((1ull << kSequenceBits) - 1));
+        }
+    }  // namespace SortKey
+
+    static_assert(SortKey::kLayerBits + SortKey::kPipelineBits + SortKey::kBlendBits + SortKey::kTextureBits +
+                      SortKey::kSequenceBits ==
+                    64,
+                  "Sort key fields must fill exactly 64 bits");
+
+    /// @brief LSD radix sort over 8-bit digits. Passes whose digit is identical for every key are skipped.
+    void RadixSort(vector<u64>& keys, vector<u64>& scratch);
+
+    /**
+     * @brief Per-frame list of draw commands plus the point storage used by polygons.
+     *
+     * Commands are appended in submission order. Sort() computes a sort key per command and radix sorts them;
+     * GetSortedKeys() then yields the submission order, with GetSequence() mapping a key back to its command.
+     */
+    class CommandQueue {
+    public:
+        static constexpr u32 kMaxCommands = 1u << SortKey::kSequenceBits;
+
+        void Reset();
+        void Push(const DrawCommand& command);
+        u32 PushPoints(const vector<Point>& points);
+
+        /// @brief Append @p other's commands after this queue's, in order. Returns how many fit before it filled.
+        u32 Append(const CommandQueue& other);
+
+        /// @brief Append @p count commands stored outside a queue, their points indexing into @p points. Returns
+        /// how many fit before the queue filled; only the points of those are copied.
+        u32 Append(const DrawCommand* commands, u32 count, const Point* points, u32 pointCount);
+
+        /**
+         * @brief Drop commands that cannot produce visible pixels before any vertex work is done.
+         *
+         * Commands entirely outside @p viewport are always removed. When @p occlusion is non-null, commands are also
+         * walked back to front and removed if later opaque fills cover every tile they touch.
+         *
+         * @return Number of commands removed
+         */
+        u32 Cull(const Rect& viewport, CoverageMask* occlusion);
+
+        /// @brief Build sort keys. When @p reorder is false the keys are plain submission order.
+        void Sort(bool reorder);
+
+        X_ND bool IsEmpty() const {
+            return mCommands.empty();
+        }
+
+        X_ND bool IsFull() const {
+            return mCommands.size() >= kMaxCommands;
+        }
+
+        X_ND u32 GetCount() const {
+            return CAST<u32>(mCommands.size());
+        }
+
+        X_ND const DrawCommand& GetCommand(u32 sequence) const {
+            return mCommands[sequence];
+        }
+
+        X_ND const DrawCommand* GetCommands() const {
+            return mCommands.data();
+        }
+
+        /// @brief Content hash of a command (shape, state, color, geometry), used to diff frames
+        X_ND u64 GetCommandHash(u32 sequence) const;
+
+        X_ND const vector<u64>& GetSortedKeys() const {
+            return mKeys;
+        }
+
+        X_ND const vector<Point>& GetPoints() const {
+            return mPoints;
+        }
+
+    private:
+        /// @brief Union of the bounds of every command sharing one state within one layer
+        struct LayerRegion {
+            u32 state;
+            Rect bounds;
+        };
+
+        bool AssignLayers();
+
+        vector<DrawCommand> mCommands;
+        vector<Point> mPoints;
+        vector<u64> mKeys;
+        vector<u64> mScratch;
+        vector<vector<LayerRegion>> mLayers;
+        u32 mLayerCount {0};
+    };
+}  // namespace X
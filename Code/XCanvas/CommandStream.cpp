@@ -0,0 +1,662 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "CommandStream.hpp"
+#include "CommandList.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace X {
+    static constexpr u32 kStreamMagic   = 0x53434358;  // "XCCS"
+    static constexpr u32 kStreamVersion = 1;
+
+    // Record flags
+    static constexpr u8 kRecordClear     = 1u << 0;  // A clear color index follows the new colors
+    static constexpr u8 kRecordContinues = 1u << 1;  // The frame continues in the next record
+
+    // Command opcode: shape in the low two bits, then these
+    static constexpr u8 kCommandFilled = 1u << 2;
+    static constexpr u8 kCommandColor  = 1u << 3;  // A color index follows; otherwise the previous command's color
+    // Not a shape: a run of cache slots follows, the first relative to where the previous run ended, then its length
+    static constexpr u8 kCommandCached = 1u << 4;
+
+    // Coordinates are fixed point with this many steps per pixel, tagged in their low two bits
+    static constexpr f32 kCoordinateScale = 256.0f;
+    static constexpr f32 kCoordinateLimit = 1u << 30;
+    static constexpr u64 kCoordinateWhole = 0;  // Delta in whole pixels
+    static constexpr u64 kCoordinateFine  = 1;  // Delta in 1/256 pixels
+    static constexpr u64 kCoordinateRaw   = 2;  // A little-endian f32 follows
+
+    /// @brief LEB128: seven bits per byte, least significant first. Returns the bytes written, at most 10.
+    static size_t EncodeVarint(u64 value, u8* out) {
+        size_t size = 0;
+        while (value >= 0x80) {
+            out[size++] = CAST<u8>(value | 0x80);
+            value >>= 7;
+        }
+        out[size++] = CAST<u8>(value);
+        return size;
+    }
+
+    static void WriteVarint(vector<u8>& out, u64 value) {
+        u8 bytes[10];
+        out.insert(out.end(), bytes, bytes + EncodeVarint(value, bytes));
+    }
+
+    static void WriteU32(vector<u8>& out, u32 value) {
+        for (u32 shift = 0; shift < 32; shift += 8) {
+            out.push_back(CAST<u8>(value >> shift));
+        }
+    }
+
+    static constexpr u64 ZigZag(i64 value) {
+        return (CAST<u64>(value) << 1) ^ CAST<u64>(value >> 63);
+    }
+
+    static constexpr i64 UnZigZag(u64 value) {
+        return CAST<i64>(value >> 1) ^ -CAST<i64>(value & 1);
+    }
+
+    /**
+     * @brief Predictions for the next coordinates of one shape type, in 1/256 pixel steps.
+     *
+     * Positions continue the step between the previous two shapes, so rows and columns of widgets cost a byte per
+     * coordinate. Extents (line end relative to its start, rectangle size, circle radius in width) repeat the
+     * previous one. Arithmetic is unsigned so damaged input wraps instead of overflowing.
+     */
+    struct ShapePredictor {
+        struct Axis {
+            u64 last {0};
+            u64 step {0};
+
+            X_ND u64 Predict() const {
+                return last + step;
+            }
+
+            void Update(u64 value) {
+                step = value - last;
+                last = value;
+            }
+        };
+
+        Axis x, y;
+        u64 width {0};
+        u64 height {0};
+    };
+
+    /**
+     * @brief Write @p value relative to @p reference: the delta in whole pixels tagged 0 when it is one, else in
+     * 1/256 pixel steps tagged 1. Values that aren't multiples of 1/256 in range, and -0, are written as the tag 2
+     * followed by the raw float. Returns whether the value was relative, in which case @p reference is now it.
+     */
+    static bool WriteCoordinate(vector<u8>& out, const f32 value, u64& reference) {
+        const f32 scaled        = value * kCoordinateScale;
+        const bool negativeZero = scaled == 0.0f && std::signbit(value);
+        if (std::floor(scaled) != scaled || std::fabs(scaled) >= kCoordinateLimit || negativeZero) {
+            u32 bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            WriteVarint(out, kCoordinateRaw);
+            WriteU32(out, bits);
+            return false;
+        }
+
+        const auto fixed = CAST<u64>(CAST<i64>(scaled));
+        const auto delta = CAST<i64>(fixed - reference);
+        reference        = fixed;
+        if (delta % 256 == 0) {
+            WriteVarint(out, ZigZag(delta / 256) << 2 | kCoordinateWhole);
+        } else {
+            WriteVarint(out, ZigZag(delta) << 2 | kCoordinateFine);
+        }
+        return true;
+    }
+
+    static void WritePosition(vector<u8>& out, const f32 value, ShapePredictor::Axis& axis) {
+        u64 reference = axis.Predict();
+        if (WriteCoordinate(out, value, reference)) { axis.Update(reference); }
+    }
+
+    static void WriteExtent(vector<u8>& out, const f32 value, const u64 origin, u64& extent) {
+        u64 reference = origin + extent;
+        if (WriteCoordinate(out, value, reference)) { extent = reference - origin; }
+    }
+
+    /// @brief Bounds-checked decoding over a mapped record. Reads past the end return 0 and clear ok.
+    struct StreamReader {
+        const u8* cursor;
+        const u8* end;
+        bool ok {true};
+
+        u8 Byte() {
+            if (cursor == end) {
+                ok = false;
+                return 0;
+            }
+            return *cursor++;
+        }
+
+        u64 Varint() {
+            u64 value = 0;
+            for (u32 shift = 0; shift < 64; shift += 7) {
+                const u8 byte = Byte();
+                value |= CAST<u64>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) return value;
+            }
+            ok = false;
+            return 0;
+        }
+
+        u32 U32() {
+            if (end - cursor < 4) {
+                ok     = false;
+                cursor = end;
+                return 0;
+            }
+            const u32 value = cursor[0] | (cursor[1] << 8) | (cursor[2] << 16) | (CAST<u32>(cursor[3]) << 24);
+            cursor += 4;
+            return value;
+        }
+
+        /// @brief Inverse of WriteCoordinate()
+        f32 Coordinate(u64& reference, bool& relative) {
+            const u64 code = Varint();
+            relative       = true;
+            switch (code & 3) {
+                case kCoordinateWhole:
+                    reference += CAST<u64>(UnZigZag(code >> 2)) * 256;
+                    break;
+                case kCoordinateFine:
+                    reference += CAST<u64>(UnZigZag(code >> 2));
+                    break;
+                case kCoordinateRaw: {
+                    relative       = false;
+                    const u32 bits = U32();
+                    f32 value;
+                    std::memcpy(&value, &bits, sizeof(value));
+                    return value;
+                }
+                default:
+                    relative = false;
+                    ok       = false;
+                    return 0.0f;
+            }
+            return CAST<f32>(CAST<i64>(reference)) / kCoordinateScale;
+        }
+
+        f32 Position(ShapePredictor::Axis& axis) {
+            u64 reference = axis.Predict();
+            bool relative;
+            const f32 value = Coordinate(reference, relative);
+            if (relative) { axis.Update(reference); }
+            return value;
+        }
+
+        f32 Extent(const u64 origin, u64& extent) {
+            u64 reference = origin + extent;
+            bool relative;
+            const f32 value = Coordinate(reference, relative);
+            if (relative) { extent = reference - origin; }
+            return value;
+        }
+    };
+
+    /// @brief Reader over the record at @p data, past its size prefix
+    static StreamReader OpenRecord(const u8* data, size_t size) {
+        StreamReader reader {data, data + size};
+        const u64 recordSize = reader.Varint();
+        reader.end           = reader.cursor + X_MIN(recordSize, CAST<u64>(reader.end - reader.cursor));
+        return reader;
+    }
+
+    CommandStreamEncoder::CommandStreamEncoder(u32 cacheSlots) : mCache(cacheSlots) {}
+
+    void CommandStreamEncoder::WriteHeader(vector<u8>& out) {
+        WriteU32(out, kStreamMagic);
+        WriteU32(out, kStreamVersion);
+    }
+
+    void CommandStreamEncoder::Encode(
+      const CommandQueue& queue, u32 width, u32 height, const Color* clearColor, bool complete, vector<u8>& out) {
+        mCommands.clear();
+        mNewColors.clear();
+        mCachedCount = 0;
+
+        const u32 count             = queue.GetCount();
+        const vector<Point>& points = queue.GetPoints();
+        const auto slots            = CAST<u32>(mCache.size());
+        ShapePredictor predictors[4];
+        u32 color        = UINT32_MAX;
+        u32 expectedSlot = 0;
+
+        if (slots > 0) {
+            mHashes.resize(count);
+            for (u32 i = 0; i < count; ++i) {
+                mHashes[i] = queue.GetCommandHash(i);
+            }
+        }
+
+        WriteVarint(mCommands, count);
+        for (u32 i = 0; i < count;) {
+            const u32 slot = slots > 0 ? FindCached(queue, i, mHashes[i]) : UINT32_MAX;
+            if (slot != UINT32_MAX) {
+                // Commands repeated in the order they were sent hit consecutive slots
+                u32 run = 1;
+                while (i + run < count && FindCached(queue, i + run, mHashes[i + run]) == (slot + run) % slots) {
+                    ++run;
+                }
+                mCommands.push_back(kCommandCached);
+                WriteVarint(mCommands, ZigZag(CAST<i64>(slot) - expectedSlot));
+                WriteVarint(mCommands, run - 1);
+                color        = mCache[(slot + run - 1) % slots].colorIndex;
+                expectedSlot = (slot + run) % slots;
+                mCachedCount += run;
+                i += run;
+                continue;
+            }
+
+            const DrawCommand& command = queue.GetCommand(i);
+            const u32 index            = Intern(command.color);
+
+            u8 opcode = CAST<u8>(command.shape);
+            if (command.pipeline == Pipeline::Triangles) { opcode |= kCommandFilled; }
+            if (index != color) { opcode |= kCommandColor; }
+            mCommands.push_back(opcode);
+            if (index != color) { WriteVarint(mCommands, index); }
+            color = index;
+
+            const f32* params         = command.params;
+            ShapePredictor& predictor = predictors[CAST<u8>(command.shape)];
+            switch (command.shape) {
+                case ShapeType::Line:
+                    WritePosition(mCommands, params[0], predictor.x);
+                    WritePosition(mCommands, params[1], predictor.y);
+                    WriteExtent(mCommands, params[2], predictor.x.last, predictor.width);
+                    WriteExtent(mCommands, params[3], predictor.y.last, predictor.height);
+                    break;
+                case ShapeType::Rectangle:
+                    WritePosition(mCommands, params[0], predictor.x);
+                    WritePosition(mCommands, params[1], predictor.y);
+                    WriteExtent(mCommands, params[2], 0, predictor.width);
+                    WriteExtent(mCommands, params[3], 0, predictor.height);
+                    break;
+                case ShapeType::Circle:
+                    WritePosition(mCommands, params[0], predictor.x);
+                    WritePosition(mCommands, params[1], predictor.y);
+                    WriteExtent(mCommands, params[2], 0, predictor.width);
+                    WriteVarint(mCommands, CAST<u32>(params[3]));
+                    break;
+                case ShapeType::Polygon: {
+                    // Points after the first are relative to the one before them
+                    WriteVarint(mCommands, command.pointCount);
+                    const Point* polygon = points.data() + command.firstPoint;
+                    WritePosition(mCommands, polygon[0].x, predictor.x);
+                    WritePosition(mCommands, polygon[0].y, predictor.y);
+                    u64 x = predictor.x.last, y = predictor.y.last;
+                    for (u32 p = 1; p < command.pointCount; ++p) {
+                        WriteCoordinate(mCommands, polygon[p].x, x);
+                        WriteCoordinate(mCommands, polygon[p].y, y);
+                    }
+                    break;
+                }
+            }
+
+            if (slots > 0) { AddToCache(queue, i, mHashes[i], index); }
+            ++i;
+        }
+
+        const u32 clearIndex = clearColor ? Intern(clearColor->ToU32_ABGR()) : 0;
+
+        mHeader.clear();
+        WriteVarint(mHeader, width);
+        WriteVarint(mHeader, height);
+        mHeader.push_back((clearColor ? kRecordClear : 0) | (complete ? 0 : kRecordContinues));
+        WriteVarint(mHeader, mNewColors.size());
+        for (const u32 newColor : mNewColors) {
+            WriteU32(mHeader, newColor);
+        }
+        if (clearColor) { WriteVarint(mHeader, clearIndex); }
+
+        WriteVarint(out, mHeader.size() + mCommands.size());
+        out.insert(out.end(), mHeader.begin(), mHeader.end());
+        out.insert(out.end(), mCommands.begin(), mCommands.end());
+    }
+
+    u32 CommandStreamEncoder::Intern(u32 color) {
+        const auto [it, inserted] = mColors.try_emplace(color, CAST<u32>(mColors.size()));
+        if (inserted) { mNewColors.push_back(color); }
+        return it->second;
+    }
+
+    u32 CommandStreamEncoder::FindCached(const CommandQueue& queue, u32 index, u64 hash) const {
+        const auto it = mCacheSlots.find(hash);
+        if (it == mCacheSlots.end()) return UINT32_MAX;
+
+        // Hashes can collide, so only an identical command is a hit
+        const CacheEntry& entry    = mCache[it->second];
+        const DrawCommand& command = queue.GetCommand(index);
+        const DrawCommand& cached  = entry.command;
+        if (command.shape != cached.shape || command.GetState() != cached.GetState() || command.color != cached.color ||
+            std::memcmp(command.params, cached.params, sizeof(command.params)) != 0 ||
+            command.pointCount != cached.pointCount) {
+            return UINT32_MAX;
+        }
+        if (command.pointCount > 0 && std::memcmp(queue.GetPoints().data() + command.firstPoint,
+                                                  entry.points.data(),
+                                                  command.pointCount * sizeof(Point)) != 0) {
+            return UINT32_MAX;
+        }
+        return it->second;
+    }
+
+    void CommandStreamEncoder::AddToCache(const CommandQueue& queue, u32 index, u64 hash, u32 colorIndex) {
+        const u32 slot    = mNextSlot;
+        mNextSlot         = (mNextSlot + 1) % CAST<u32>(mCache.size());
+        CacheEntry& entry = mCache[slot];
+        if (entry.valid) {
+            const auto it = mCacheSlots.find(entry.hash);
+            if (it != mCacheSlots.end() && it->second == slot) { mCacheSlots.erase(it); }
+        }
+
+        const DrawCommand& command = queue.GetCommand(index);
+        const Point* points        = queue.GetPoints().data() + command.firstPoint;
+        entry.hash                 = hash;
+        entry.colorIndex           = colorIndex;
+        entry.command              = command;
+        entry.points.assign(points, points + command.pointCount);
+        entry.valid       = true;
+        mCacheSlots[hash] = slot;
+    }
+
+    CommandStreamDecoder::CommandStreamDecoder(u32 cacheSlots) : mCache(cacheSlots) {}
+
+    bool CommandStreamDecoder::ReadHeader(const u8* data, size_t size) {
+        StreamReader reader {data, data + size};
+        const u32 magic   = reader.U32();
+        const u32 version = reader.U32();
+        return reader.ok && magic == kStreamMagic && version == kStreamVersion;
+    }
+
+    bool CommandStreamDecoder::ReadRecordSize(const u8* data, size_t size, size_t& recordSize) {
+        StreamReader reader {data, data + size};
+        const u64 bodySize = reader.Varint();
+        const auto prefix  = CAST<size_t>(reader.cursor - data);
+        if (!reader.ok || bodySize > SIZE_MAX - prefix) {
+            recordSize = 0;
+            return false;
+        }
+        recordSize = prefix + CAST<size_t>(bodySize);
+        return recordSize <= size;
+    }
+
+    bool CommandStreamDecoder::ReadRecordInfo(const u8* data, size_t size, CommandRecordInfo& info) {
+        StreamReader reader = OpenRecord(data, size);
+        const u64 width     = reader.Varint();
+        const u64 height    = reader.Varint();
+        info.continues      = (reader.Byte() & kRecordContinues) != 0;
+        // A frame the renderer couldn't allocate a target for is as good as damaged
+        if (!CanvasFrame::IsValidSize(width, height)) return false;
+        info.width  = CAST<u32>(width);
+        info.height = CAST<u32>(height);
+        return reader.ok;
+    }
+
+    bool CommandStreamDecoder::AddColors(const u8* data, size_t size) {
+        StreamReader reader = OpenRecord(data, size);
+        reader.Varint();  // Width and height
+        reader.Varint();
+        reader.Byte();
+        const u64 count = reader.Varint();
+        if (count > CAST<u64>(reader.end - reader.cursor) / 4) return false;
+        for (u64 i = 0; i < count; ++i) {
+            // Stored as DrawCommand::color, 0xAABBGGRR
+            const u32 color = reader.U32();
+            mColors.emplace_back(CAST<u8>(color), CAST<u8>(color >> 8), CAST<u8>(color >> 16), CAST<u8>(color >> 24));
+        }
+        return reader.ok;
+    }
+
+    bool CommandStreamDecoder::Replay(const u8* data, size_t size, FrameTarget& canvas, bool colorsAdded) {
+        if (!colorsAdded && !AddColors(data, size)) return false;
+
+        StreamReader reader = OpenRecord(data, size);
+        reader.Varint();  // Width and height, known to the caller
+        reader.Varint();
+        const u8 flags = reader.Byte();
+        const u64 colorBytes = reader.Varint() * 4;  // Already in the color table
+        reader.cursor += X_MIN(colorBytes, CAST<u64>(reader.end - reader.cursor));
+        if (flags & kRecordClear) {
+            const u64 clear = reader.Varint();
+            if (clear >= mColors.size()) return false;
+            canvas.Clear(mColors[clear]);
+        }
+
+        CommandList& recorder = canvas.GetRecorder();
+
+        const auto slots = CAST<u64>(mCache.size());
+        ShapePredictor predictors[4];
+        u64 color        = UINT64_MAX;
+        u64 expectedSlot = 0;
+
+        const u64 count = reader.Varint();
+        for (u64 i = 0; i < count && reader.ok;) {
+            const u8 opcode = reader.Byte();
+            if (opcode & kCommandCached) {
+                const u64 slot = expectedSlot + CAST<u64>(UnZigZag(reader.Varint()));
+                const u64 run  = reader.Varint() + 1;
+                if (!reader.ok || slot >= slots || run > count - i) return false;
+                for (u64 k = 0; k < run; ++k) {
+                    const Command& cached = mCache[(slot + k) % slots];
+                    if (!cached.valid) return false;
+                    Draw(cached, recorder);
+                }
+                color        = mCache[(slot + run - 1) % slots].color;
+                expectedSlot = (slot + run) % slots;
+                i += run;
+                continue;
+            }
+
+            Command& command = mCommand;
+            command.opcode   = opcode & (3 | kCommandFilled);
+            if (opcode & kCommandColor) { color = reader.Varint(); }
+            if (color >= mColors.size()) return false;
+            command.color = CAST<u32>(color);
+
+            f32* params               = command.params;
+            const auto shape          = CAST<ShapeType>(opcode & 3);
+            ShapePredictor& predictor = predictors[CAST<u8>(shape)];
+            switch (shape) {
+                case ShapeType::Line:
+                    params[0] = reader.Position(predictor.x);
+                    params[1] = reader.Position(predictor.y);
+                    params[2] = reader.Extent(predictor.x.last, predictor.width);
+                    params[3] = reader.Extent(predictor.y.last, predictor.height);
+                    break;
+                case ShapeType::Rectangle:
+                    params[0] = reader.Position(predictor.x);
+                    params[1] = reader.Position(predictor.y);
+                    params[2] = reader.Extent(0, predictor.width);
+                    params[3] = reader.Extent(0, predictor.height);
+                    break;
+                case ShapeType::Circle: {
+                    params[0]          = reader.Position(predictor.x);
+                    params[1]          = reader.Position(predictor.y);
+                    params[2]          = reader.Extent(0, predictor.width);
+                    const u64 segments = reader.Varint();
+                    if (segments < 3 || segments > DrawCommand::kMaxCircleSegments) return false;
+                    params[3] = CAST<f32>(segments);
+                    break;
+                }
+                case ShapeType::Polygon: {
+                    // Every point takes at least two bytes, so a damaged count can't make this allocate much
+                    const u64 pointCount = reader.Varint();
+                    if (pointCount == 0 || pointCount > CAST<u64>(reader.end - reader.cursor) / 2) return false;
+                    vector<Point>& points = command.points;
+                    points.resize(pointCount, {0.0f, 0.0f});
+                    points[0].x = reader.Position(predictor.x);
+                    points[0].y = reader.Position(predictor.y);
+                    u64 x = predictor.x.last, y = predictor.y.last;
+                    bool relative;
+                    for (u64 p = 1; p < pointCount; ++p) {
+                        points[p].x = reader.Coordinate(x, relative);
+                        points[p].y = reader.Coordinate(y, relative);
+                    }
+                    break;
+                }
+            }
+            if (!reader.ok) break;
+
+            Draw(command, recorder);
+            if (slots > 0) {
+                command.valid     = true;
+                mCache[mNextSlot] = command;
+                mNextSlot         = CAST<u32>((mNextSlot + 1) % slots);
+            }
+            ++i;
+        }
+        return reader.ok;
+    }
+
+    void CommandStreamDecoder::Draw(const Command& command, CommandList& list) const {
+        const bool filled  = (command.opcode & kCommandFilled) != 0;
+        const f32* params  = command.params;
+        const Color& color = mColors[command.color];
+        if (filled) {
+            list.SetFillColor(color);
+        } else {
+            list.SetStrokeColor(color);
+        }
+
+        switch (CAST<ShapeType>(command.opcode & 3)) {
+            case ShapeType::Line:
+                list.DrawLine(params[0], params[1], params[2], params[3]);
+                break;
+            case ShapeType::Rectangle:
+                list.DrawRectangle(params[0], params[1], params[2], params[3], filled);
+                break;
+            case ShapeType::Circle:
+                list.DrawCircle(params[0], params[1], params[2], CAST<u32>(params[3]), filled);
+                break;
+            case ShapeType::Polygon:
+                list.DrawPolygon(command.points, filled);
+                break;
+        }
+    }
+
+    CommandStreamRecorder::CommandStreamRecorder(const string& path) : mFile(path, std::ios::binary | std::ios::trunc) {
+        if (!mFile) { throw std::runtime_error("Failed to create command stream: " + path); }
+
+        CommandStreamEncoder::WriteHeader(mRecord);
+        mFile.write(RCAST<const char*>(mRecord.data()), CAST<std::streamsize>(mRecord.size()));
+    }
+
+    void CommandStreamRecorder::Record(const CanvasFrame& frame, bool complete) {
+        mRecord.clear();
+        const Color* clearColor = frame.clearPending ? &frame.clearColor : nullptr;
+        mEncoder.Encode(frame.queue, frame.width, frame.height, clearColor, complete, mRecord);
+        mFile.write(RCAST<const char*>(mRecord.data()), CAST<std::streamsize>(mRecord.size()));
+        if (complete) { ++mFramesRecorded; }
+    }
+
+    CommandStreamPlayer::CommandStreamPlayer(const string& path) {
+#if defined(_WIN32)
+        const HANDLE file = CreateFileA(
+          path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) { throw std::runtime_error("Failed to open command stream: " + path); }
+        LARGE_INTEGER fileSize {};
+        GetFileSizeEx(file, &fileSize);
+        mSize = CAST<size_t>(fileSize.QuadPart);
+        if (mSize > 0) {
+            mMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mMapping) { mData = CAST<const u8*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0)); }
+        }
+        CloseHandle(file);
+#else
+        const i32 file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0) { throw std::runtime_error("Failed to open command stream: " + path); }
+        struct stat status {};
+        fstat(file, &status);
+        mSize = CAST<size_t>(status.st_size);
+        if (mSize > 0) {
+            void* data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, file, 0);
+            if (data != MAP_FAILED) {
+                mData = CAST<const u8*>(data);
+                // Replay walks records front to back
+                madvise(data, mSize, MADV_SEQUENTIAL);
+            }
+        }
+        close(file);
+#endif
+        if (mSize > 0 && !mData) {
+            Unmap();
+            throw std::runtime_error("Failed to map command stream: " + path);
+        }
+        if (!CommandStreamDecoder::ReadHeader(mData, mSize)) {
+            Unmap();
+            throw std::runtime_error("Not a compatible command stream: " + path);
+        }
+
+        // Index the frames and collect the color table from the record headers, skipping the commands
+        bool continues = false;
+        size_t offset  = CommandStreamDecoder::kHeaderSize;
+        while (offset < mSize) {
+            size_t size = 0;
+            CommandRecordInfo info;
+            const u8* record = mData + offset;
+            if (!CommandStreamDecoder::ReadRecordSize(record, mSize - offset, size)) break;  // Cut short mid-write
+            if (!CommandStreamDecoder::ReadRecordInfo(record, size, info) || !mDecoder.AddColors(record, size)) break;
+
+            if (continues) {
+                mFrames.back().end = offset + size;
+            } else {
+                mFrames.push_back({offset, offset + size, info.width, info.height});
+            }
+            continues = info.continues;
+            offset += size;
+        }
+    }
+
+    CommandStreamPlayer::~CommandStreamPlayer() {
+        Unmap();
+    }
+
+    void CommandStreamPlayer::Unmap() {
+#if defined(_WIN32)
+        if (mData) { UnmapViewOfFile(mData); }
+        if (mMapping) { CloseHandle(mMapping); }
+#else
+        if (mData) { munmap(CCAST<u8*>(mData), mSize); }
+#endif
+        mData    = nullptr;
+        mMapping = nullptr;
+    }
+
+    bool CommandStreamPlayer::Replay(u32 index, FrameTarget& canvas) {
+        X_ASSERT(index < mFrames.size(), "CommandStreamPlayer::Replay() - frame index out of range");
+        if (index >= mFrames.size()) return false;
+
+        // Records were checked when the file was indexed
+        size_t offset = mFrames[index].begin;
+        while (offset < mFrames[index].end) {
+            size_t size = 0;
+            CommandStreamDecoder::ReadRecordSize(mData + offset, mSize - offset, size);
+            if (!mDecoder.Replay(mData + offset, size, canvas, true)) return false;
+            offset += size;
+        }
+        return true;
+    }
+}  // namespace X
@@ -0,0 +1,211 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+#include "Color.hpp"
+#include "Point.hpp"
+#include "CommandQueue.hpp"
+
+#include <fstream>
+#include <unordered_map>
+
+namespace X {
+    class CommandList;
+    class FrameTarget;
+    struct CanvasFrame;
+
+    /**
+     * @brief Encodes frames of draw commands into the command stream format.
+     *
+     * A stream is a header (see WriteHeader()) followed by size-prefixed records, one per frame or, for a frame
+     * cut short by a full queue (see CommandList::OnQueueFull()), several. Colors are interned: a record lists only
+     * the colors the stream hasn't seen yet, and commands refer to them by index, repeating one only when it
+     * changes. Coordinates are varint deltas from a prediction based on the previous shapes of the same kind, in
+     * whole pixels or 1/256 pixel steps. That covers anything computed from integers or simple fractions; other
+     * values are stored as plain floats, so decoding is exact either way. A rectangle in a regular layout takes five
+     * bytes. Records start from fresh predictions.
+     *
+     * With a geometry cache, both ends remember the last commands sent in full and repeats go out as runs of cache
+     * references, so a frame that mostly matches the previous one costs a few bytes per run of unchanged commands.
+     * The decoder then needs every record in order, which suits a live connection but not random access.
+     */
+    class CommandStreamEncoder {
+    public:
+        /// @brief Remember the last @p cacheSlots commands sent in full, 0 for no geometry cache
+        explicit CommandStreamEncoder(u32 cacheSlots = 0);
+
+        /// @brief Append the stream header to @p out
+        static void WriteHeader(vector<u8>& out);
+
+        /**
+         * @brief Append a record holding @p queue's commands, drawn on a @p width x @p height canvas, to @p out.
+         *
+         * @p clearColor is the frame's Clear(), nullptr if none. @p complete is false when the frame continues in the
+         * next record.
+         */
+        void Encode(
+          const CommandQueue& queue, u32 width, u32 height, const Color* clearColor, bool complete, vector<u8>& out);
+
+        /// @brief Commands the last Encode() sent as cache references
+        X_ND u32 GetCachedCount() const {
+            return mCachedCount;
+        }
+
+    private:
+        struct CacheEntry {
+            u64 hash {0};
+            u32 colorIndex {0};
+            DrawCommand command;
+            vector<Point> points;
+            bool valid {false};
+        };
+
+        u32 Intern(u32 color);
+        X_ND u32 FindCached(const CommandQueue& queue, u32 index, u64 hash) const;
+        void AddToCache(const CommandQueue& queue, u32 index, u64 hash, u32 colorIndex);
+
+        vector<u8> mHeader;      // Of the record being built; it lists the colors its commands introduce
+        vector<u8> mCommands;    // Of the record being built
+        vector<u32> mNewColors;  // Interned by the record being built
+        std::unordered_map<u32, u32> mColors;
+
+        vector<CacheEntry> mCache;  // Ring of commands sent in full, empty without a geometry cache
+        std::unordered_map<u64, u32> mCacheSlots;
+        vector<u64> mHashes;  // Of the queue being encoded
+        u32 mNextSlot {0};
+        u32 mCachedCount {0};
+    };
+
+    /// @brief The start of a record, see CommandStreamDecoder::ReadRecordInfo()
+    struct CommandRecordInfo {
+        u32 width {0};
+        u32 height {0};
+        bool continues {false};  // The frame continues in the next record
+    };
+
+    /// @brief Decodes command stream records back into Canvas draw calls without allocating
+    class CommandStreamDecoder {
+    public:
+        /// @brief @p cacheSlots must match the encoder's
+        explicit CommandStreamDecoder(u32 cacheSlots = 0);
+
+        static constexpr size_t kHeaderSize = 8;
+
+        /// @brief Check the stream header at @p data, kHeaderSize bytes
+        static bool ReadHeader(const u8* data, size_t size);
+
+        /**
+         * @brief Find the extent of the record at @p data, its size prefix included.
+         *
+         * Returns false if fewer than its @p recordSize bytes are available, or if the prefix is damaged, in which
+         * case @p recordSize is 0.
+         */
+        static bool ReadRecordSize(const u8* data, size_t size, size_t& recordSize);
+
+        /// @brief Read the start of a record found by ReadRecordSize(). False if it is damaged or its size is invalid.
+        static bool ReadRecordInfo(const u8* data, size_t size, CommandRecordInfo& info);
+
+        /// @brief Add the colors a record introduces to the table ahead of replaying it, for random access
+        bool AddColors(const u8* data, size_t size);
+
+        /**
+         * @brief Issue a record's Clear() and draw calls on @p canvas, between its Begin() and End().
+         *
+         * Reads the colors the record introduces unless AddColors() already did. Leaves the canvas' fill and stroke
+         * colors at the last ones used. Returns false if the record is damaged; whatever decoded before the damage
+         * has been drawn.
+         */
+        bool Replay(const u8* data, size_t size, FrameTarget& canvas, bool colorsAdded = false);
+
+    private:
+        struct Command {
+            u8 opcode {0};  // Shape and fill
+            u32 color {0};
+            f32 params[4] {};
+            vector<Point> points;
+            bool valid {false};
+        };
+
+        void Draw(const Command& command, CommandList& list) const;
+
+        vector<Color> mColors;
+        Command mCommand;        // Being decoded, reused across commands
+        vector<Command> mCache;  // Ring mirroring the encoder's, empty without a geometry cache
+        u32 mNextSlot {0};
+    };
+
+    /**
+     * @brief Writes every frame a Canvas records to a command stream file, see Canvas::SetRecorder().
+     *
+     * Files have no geometry cache, so any frame can be replayed without decoding the ones before it.
+     */
+    class CommandStreamRecorder {
+    public:
+        /// @brief Throws std::runtime_error if @p path can't be created
+        explicit CommandStreamRecorder(const string& path);
+
+        /// @brief Append @p frame's commands. @p complete is false when the frame continues in the next call.
+        void Record(const CanvasFrame& frame, bool complete);
+
+        X_ND u64 GetFramesRecorded() const {
+            return mFramesRecorded;
+        }
+
+    private:
+        std::ofstream mFile;
+        CommandStreamEncoder mEncoder;
+        vector<u8> mRecord;  // Reused across frames
+        u64 mFramesRecorded {0};
+    };
+
+    /**
+     * @brief Replays a command stream file written by CommandStreamRecorder.
+     *
+     * The file is memory-mapped and indexed when opened, reading only record headers, so frames can be replayed
+     * in any order. Replay() decodes straight from the mapping into the canvas' draw calls without allocating.
+     */
+    class CommandStreamPlayer {
+    public:
+        /// @brief Throws std::runtime_error if @p path can't be opened or isn't a compatible stream
+        explicit CommandStreamPlayer(const string& path);
+        ~CommandStreamPlayer();
+
+        CommandStreamPlayer(const CommandStreamPlayer&)            = delete;
+        CommandStreamPlayer& operator=(const CommandStreamPlayer&) = delete;
+
+        X_ND u32 GetFrameCount() const {
+            return CAST<u32>(mFrames.size());
+        }
+
+        /// @brief Size of the canvas frame @p index was recorded on
+        X_ND u32 GetFrameWidth(u32 index) const {
+            return mFrames[index].width;
+        }
+
+        X_ND u32 GetFrameHeight(u32 index) const {
+            return mFrames[index].height;
+        }
+
+        /// @brief Issue frame @p index's Clear() and draw calls on @p canvas, see CommandStreamDecoder::Replay()
+        bool Replay(u32 index, FrameTarget& canvas);
+
+    private:
+        struct Frame {
+            size_t begin;  // Offset of the frame's first record
+            size_t end;    // One past its last record
+            u32 width;
+            u32 height;
+        };
+
+        void Unmap();
+
+        const u8* mData {nullptr};
+        size_t mSize {0};
+        void* mMapping {nullptr};  // File mapping handle on Windows
+        vector<Frame> mFrames;
+        CommandStreamDecoder mDecoder;
+    };
+}  // namespace X
@@ -0,0 +1,59 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "CoverageMask.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace X {
+    void CoverageMask::Reset(u32 width, u32 height, u32 tileSize) {
+        mWidth        = CAST<f32>(width);
+        mHeight       = CAST<f32>(height);
+        mTileSize     = tileSize;
+        mColumns      = (width + tileSize - 1) / tileSize;
+        mRows         = (height + tileSize - 1) / tileSize;
+        mCoveredCount = 0;
+        mTiles.assign(CAST<size_t>(mColumns) * mRows, 0);
+    }
+
+    void CoverageMask::Cover(const Rect& interior) {
+        const f32 size = CAST<f32>(mTileSize);
+
+        // Only tiles whose visible extent lies inside the rect; round inwards. The last row and column may be
+        // partial, reaching the viewport edge is enough to cover them.
+        const i64 x0 = X_MAX(CAST<i64>(std::ceil(interior.left / size)), 0);
+        const i64 y0 = X_MAX(CAST<i64>(std::ceil(interior.top / size)), 0);
+        const i64 x1 = interior.right >= mWidth ? mColumns : CAST<i64>(std::floor(interior.right / size));
+        const i64 y1 = interior.bottom >= mHeight ? mRows : CAST<i64>(std::floor(interior.bottom / size));
+
+        for (i64 y = y0; y < y1; ++y) {
+            u8* row = mTiles.data() + y * mColumns;
+            for (i64 x = x0; x < x1; ++x) {
+                mCoveredCount += row[x] ^ 1;
+                row[x] = 1;
+            }
+        }
+    }
+
+    bool CoverageMask::IsOccluded(const Rect& bounds) const {
+        if (mCoveredCount == 0) return false;
+
+        const f32 size = CAST<f32>(mTileSize);
+
+        // Every tile the bounds touch; round outwards
+        const i64 x0 = X_MAX(CAST<i64>(std::floor(bounds.left / size)), 0);
+        const i64 y0 = X_MAX(CAST<i64>(std::floor(bounds.top / size)), 0);
+        const i64 x1 = X_MIN(CAST<i64>(std::ceil(bounds.right / size)), CAST<i64>(mColumns));
+        const i64 y1 = X_MIN(CAST<i64>(std::ceil(bounds.bottom / size)), CAST<i64>(mRows));
+        if (x0 >= x1 || y0 >= y1) return false;
+
+        for (i64 y = y0; y < y1; ++y) {
+            const u8* row = mTiles.data() + y * mColumns;
+            if (std::find(row + x0, row + x1, 0) != row + x1) return false;
+        }
+
+        return true;
+    }
+}  // namespace X
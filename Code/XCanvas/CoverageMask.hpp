@@ -0,0 +1,42 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+#include "Rect.hpp"
+
+namespace X {
+    /**
+     * @brief Coarse tile grid recording which tiles are fully covered by opaque geometry.
+     *
+     * Used for occlusion culling: walking draws from last to first, a draw whose bounds only touch covered tiles
+     * cannot contribute a visible pixel.
+     */
+    class CoverageMask {
+    public:
+        static constexpr u32 kDefaultTileSize = 32;
+
+        void Reset(u32 width, u32 height, u32 tileSize = kDefaultTileSize);
+
+        /// @brief Mark every tile lying entirely inside @p interior as covered
+        void Cover(const Rect& interior);
+
+        /// @brief True if every tile touched by @p bounds is covered
+        X_ND bool IsOccluded(const Rect& bounds) const;
+
+        X_ND bool IsEmpty() const {
+            return mCoveredCount == 0;
+        }
+
+    private:
+        f32 mWidth {0.0f};
+        f32 mHeight {0.0f};
+        u32 mTileSize {kDefaultTileSize};
+        u32 mColumns {0};
+        u32 mRows {0};
+        u32 mCoveredCount {0};
+        vector<u8> mTiles;
+    };
+}  // namespace X
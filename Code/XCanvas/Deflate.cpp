@@ -0,0 +1,503 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "Deflate.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace X {
+    static constexpr size_t kWindowSize = 32768;
+    static constexpr u32 kMinMatch      = 3;
+    static constexpr u32 kMaxMatch      = 258;
+    static constexpr u32 kHashBits      = 15;
+    static constexpr u32 kMaxChain      = 16;   // Candidates tried per position, trading ratio for speed
+    static constexpr u32 kNiceMatch     = 128;  // Long enough to stop searching for a better one
+    static constexpr size_t kBlockTokens = 16384;
+
+    static constexpr u16 kLengthBase[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                            31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static constexpr u8 kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                            2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static constexpr u16 kDistanceBase[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,
+                                              33,  49,  65,  97,  129, 193,  257,  385,  513,  769,
+                                              1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    static constexpr u8 kDistanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                              6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+    // Order in which a dynamic block header lists the code length code's lengths
+    static constexpr u8 kCodeLengthOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+    static constexpr std::array<u8, kMaxMatch + 1> kLengthCode = [] {
+        std::array<u8, kMaxMatch + 1> table {};
+        for (u32 code = 0; code < 28; ++code) {
+            for (u32 length = kLengthBase[code]; length < kLengthBase[code] + (1u << kLengthExtra[code]); ++length) {
+                table[length] = CAST<u8>(code);
+            }
+        }
+        table[kMaxMatch] = 28;  // 258 has a code of its own rather than being the last value of code 27
+        return table;
+    }();
+
+    static constexpr std::array<u32, 256> kCrcTable = [] {
+        std::array<u32, 256> table {};
+        for (u32 i = 0; i < 256; ++i) {
+            u32 crc = i;
+            for (u32 bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+            }
+            table[i] = crc;
+        }
+        return table;
+    }();
+
+    static u32 GetDistanceCode(u32 distance) {
+        if (distance <= 4) return distance - 1;
+        // Past the first four, every pair of codes covers the next power of two
+        const u32 bits = CAST<u32>(std::bit_width(distance - 1)) - 1;
+        return 2 * bits + (((distance - 1) >> (bits - 1)) & 1);
+    }
+
+    /// @brief Packs codes least significant bit first, the order deflate streams use
+    class BitWriter {
+    public:
+        explicit BitWriter(vector<u8>& out) : mOut(out) {}
+
+        void Put(u32 bits, u32 count) {
+            mBits |= CAST<u64>(bits) << mCount;
+            mCount += count;
+            while (mCount >= 8) {
+                mOut.push_back(CAST<u8>(mBits));
+                mBits >>= 8;
+                mCount -= 8;
+            }
+        }
+
+        void Align() {
+            if (mCount > 0) { Put(0, 8 - mCount); }
+        }
+
+        /// @brief Append whole bytes; only valid right after Align()
+        void PutBytes(const u8* data, size_t size) {
+            mOut.insert(mOut.end(), data, data + size);
+        }
+
+    private:
+        vector<u8>& mOut;
+        u64 mBits {0};
+        u32 mCount {0};
+    };
+
+    /// @brief A literal byte (distance 0) or a back-reference of @p length bytes
+    struct Token {
+        u16 length;
+        u16 distance;
+    };
+
+    /// @brief Huffman code lengths for @p count symbols, none longer than @p maxBits; unused symbols get 0
+    static void BuildLengths(const u32* frequencies, u32 count, u32 maxBits, u8* lengths) {
+        struct Symbol {
+            u32 key;  // Frequency, then parent link, then depth
+            u16 index;
+        };
+        std::array<Symbol, 288> symbols;
+        u32 used = 0;
+        for (u32 i = 0; i < count; ++i) {
+            lengths[i] = 0;
+            if (frequencies[i] > 0) { symbols[used++] = {frequencies[i], CAST<u16>(i)}; }
+        }
+
+        if (used == 0) return;
+        if (used == 1) {
+            // A lone symbol still needs a complete code; pair it with a neighbor that is never sent
+            lengths[symbols[0].index]              = 1;
+            lengths[symbols[0].index == 0 ? 1 : 0] = 1;
+            return;
+        }
+
+        std::sort(symbols.begin(), symbols.begin() + used, [](const Symbol& a, const Symbol& b) {
+            return a.key < b.key;
+        });
+
+        // Moffat and Katajainen's in-place minimum redundancy code: the sorted weights become parent links, then
+        // depths, without building a tree
+        const auto n = CAST<i32>(used);
+        symbols[0].key += symbols[1].key;
+        i32 root = 0, leaf = 2;
+        for (i32 next = 1; next < n - 1; ++next) {
+            if (leaf >= n || symbols[root].key < symbols[leaf].key) {
+                symbols[next].key = symbols[root].key;
+                symbols[root++].key = CAST<u32>(next);
+            } else {
+                symbols[next].key = symbols[leaf++].key;
+            }
+            if (leaf >= n || (root < next && symbols[root].key < symbols[leaf].key)) {
+                symbols[next].key += symbols[root].key;
+                symbols[root++].key = CAST<u32>(next);
+            } else {
+                symbols[next].key += symbols[leaf++].key;
+            }
+        }
+        symbols[n - 2].key = 0;
+        for (i32 next = n - 3; next >= 0; --next) {
+            symbols[next].key = symbols[symbols[next].key].key + 1;
+        }
+        i32 available = 1, assigned = 0, depth = 0, next = n - 1;
+        root = n - 2;
+        while (available > 0) {
+            while (root >= 0 && CAST<i32>(symbols[root].key) == depth) {
+                ++assigned;
+                --root;
+            }
+            while (available > assigned) {
+                symbols[next--].key = CAST<u32>(depth);
+                --available;
+            }
+            available = 2 * assigned;
+            ++depth;
+            assigned = 0;
+        }
+
+        // Frequencies fit in 32 bits, so no code is deeper than the Fibonacci bound of 46
+        std::array<u32, 64> lengthCounts {};
+        for (u32 i = 0; i < used; ++i) {
+            ++lengthCounts[symbols[i].key];
+        }
+
+        // Fold codes past the limit into it, then split shorter codes until the Kraft sum is exact again
+        for (u32 bits = maxBits + 1; bits < lengthCounts.size(); ++bits) {
+            lengthCounts[maxBits] += lengthCounts[bits];
+            lengthCounts[bits] = 0;
+        }
+        u32 kraft = 0;
+        for (u32 bits = 1; bits <= maxBits; ++bits) {
+            kraft += lengthCounts[bits] << (maxBits - bits);
+        }
+        while (kraft > (1u << maxBits)) {
+            --lengthCounts[maxBits];
+            for (u32 bits = maxBits - 1; bits > 0; --bits) {
+                if (lengthCounts[bits] > 0) {
+                    --lengthCounts[bits];
+                    lengthCounts[bits + 1] += 2;
+                    break;
+                }
+            }
+            --kraft;
+        }
+
+        // The most frequent symbols, at the end of the sorted list, take the shortest codes
+        for (u32 bits = 1, remaining = used; bits <= maxBits; ++bits) {
+            for (u32 i = 0; i < lengthCounts[bits]; ++i) {
+                lengths[symbols[--remaining].index] = CAST<u8>(bits);
+            }
+        }
+    }
+
+    /// @brief Canonical codes for @p lengths, bit-reversed so BitWriter emits them most significant bit first
+    static void BuildCodes(const u8* lengths, u32 count, u16* codes) {
+        std::array<u32, 16> lengthCounts {};
+        for (u32 i = 0; i < count; ++i) {
+            ++lengthCounts[lengths[i]];
+        }
+        lengthCounts[0] = 0;
+
+        std::array<u32, 16> nextCode {};
+        for (u32 bits = 1, code = 0; bits < 16; ++bits) {
+            code           = (code + lengthCounts[bits - 1]) << 1;
+            nextCode[bits] = code;
+        }
+
+        for (u32 i = 0; i < count; ++i) {
+            const u32 length = lengths[i];
+            if (length == 0) continue;
+
+            u32 code = nextCode[length]++, reversed = 0;
+            for (u32 bit = 0; bit < length; ++bit) {
+                reversed = (reversed << 1) | (code & 1);
+                code >>= 1;
+            }
+            codes[i] = CAST<u16>(reversed);
+        }
+    }
+
+    static void WriteStored(BitWriter& bits, const u8* data, size_t size, bool final) {
+        do {
+            const auto run  = CAST<u16>(X_MIN(size, CAST<size_t>(0xFFFF)));
+            const bool last = run == size;
+            bits.Put(final && last ? 1 : 0, 1);
+            bits.Put(0, 2);
+            bits.Align();
+            const u8 header[4] = {CAST<u8>(run), CAST<u8>(run >> 8), CAST<u8>(~run), CAST<u8>(~run >> 8)};
+            bits.PutBytes(header, sizeof(header));
+            bits.PutBytes(data, run);
+            data += run;
+            size -= run;
+        } while (size > 0);
+    }
+
+    /// @brief Emit @p tokens, covering @p rawSize input bytes at @p raw, as one dynamic or stored block
+    static void WriteBlock(BitWriter& bits, const vector<Token>& tokens, const u8* raw, size_t rawSize, bool final) {
+        std::array<u32, 286> literalFrequencies {};
+        std::array<u32, 30> distanceFrequencies {};
+        for (const auto& token : tokens) {
+            if (token.distance == 0) {
+                ++literalFrequencies[token.length];
+            } else {
+                ++literalFrequencies[257 + kLengthCode[token.length]];
+                ++distanceFrequencies[GetDistanceCode(token.distance)];
+            }
+        }
+        literalFrequencies[256] = 1;  // End of block
+
+        std::array<u8, 286> literalLengths {};
+        BuildLengths(literalFrequencies.data(), 286, 15, literalLengths.data());
+        u32 literalCount = 286;
+        while (literalCount > 257 && literalLengths[literalCount - 1] == 0) {
+            --literalCount;
+        }
+        std::array<u8, 30> distanceLengths {};
+        BuildLengths(distanceFrequencies.data(), 30, 15, distanceLengths.data());
+        u32 distanceCount = 30;
+        while (distanceCount > 1 && distanceLengths[distanceCount - 1] == 0) {
+            --distanceCount;
+        }
+
+        // Both sets of code lengths are sent as one run-length coded sequence
+        std::array<u8, 286 + 30> lengths {};
+        std::copy_n(literalLengths.begin(), literalCount, lengths.begin());
+        std::copy_n(distanceLengths.begin(), distanceCount, lengths.begin() + literalCount);
+
+        struct RunSymbol {
+            u8 symbol;
+            u8 extra;
+        };
+        vector<RunSymbol> runs;
+        std::array<u32, 19> runFrequencies {};
+        const auto emit = [&](u8 symbol, u8 extra) {
+            runs.push_back({symbol, extra});
+            ++runFrequencies[symbol];
+        };
+        const u32 lengthCount = literalCount + distanceCount;
+        for (u32 i = 0; i < lengthCount;) {
+            const u8 length = lengths[i];
+            u32 run         = 1;
+            while (i + run < lengthCount && lengths[i + run] == length) {
+                ++run;
+            }
+            i += run;
+
+            if (length == 0) {
+                while (run >= 11) {
+                    const u32 repeat = X_MIN(run, 138u);
+                    emit(18, CAST<u8>(repeat - 11));
+                    run -= repeat;
+                }
+                if (run >= 3) {
+                    emit(17, CAST<u8>(run - 3));
+                    run = 0;
+                }
+            } else {
+                emit(length, 0);
+                --run;
+                while (run >= 3) {
+                    const u32 repeat = X_MIN(run, 6u);
+                    emit(16, CAST<u8>(repeat - 3));
+                    run -= repeat;
+                }
+            }
+            for (; run > 0; --run) {
+                emit(length, 0);
+            }
+        }
+
+        std::array<u8, 19> runLengths {};
+        BuildLengths(runFrequencies.data(), 19, 7, runLengths.data());
+        u32 runLengthCount = 19;
+        while (runLengthCount > 4 && runLengths[kCodeLengthOrder[runLengthCount - 1]] == 0) {
+            --runLengthCount;
+        }
+
+        static constexpr u8 kRunExtra[3] = {2, 3, 7};
+        u64 dynamicBits = 3 + 5 + 5 + 4 + 3 * runLengthCount;
+        for (const auto& run : runs) {
+            dynamicBits += runLengths[run.symbol] + (run.symbol >= 16 ? kRunExtra[run.symbol - 16] : 0);
+        }
+        for (u32 i = 0; i < 286; ++i) {
+            dynamicBits += CAST<u64>(literalFrequencies[i]) * literalLengths[i];
+            if (i > 256) { dynamicBits += CAST<u64>(literalFrequencies[i]) * kLengthExtra[i - 257]; }
+        }
+        for (u32 i = 0; i < 30; ++i) {
+            dynamicBits += CAST<u64>(distanceFrequencies[i]) * (distanceLengths[i] + kDistanceExtra[i]);
+        }
+
+        // Noise and already compressed data come out smaller stored as is
+        const u64 storedBits = (rawSize + 5 * ((rawSize + 0xFFFE) / 0xFFFF)) * 8;
+        if (storedBits < dynamicBits) {
+            WriteStored(bits, raw, rawSize, final);
+            return;
+        }
+
+        std::array<u16, 286> literalCodes {};
+        std::array<u16, 30> distanceCodes {};
+        std::array<u16, 19> runCodes {};
+        BuildCodes(literalLengths.data(), 286, literalCodes.data());
+        BuildCodes(distanceLengths.data(), 30, distanceCodes.data());
+        BuildCodes(runLengths.data(), 19, runCodes.data());
+
+        bits.Put(final ? 1 : 0, 1);
+        bits.Put(2, 2);  // Dynamic Huffman
+        bits.Put(literalCount - 257, 5);
+        bits.Put(distanceCount - 1, 5);
+        bits.Put(runLengthCount - 4, 4);
+        for (u32 i = 0; i < runLengthCount; ++i) {
+            bits.Put(runLengths[kCodeLengthOrder[i]], 3);
+        }
+        for (const auto& run : runs) {
+            bits.Put(runCodes[run.symbol], runLengths[run.symbol]);
+            if (run.symbol >= 16) { bits.Put(run.extra, kRunExtra[run.symbol - 16]); }
+        }
+
+        for (const auto& token : tokens) {
+            if (token.distance == 0) {
+                bits.Put(literalCodes[token.length], literalLengths[token.length]);
+                continue;
+            }
+
+            const u32 lengthCode = kLengthCode[token.length];
+            bits.Put(literalCodes[257 + lengthCode], literalLengths[257 + lengthCode]);
+            bits.Put(token.length - kLengthBase[lengthCode], kLengthExtra[lengthCode]);
+
+            const u32 distanceCode = GetDistanceCode(token.distance);
+            bits.Put(distanceCodes[distanceCode], distanceLengths[distanceCode]);
+            bits.Put(token.distance - kDistanceBase[distanceCode], kDistanceExtra[distanceCode]);
+        }
+        bits.Put(literalCodes[256], literalLengths[256]);
+    }
+
+    namespace Deflate {
+        u32 Adler32(u32 adler, const u8* data, size_t size) {
+            // 5552 is the most bytes that can be summed before the 32-bit sums could overflow
+            static constexpr size_t kMaxRun = 5552;
+            u32 a = adler & 0xFFFF, b = adler >> 16;
+            while (size > 0) {
+                const size_t run = X_MIN(size, kMaxRun);
+                for (size_t i = 0; i < run; ++i) {
+                    a += data[i];
+                    b += a;
+                }
+                a %= 65521;
+                b %= 65521;
+                data += run;
+                size -= run;
+            }
+            return (b << 16) | a;
+        }
+
+        u32 CombineAdler32(u32 first, u32 second, u64 secondSize) {
+            static constexpr u32 kBase = 65521;
+            // Appending n bytes adds n * A(first) - n to the second sum, on top of the second range's own sums
+            const auto remainder = CAST<u32>(secondSize % kBase);
+            u32 a                = first & 0xFFFF;
+            u32 b                = CAST<u32>((CAST<u64>(remainder) * a) % kBase);
+            a += (second & 0xFFFF) + kBase - 1;
+            b += (first >> 16) + (second >> 16) + kBase - remainder;
+            if (a >= kBase) { a -= kBase; }
+            if (a >= kBase) { a -= kBase; }
+            if (b >= 2 * kBase) { b -= 2 * kBase; }
+            if (b >= kBase) { b -= kBase; }
+            return (b << 16) | a;
+        }
+
+        u32 Crc32(u32 crc, const u8* data, size_t size) {
+            crc = ~crc;
+            for (size_t i = 0; i < size; ++i) {
+                crc = kCrcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+            }
+            return ~crc;
+        }
+
+        void Compress(const u8* data, size_t size, size_t history, bool final, vector<u8>& out) {
+            history          = X_MIN(history, kWindowSize);
+            const u8* base   = data - history;
+            const size_t end = history + size;
+
+            // Hash chains over 3-byte prefixes; history positions are inserted first so matches can reach them
+            vector<i32> head(1u << kHashBits, -1);
+            vector<i32> previous(end);
+            const auto hash = [base](size_t position) {
+                const u8* p = base + position;
+                return ((CAST<u32>(p[0]) << 16 | CAST<u32>(p[1]) << 8 | p[2]) * 0x9E3779B1u) >> (32 - kHashBits);
+            };
+            const auto insert = [&](size_t position) {
+                const u32 bucket   = hash(position);
+                previous[position] = head[bucket];
+                head[bucket]       = CAST<i32>(position);
+            };
+            for (size_t position = 0; position < history && position + kMinMatch <= end; ++position) {
+                insert(position);
+            }
+
+            BitWriter bits(out);
+            vector<Token> tokens;
+            tokens.reserve(kBlockTokens);
+            size_t blockStart = history;
+            size_t position   = history;
+            while (position < end) {
+                u32 bestLength = 0, bestDistance = 0;
+                if (position + kMinMatch <= end) {
+                    const auto maxLength = CAST<u32>(X_MIN(CAST<size_t>(kMaxMatch), end - position));
+                    const u8* current    = base + position;
+                    i32 candidate        = head[hash(position)];
+                    for (u32 chain = 0; candidate >= 0 && chain < kMaxChain; ++chain) {
+                        const size_t distance = position - candidate;
+                        if (distance > kWindowSize) break;
+
+                        // Checking the byte that would make the match longer first skips most candidates cheaply
+                        const u8* earlier = base + candidate;
+                        if (earlier[bestLength] == current[bestLength]) {
+                            u32 length = 0;
+                            while (length < maxLength && earlier[length] == current[length]) {
+                                ++length;
+                            }
+                            if (length > bestLength) {
+                                bestLength   = length;
+                                bestDistance = CAST<u32>(distance);
+                                if (length >= maxLength || length >= kNiceMatch) break;
+                            }
+                        }
+                        candidate = previous[candidate];
+                    }
+                    insert(position);
+                }
+
+                if (bestLength >= kMinMatch) {
+                    tokens.push_back({CAST<u16>(bestLength), CAST<u16>(bestDistance)});
+                    for (size_t skipped = position + 1; skipped < position + bestLength; ++skipped) {
+                        if (skipped + kMinMatch <= end) { insert(skipped); }
+                    }
+                    position += bestLength;
+                } else {
+                    tokens.push_back({base[position], 0});
+                    ++position;
+                }
+
+                if (tokens.size() == kBlockTokens) {
+                    WriteBlock(bits, tokens, base + blockStart, position - blockStart, final && position == end);
+                    tokens.clear();
+                    blockStart = position;
+                }
+            }
+
+            if (!tokens.empty()) {
+                WriteBlock(bits, tokens, base + blockStart, position - blockStart, final);
+            } else if (size == 0 && final) {
+                WriteStored(bits, nullptr, 0, true);
+            }
+
+            // Sync flush: an empty stored block ends the chunk on a byte boundary without ending the stream
+            if (!final) { WriteStored(bits, nullptr, 0, false); }
+            bits.Align();
+        }
+    }  // namespace Deflate
+}  // namespace X
@@ -0,0 +1,31 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+
+namespace X {
+    namespace Deflate {
+        /// @brief Continue the Adler-32 checksum @p adler (1 for a new stream) over @p data
+        X_ND u32 Adler32(u32 adler, const u8* data, size_t size);
+
+        /// @brief Adler-32 of two concatenated ranges from the checksum of each and the size of the second
+        X_ND u32 CombineAdler32(u32 first, u32 second, u64 secondSize);
+
+        /// @brief Continue the CRC-32 used by PNG and gzip, @p crc (0 for a new checksum) over @p data
+        X_ND u32 Crc32(u32 crc, const u8* data, size_t size);
+
+        /**
+         * @brief Compress @p size bytes at @p data into raw deflate blocks appended to @p out.
+         *
+         * Matches may reach into the @p history bytes just before @p data (at most the 32 KiB window is used),
+         * which must be the bytes the preceding part of the stream was compressed from. A stream split into chunks
+         * can therefore compress each chunk independently, in parallel, and still match across chunk boundaries.
+         * Unless @p final, the output ends in an empty stored block so it stays byte-aligned and the next chunk's
+         * output can simply be appended.
+         */
+        void Compress(const u8* data, size_t size, size_t history, bool final, vector<u8>& out);
+    }  // namespace Deflate
+}  // namespace X
@@ -0,0 +1,416 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "FrameCapture.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+    #include <fcntl.h>
+    #include <io.h>
+    #include <sys/stat.h>
+#else
+    #include <fcntl.h>
+    #include <pthread.h>
+    #include <signal.h>
+    #include <unistd.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #define X_CAPTURE_AVX2
+    #include <immintrin.h>
+#endif
+
+namespace X {
+    // YUV 4:2:0 conversion, BT.601 limited range in the integer form ffmpeg and most encoders use. Chroma is the
+    // average over a 2x2 block; an odd last column or row pairs with itself. The SIMD kernels compute exactly the
+    // same integers as the scalar one, so output doesn't depend on the CPU.
+
+    static u8 Luma(const u8* p) {
+        return CAST<u8>(((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) >> 8) + 16);
+    }
+
+    static i32 ChromaU(const u8* p) {
+        return -38 * p[0] - 74 * p[1] + 112 * p[2];
+    }
+
+    static i32 ChromaV(const u8* p) {
+        return 112 * p[0] - 94 * p[1] - 18 * p[2];
+    }
+
+    static u8 ChromaSum(i32 sum) {
+        return CAST<u8>(((sum + 512) >> 10) + 128);
+    }
+
+    /// Pixels [begin, width) of a row pair; @p luma1 is null when the last row of an odd height pairs with itself
+    static void ConvertPairScalar(
+      const u8* row0, const u8* row1, u32 begin, u32 width, u8* luma0, u8* luma1, u8* u, u8* v) {
+        for (u32 x = begin; x < width; x += 2) {
+            const u32 next = X_MIN(x + 1, width - 1);
+            const u8* a    = row0 + CAST<size_t>(x) * 4;
+            const u8* b    = row0 + CAST<size_t>(next) * 4;
+            const u8* c    = row1 + CAST<size_t>(x) * 4;
+            const u8* d    = row1 + CAST<size_t>(next) * 4;
+            luma0[x]       = Luma(a);
+            luma0[next]    = Luma(b);
+            if (luma1) {
+                luma1[x]    = Luma(c);
+                luma1[next] = Luma(d);
+            }
+            u[x / 2] = ChromaSum(ChromaU(a) + ChromaU(b) + ChromaU(c) + ChromaU(d));
+            v[x / 2] = ChromaSum(ChromaV(a) + ChromaV(b) + ChromaV(c) + ChromaV(d));
+        }
+    }
+
+    /// Converts the first count - count % 8 pixels of a full row pair, returns how many that was
+    using PairKernel = u32 (*)(const u8* row0, const u8* row1, u32 count, u8* luma0, u8* luma1, u8* u, u8* v);
+
+    static u32 ConvertPairNone(const u8*, const u8*, u32, u8*, u8*, u8*, u8*) {
+        return 0;
+    }
+
+#if defined(X_CAPTURE_AVX2)
+    // Pixels are widened to 16 bits so madd forms two partial dot products per pixel; hadd of the low and high
+    // unpacked halves then leaves one sum per pixel in order, p0..p3 in the low lane and p4..p7 in the high one
+
+    __attribute__((target("avx2"))) static __m256i DotAvx2(__m256i low, __m256i high, __m256i coefficients) {
+        return _mm256_hadd_epi32(_mm256_madd_epi16(low, coefficients), _mm256_madd_epi16(high, coefficients));
+    }
+
+    /// Saturate eight i32 to bytes and store them in order
+    __attribute__((target("avx2"))) static void Store8Avx2(u8* out, __m256i values) {
+        const __m256i words = _mm256_packus_epi32(values, values);
+        const __m256i bytes = _mm256_packus_epi16(words, words);
+        const u32 low       = CAST<u32>(_mm256_cvtsi256_si32(bytes));
+        const u32 high      = CAST<u32>(_mm256_extract_epi32(bytes, 4));
+        std::memcpy(out, &low, 4);
+        std::memcpy(out + 4, &high, 4);
+    }
+
+    __attribute__((target("avx2"))) static __m256i LumaAvx2(__m256i low, __m256i high) {
+        const __m256i coefficients = _mm256_setr_epi16(66, 129, 25, 0, 66, 129, 25, 0, 66, 129, 25, 0, 66, 129, 25, 0);
+        const __m256i sum          = DotAvx2(low, high, coefficients);
+        return _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(sum, _mm256_set1_epi32(128)), 8),
+                                _mm256_set1_epi32(16));
+    }
+
+    __attribute__((target("avx2"))) static u32
+    ConvertPairAvx2(const u8* row0, const u8* row1, u32 count, u8* luma0, u8* luma1, u8* u, u8* v) {
+        const __m256i zero     = _mm256_setzero_si256();
+        const __m256i uCoeffs =
+          _mm256_setr_epi16(-38, -74, 112, 0, -38, -74, 112, 0, -38, -74, 112, 0, -38, -74, 112, 0);
+        const __m256i vCoeffs =
+          _mm256_setr_epi16(112, -94, -18, 0, 112, -94, -18, 0, 112, -94, -18, 0, 112, -94, -18, 0);
+        const __m256i rounding = _mm256_set1_epi32(512);
+        const __m256i offset   = _mm256_set1_epi32(128);
+        const __m256i order    = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+
+        u32 x = 0;
+        for (; x + 8 <= count; x += 8) {
+            const __m256i top        = _mm256_loadu_si256(RCAST<const __m256i*>(row0 + CAST<size_t>(x) * 4));
+            const __m256i bottom     = _mm256_loadu_si256(RCAST<const __m256i*>(row1 + CAST<size_t>(x) * 4));
+            const __m256i topLow     = _mm256_unpacklo_epi8(top, zero);  // p0 p1 | p4 p5
+            const __m256i topHigh    = _mm256_unpackhi_epi8(top, zero);  // p2 p3 | p6 p7
+            const __m256i bottomLow  = _mm256_unpacklo_epi8(bottom, zero);
+            const __m256i bottomHigh = _mm256_unpackhi_epi8(bottom, zero);
+            Store8Avx2(luma0 + x, LumaAvx2(topLow, topHigh));
+            Store8Avx2(luma1 + x, LumaAvx2(bottomLow, bottomHigh));
+
+            // Vertical pair sums stay below 512, so they still fit madd's signed 16-bit inputs
+            const __m256i low  = _mm256_add_epi16(topLow, bottomLow);
+            const __m256i high = _mm256_add_epi16(topHigh, bottomHigh);
+            // Per lane: u of pixel pairs 0-1, 2-3, then v of the same pairs
+            const __m256i sums   = _mm256_hadd_epi32(DotAvx2(low, high, uCoeffs), DotAvx2(low, high, vCoeffs));
+            const __m256i chroma = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(sums, rounding), 10), offset);
+            u8 bytes[8];
+            Store8Avx2(bytes, _mm256_permutevar8x32_epi32(chroma, order));  // u0..u3 v0..v3
+            std::memcpy(u + x / 2, bytes, 4);
+            std::memcpy(v + x / 2, bytes + 4, 4);
+        }
+        return x;
+    }
+#endif
+
+    static PairKernel SelectPairKernel() {
+#if defined(X_CAPTURE_AVX2)
+        __builtin_cpu_init();  // Runs from a static initializer, possibly before libgcc's own
+        if (__builtin_cpu_supports("avx2")) { return ConvertPairAvx2; }
+#endif
+        return ConvertPairNone;
+    }
+
+    static const PairKernel kPairKernel = SelectPairKernel();
+
+    void FrameCapture::ConvertToYUV420(const Image& frame, u8* out) {
+        const u32 width        = frame.GetWidth();
+        const u32 height       = frame.GetHeight();
+        const u32 chromaWidth  = (width + 1) / 2;
+        const u32 chromaHeight = (height + 1) / 2;
+        u8* luma               = out;
+        u8* u                  = luma + CAST<size_t>(width) * height;
+        u8* v                  = u + CAST<size_t>(chromaWidth) * chromaHeight;
+
+        for (u32 y = 0; y < height; y += 2) {
+            const u8* row0 = frame.GetRow(y);
+            u8* luma0      = luma + CAST<size_t>(y) * width;
+            u8* uRow       = u + CAST<size_t>(y / 2) * chromaWidth;
+            u8* vRow       = v + CAST<size_t>(y / 2) * chromaWidth;
+            if (y + 1 < height) {
+                const u8* row1  = frame.GetRow(y + 1);
+                u8* luma1       = luma0 + width;
+                const u32 begin = kPairKernel(row0, row1, width, luma0, luma1, uRow, vRow);
+                ConvertPairScalar(row0, row1, begin, width, luma0, luma1, uRow, vRow);
+            } else {
+                ConvertPairScalar(row0, row0, 0, width, luma0, nullptr, uRow, vRow);
+            }
+        }
+    }
+
+    size_t FrameCapture::GetFrameSize(CaptureFormat format, u32 width, u32 height) {
+        if (format == CaptureFormat::RGBA) { return CAST<size_t>(width) * height * 4; }
+        return CAST<size_t>(width) * height + 2 * (CAST<size_t>(width + 1) / 2) * ((height + 1) / 2);
+    }
+
+    FrameCapture::FrameCapture(CaptureFormat format, u32 bufferCount)
+        : mFormat(format), mBuffers(X_MAX(bufferCount, 1u)) {}
+
+    FrameCapture::~FrameCapture() {
+        Close();
+    }
+
+    bool FrameCapture::Open(i32 fd, bool closeWhenDone) {
+        return Start(fd, closeWhenDone, nullptr);
+    }
+
+    bool FrameCapture::OpenFile(const string& path) {
+#if defined(_WIN32)
+        const i32 fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        // A named pipe blocks here until its reader opens it
+        const i32 fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+        if (fd < 0) {
+            std::cerr << "Failed to open " << path << " for frame capture: " << std::strerror(errno) << '\n';
+            return false;
+        }
+        return Start(fd, true, nullptr);
+    }
+
+    bool FrameCapture::OpenProcess(const string& command) {
+#if defined(_WIN32)
+        FILE* process = _popen(command.c_str(), "wb");
+#else
+        FILE* process = popen(command.c_str(), "w");
+#endif
+        if (!process) {
+            std::cerr << "Failed to start '" << command << "' for frame capture: " << std::strerror(errno) << '\n';
+            return false;
+        }
+#if defined(_WIN32)
+        return Start(_fileno(process), false, process);
+#else
+        return Start(fileno(process), false, process);
+#endif
+    }
+
+    bool FrameCapture::Start(i32 fd, bool closeWhenDone, FILE* process) {
+        Close();
+
+        mFd           = fd;
+        mCloseFd      = closeWhenDone;
+        mProcess      = process;
+        mWidth        = 0;
+        mHeight       = 0;
+        mStopping     = false;
+        mFailed       = false;
+        mReportedSize = false;
+        mFreeBuffers.clear();
+        for (u32 i = 0; i < mBuffers.size(); ++i) {
+            mFreeBuffers.push_back(i);
+        }
+        mThread = std::thread(&FrameCapture::ThreadMain, this);
+        return true;
+    }
+
+    void FrameCapture::Close() {
+        if (!mThread.joinable()) return;
+
+        {
+            std::lock_guard lock(mMutex);
+            mStopping = true;
+        }
+        mChanged.notify_all();
+        // The thread writes out everything queued before it exits
+        mThread.join();
+
+        if (mProcess) {
+#if defined(_WIN32)
+            const i32 status = _pclose(mProcess);
+#else
+            const i32 status = pclose(mProcess);
+#endif
+            if (status != 0) { std::cerr << "Frame capture process exited with status " << status << '\n'; }
+        } else if (mCloseFd) {
+#if defined(_WIN32)
+            _close(mFd);
+#else
+            close(mFd);
+#endif
+        }
+        mFd      = -1;
+        mProcess = nullptr;
+    }
+
+    bool FrameCapture::Submit(const Image& frame) {
+        mSubmitted.fetch_add(1, std::memory_order_relaxed);
+        if (!IsOpen() || frame.IsEmpty()) {
+            Drop();
+            return false;
+        }
+
+        if (mWidth == 0) {
+            mWidth  = frame.GetWidth();
+            mHeight = frame.GetHeight();
+        } else if (frame.GetWidth() != mWidth || frame.GetHeight() != mHeight) {
+            // A raw stream has no way to announce a new size to its reader
+            if (!mReportedSize) {
+                mReportedSize = true;
+                std::cerr << "Frame capture: dropping " << frame.GetWidth() << "x" << frame.GetHeight()
+                          << " frames, the stream is " << mWidth << "x" << mHeight << '\n';
+            }
+            Drop();
+            return false;
+        }
+
+        u32 index;
+        {
+            std::unique_lock lock(mMutex);
+            if (mFreeBuffers.empty() && !mFailed) {
+                if (!mBlockWhenFull) {
+                    Drop();
+                    return false;
+                }
+                const auto start = std::chrono::steady_clock::now();
+                mChanged.wait(lock, [this] { return !mFreeBuffers.empty() || mFailed; });
+                const auto elapsed = std::chrono::steady_clock::now() - start;
+                mBlocked.fetch_add(1, std::memory_order_relaxed);
+                mBlockedNanoseconds.fetch_add(
+                  CAST<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+                  std::memory_order_relaxed);
+            }
+            if (mFailed) {
+                Drop();
+                return false;
+            }
+            index = mFreeBuffers.back();
+            mFreeBuffers.pop_back();
+        }
+
+        // Free buffers belong to the submitting thread, so the copy needs no lock
+        Image& buffer = mBuffers[index];
+        buffer.Resize(mWidth, mHeight);
+        std::memcpy(buffer.GetPixels(), frame.GetPixels(), frame.GetStride() * frame.GetHeight());
+
+        {
+            std::lock_guard lock(mMutex);
+            mReadyBuffers.push_back(index);
+        }
+        mChanged.notify_all();
+        return true;
+    }
+
+    FrameCapture::Stats FrameCapture::GetStats() const {
+        Stats stats;
+        stats.submitted    = mSubmitted.load(std::memory_order_relaxed);
+        stats.written      = mWritten.load(std::memory_order_relaxed);
+        stats.dropped      = mDropped.load(std::memory_order_relaxed);
+        stats.blocked      = mBlocked.load(std::memory_order_relaxed);
+        stats.blockedTime  = CAST<f64>(mBlockedNanoseconds.load(std::memory_order_relaxed)) * 1e-9;
+        stats.bytesWritten = mBytesWritten.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    string FrameCapture::GetFFmpegInputArgs(u32 width, u32 height, f64 fps) const {
+        char args[128];
+        std::snprintf(args,
+                      sizeof(args),
+                      "-f rawvideo -pix_fmt %s -video_size %ux%u -framerate %g -i -",
+                      mFormat == CaptureFormat::RGBA ? "rgba" : "yuv420p",
+                      width,
+                      height,
+                      fps);
+        return args;
+    }
+
+    void FrameCapture::Drop() {
+        mDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool FrameCapture::WriteAll(const u8* data, size_t size) {
+        while (size > 0) {
+#if defined(_WIN32)
+            const auto count = _write(mFd, data, CAST<u32>(X_MIN(size, size_t {1} << 30)));
+#else
+            const auto count = write(mFd, data, size);
+#endif
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "Frame capture stopped: " << std::strerror(errno) << '\n';
+                return false;
+            }
+            data += count;
+            size -= CAST<size_t>(count);
+            mBytesWritten.fetch_add(CAST<u64>(count), std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    void FrameCapture::ThreadMain() {
+#if !defined(_WIN32)
+        // An encoder that exits closes the pipe; that should fail the write with EPIPE, not kill the application
+        sigset_t pipeSignal;
+        sigemptyset(&pipeSignal);
+        sigaddset(&pipeSignal, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &pipeSignal, nullptr);
+#endif
+
+        vector<u8> converted;
+        std::unique_lock lock(mMutex);
+        while (true) {
+            mChanged.wait(lock, [this] { return !mReadyBuffers.empty() || mStopping; });
+            if (mReadyBuffers.empty()) return;
+
+            // Only this thread pops, so the front buffer stays put while the lock is released
+            const Image& frame = mBuffers[mReadyBuffers.front()];
+            lock.unlock();
+            bool written;
+            if (mFormat == CaptureFormat::YUV420) {
+                converted.resize(GetFrameSize(mFormat, frame.GetWidth(), frame.GetHeight()));
+                ConvertToYUV420(frame, converted.data());
+                written = WriteAll(converted.data(), converted.size());
+            } else {
+                written = WriteAll(frame.GetPixels(), frame.GetStride() * frame.GetHeight());
+            }
+            lock.lock();
+
+            mFreeBuffers.push_back(mReadyBuffers.front());
+            mReadyBuffers.pop_front();
+            if (written) {
+                mWritten.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                // The stream is gone; whatever is still queued can't be written either
+                mFailed = true;
+                mDropped.fetch_add(1 + mReadyBuffers.size(), std::memory_order_relaxed);
+                mFreeBuffers.insert(mFreeBuffers.end(), mReadyBuffers.begin(), mReadyBuffers.end());
+                mReadyBuffers.clear();
+                mChanged.notify_all();
+                return;
+            }
+            mChanged.notify_all();
+        }
+    }
+}  // namespace X
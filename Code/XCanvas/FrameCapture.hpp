@@ -0,0 +1,121 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+#include "Image.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace X {
+    enum class CaptureFormat : u8 {
+        RGBA,    ///< Top-down RGBA8 as rendered, ffmpeg's "rgba"
+        YUV420,  ///< Planar 4:2:0 with BT.601 limited-range coefficients, ffmpeg's "yuv420p"
+    };
+
+    /**
+     * @brief Streams frames as raw video into a pipe, file or file descriptor for an external encoder like ffmpeg.
+     *
+     * Submit() copies a frame into one of a fixed set of buffers and returns. A writer thread converts each frame
+     * (YUV420 uses AVX2 where the CPU has it) and writes it, so the stream is a plain sequence of frames with no
+     * headers or padding; GetFFmpegInputArgs() describes it to ffmpeg. The first frame fixes the size and frames of
+     * any other size are dropped.
+     *
+     * When every buffer still waits for the writer, the consumer isn't keeping up. Submit() then drops the frame,
+     * or with SetBlockWhenFull() waits for a buffer and stalls its caller instead. Either way it is counted.
+     */
+    class FrameCapture {
+    public:
+        struct Stats {
+            u64 submitted {0};      // Frames passed to Submit()
+            u64 written {0};        // Frames fully written to the stream
+            u64 dropped {0};        // Frames discarded: buffers full, wrong size or the stream failed
+            u64 blocked {0};        // Submit() calls that waited for a buffer
+            f64 blockedTime {0.0};  // Seconds spent in those waits
+            u64 bytesWritten {0};
+        };
+
+        explicit FrameCapture(CaptureFormat format = CaptureFormat::YUV420, u32 bufferCount = 4);
+        ~FrameCapture();
+
+        FrameCapture(const FrameCapture&)            = delete;
+        FrameCapture& operator=(const FrameCapture&) = delete;
+
+        /// @brief Stream into @p fd, an open pipe, file or socket, which Close() closes only if @p closeWhenDone
+        bool Open(i32 fd, bool closeWhenDone = false);
+
+        /// @brief Create or truncate @p path, which may also be a named pipe, and stream into it
+        bool OpenFile(const string& path);
+
+        /// @brief Run @p command through the shell and stream into its standard input
+        bool OpenProcess(const string& command);
+
+        /// @brief Write every queued frame, then close the stream; for a process, wait for it to exit
+        void Close();
+
+        /// @brief Stall Submit() until a buffer frees up rather than dropping the frame (off by default)
+        void SetBlockWhenFull(bool block) {
+            mBlockWhenFull = block;
+        }
+
+        /// @brief Queue a copy of @p frame. Returns false if it was dropped. Call from one thread at a time.
+        bool Submit(const Image& frame);
+
+        X_ND bool IsOpen() const {
+            return mThread.joinable();
+        }
+
+        X_ND CaptureFormat GetFormat() const {
+            return mFormat;
+        }
+
+        X_ND Stats GetStats() const;
+
+        /// @brief ffmpeg options reading this stream from stdin, to go before the output options of OpenProcess()
+        X_ND string GetFFmpegInputArgs(u32 width, u32 height, f64 fps) const;
+
+        /// @brief Bytes one frame takes in @p format
+        X_ND static size_t GetFrameSize(CaptureFormat format, u32 width, u32 height);
+
+        /// @brief Write @p frame to @p out as a Y plane followed by quarter-size U and V planes (odd sizes round up)
+        static void ConvertToYUV420(const Image& frame, u8* out);
+
+    private:
+        bool Start(i32 fd, bool closeWhenDone, FILE* process);
+        void Drop();
+        void ThreadMain();
+        bool WriteAll(const u8* data, size_t size);
+
+        CaptureFormat mFormat;
+        bool mBlockWhenFull {false};
+        i32 mFd {-1};
+        bool mCloseFd {false};
+        FILE* mProcess {nullptr};
+        u32 mWidth {0};
+        u32 mHeight {0};
+
+        std::mutex mMutex;
+        std::condition_variable mChanged;
+        vector<Image> mBuffers;
+        vector<u32> mFreeBuffers;
+        std::deque<u32> mReadyBuffers;  // Oldest first; the front is being written
+        bool mStopping {false};
+        bool mFailed {false};
+        bool mReportedSize {false};
+        std::thread mThread;
+
+        std::atomic<u64> mSubmitted {0};
+        std::atomic<u64> mWritten {0};
+        std::atomic<u64> mDropped {0};
+        std::atomic<u64> mBlocked {0};
+        std::atomic<u64> mBlockedNanoseconds {0};
+        std::atomic<u64> mBytesWritten {0};
+    };
+}  // namespace X
@@ -0,0 +1,80 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "FramePacer.hpp"
+#include "Clock.hpp"
+
+#include <cmath>
+#include <thread>
+
+namespace X {
+    void FramePacer::SetMode(PacingMode mode, f64 targetFps) {
+        mMode           = mode;
+        mFrameInterval  = targetFps > 0.0 ? 1.0 / targetFps : 0.0;
+        mNextFrameStart = 0.0;
+    }
+
+    void FramePacer::WaitForFrameStart() {
+        switch (mMode) {
+            case PacingMode::Uncapped:
+            case PacingMode::VSync:
+                return;
+
+            case PacingMode::FrameCap: {
+                if (mFrameInterval <= 0.0) return;
+
+                const f64 now = Clock::Now();
+                if (mNextFrameStart <= 0.0 || now - mNextFrameStart > mFrameInterval) {
+                    // First frame or we fell more than a frame behind; restart the schedule rather than burst
+                    mNextFrameStart = now;
+                }
+                SleepUntil(mNextFrameStart);
+                mNextFrameStart += mFrameInterval;
+            } break;
+
+            case PacingMode::LateStart: {
+                const f64 deadline = mLateStartDeadline.load(std::memory_order_relaxed);
+                if (deadline > Clock::Now()) { SleepUntil(deadline); }
+            } break;
+        }
+    }
+
+    void FramePacer::EndFrame(f64 workTime, f64 presentTime) {
+        // Exponential moving average of work time and its deviation
+        static constexpr f64 kSmoothing = 0.1;
+        if (mWorkEstimate <= 0.0) {
+            mWorkEstimate = workTime;
+        } else {
+            const f64 error = workTime - mWorkEstimate;
+            mWorkEstimate += kSmoothing * error;
+            mWorkDeviation += kSmoothing * (std::fabs(error) - mWorkDeviation);
+        }
+
+        // Swap returns right after a vblank, so the next one is a refresh interval later. Start the next frame early
+        // enough for a pessimistic estimate of its work to finish before then.
+        const f64 budget = mWorkEstimate + 2.0 * mWorkDeviation + mSafetyMargin;
+        mLateStartDeadline.store(presentTime + mRefreshInterval - budget, std::memory_order_relaxed);
+    }
+
+    void FramePacer::SleepUntil(f64 deadline) {
+        // Coarse sleep for all but the expected oversleep, then spin out the remainder
+        static constexpr f64 kMinSpin = 0.0002;
+        while (true) {
+            const f64 now       = Clock::Now();
+            const f64 remaining = deadline - now;
+            if (remaining <= mOversleep + kMinSpin) break;
+
+            const f64 request = remaining - mOversleep - kMinSpin;
+            std::this_thread::sleep_for(std::chrono::duration<f64>(request));
+
+            // Track the worst recent oversleep, decaying slowly so a single hiccup doesn't pin the spin window
+            const f64 overshoot = (Clock::Now() - now) - request;
+            mOversleep          = X_MAX(overshoot, mOversleep * 0.95);
+        }
+
+        while (Clock::Now() < deadline) {
+            std::this_thread::yield();
+        }
+    }
+}  // namespace X
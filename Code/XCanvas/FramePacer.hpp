@@ -0,0 +1,72 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+
+#include <atomic>
+
+namespace X {
+    enum class PacingMode {
+        Uncapped,  ///< No vsync, no limiter; frames run back to back
+        VSync,     ///< Swap interval of 1, the driver blocks in the swap
+        FrameCap,  ///< No vsync, a sleep-plus-spin limiter holds frames to the target rate
+        LateStart, ///< VSync, but the frame starts as late as possible so input is sampled just before the swap
+    };
+
+    /**
+     * @brief Decides when Application::Run() starts each frame.
+     *
+     * WaitForFrameStart() is called before input is polled and OnUpdate() runs, EndFrame() right after the swap.
+     * Sleeps are done with a coarse OS sleep followed by a short spin, with the spin window sized from observed
+     * oversleep so the limiter stays accurate on platforms with coarse timers.
+     *
+     * EndFrame() may be called from the thread that presents while WaitForFrameStart() runs on the main thread; the
+     * only state they share is the LateStart deadline, which EndFrame() publishes atomically.
+     */
+    class FramePacer {
+    public:
+        void SetMode(PacingMode mode, f64 targetFps);
+
+        /// @brief Used by LateStart to predict the next vblank
+        void SetRefreshInterval(f64 interval) {
+            mRefreshInterval = interval;
+        }
+
+        /// @brief Extra time LateStart reserves on top of the predicted frame work (default 1 ms)
+        void SetSafetyMargin(f64 seconds) {
+            mSafetyMargin = seconds;
+        }
+
+        X_ND PacingMode GetMode() const {
+            return mMode;
+        }
+
+        /// @brief Swap interval the mode requires
+        X_ND i32 GetSwapInterval() const {
+            return mMode == PacingMode::VSync || mMode == PacingMode::LateStart ? 1 : 0;
+        }
+
+        void WaitForFrameStart();
+        void EndFrame(f64 workTime, f64 presentTime);
+
+        /// @brief Sleep until @p deadline (Clock::Now() time) with sub-millisecond accuracy
+        void SleepUntil(f64 deadline);
+
+    private:
+        PacingMode mMode {PacingMode::VSync};
+        f64 mFrameInterval {0.0};
+        f64 mRefreshInterval {1.0 / 60.0};
+        f64 mSafetyMargin {0.001};
+
+        f64 mNextFrameStart {0.0};
+        f64 mOversleep {0.001};
+
+        // Owned by the presenting thread
+        f64 mWorkEstimate {0.0};
+        f64 mWorkDeviation {0.0};
+        std::atomic<f64> mLateStartDeadline {0.0};
+    };
+}  // namespace X
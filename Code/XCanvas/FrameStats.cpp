@@ -0,0 +1,65 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "FrameStats.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace X {
+    Histogram::Histogram(f64 bucketWidth, u32 bucketCount) : mBucketWidth(bucketWidth), mBuckets(bucketCount, 0) {}
+
+    void Histogram::Add(f64 value) {
+        const f64 index = std::floor(value / mBucketWidth);
+        const auto last = CAST<f64>(mBuckets.size() - 1);
+        ++mBuckets[CAST<size_t>(std::clamp(index, 0.0, last))];
+
+        mMin = mCount == 0 ? value : X_MIN(mMin, value);
+        mMax = mCount == 0 ? value : X_MAX(mMax, value);
+        mSum += value;
+        ++mCount;
+    }
+
+    void Histogram::Reset() {
+        std::fill(mBuckets.begin(), mBuckets.end(), 0);
+        mCount = 0;
+        mSum   = 0.0;
+        mMin   = 0.0;
+        mMax   = 0.0;
+    }
+
+    f64 Histogram::GetPercentile(f64 percentile) const {
+        if (mCount == 0) return 0.0;
+
+        const auto target = CAST<u64>(std::ceil(std::clamp(percentile, 0.0, 1.0) * CAST<f64>(mCount)));
+        u64 seen          = 0;
+        for (size_t i = 0; i < mBuckets.size(); ++i) {
+            seen += mBuckets[i];
+            if (seen >= target && seen > 0) return CAST<f64>(i + 1) * mBucketWidth;
+        }
+
+        return mMax;
+    }
+
+    // Frame and work times in 0.25 ms buckets up to 250 ms, input latencies in 0.5 ms buckets up to 500 ms
+    FrameStats::FrameStats()
+        : mFrameTimes(0.00025, 1000), mWorkTimes(0.00025, 1000), mInputLatencies(0.0005, 1000) {}
+
+    void FrameStats::AddFrame(f64 frameTime, f64 workTime) {
+        mFrameTimes.Add(frameTime);
+        mWorkTimes.Add(workTime);
+        mLastFrameTime = frameTime;
+    }
+
+    void FrameStats::AddInputLatency(f64 latency) {
+        mInputLatencies.Add(latency);
+    }
+
+    void FrameStats::Reset() {
+        mFrameTimes.Reset();
+        mWorkTimes.Reset();
+        mInputLatencies.Reset();
+        mLastFrameTime = 0.0;
+    }
+}  // namespace X
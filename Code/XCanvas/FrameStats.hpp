@@ -0,0 +1,97 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+
+namespace X {
+    /// @brief Fixed-width bucket histogram. Samples past the last bucket are clamped into it.
+    class Histogram {
+    public:
+        Histogram(f64 bucketWidth, u32 bucketCount);
+
+        void Add(f64 value);
+        void Reset();
+
+        /// @brief Upper edge of the bucket holding the @p percentile (0-1) sample, 0 if empty
+        X_ND f64 GetPercentile(f64 percentile) const;
+
+        X_ND f64 GetMean() const {
+            return mCount > 0 ? mSum / CAST<f64>(mCount) : 0.0;
+        }
+
+        X_ND f64 GetMin() const {
+            return mCount > 0 ? mMin : 0.0;
+        }
+
+        X_ND f64 GetMax() const {
+            return mMax;
+        }
+
+        X_ND u64 GetCount() const {
+            return mCount;
+        }
+
+        X_ND f64 GetBucketWidth() const {
+            return mBucketWidth;
+        }
+
+        X_ND const vector<u64>& GetBuckets() const {
+            return mBuckets;
+        }
+
+    private:
+        f64 mBucketWidth;
+        vector<u64> mBuckets;
+        u64 mCount {0};
+        f64 mSum {0.0};
+        f64 mMin {0.0};
+        f64 mMax {0.0};
+    };
+
+    /**
+     * @brief Per-frame timing collected by Application::Run().
+     *
+     * Frame time is the interval between consecutive presents, work time is the CPU time from the start of
+     * OnUpdate() until the frame was handed to Present(). Input latency runs from an input event's arrival to the
+     * moment the GPU finished the first presented frame reflecting it; display scanout comes on top of that. All
+     * values are in seconds.
+     */
+    class FrameStats {
+    public:
+        FrameStats();
+
+        void AddFrame(f64 frameTime, f64 workTime);
+        void AddInputLatency(f64 latency);
+        void Reset();
+
+        X_ND const Histogram& GetFrameTimes() const {
+            return mFrameTimes;
+        }
+
+        X_ND const Histogram& GetWorkTimes() const {
+            return mWorkTimes;
+        }
+
+        X_ND const Histogram& GetInputLatencies() const {
+            return mInputLatencies;
+        }
+
+        X_ND f64 GetLastFrameTime() const {
+            return mLastFrameTime;
+        }
+
+        X_ND f64 GetAverageFps() const {
+            const f64 mean = mFrameTimes.GetMean();
+            return mean > 0.0 ? 1.0 / mean : 0.0;
+        }
+
+    private:
+        Histogram mFrameTimes;
+        Histogram mWorkTimes;
+        Histogram mInputLatencies;
+        f64 mLastFrameTime {0.0};
+    };
+}  // namespace X
@@ -0,0 +1,55 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "Image.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace X {
+    Image::Image(u32 width, u32 height) {
+        Resize(width, height);
+    }
+
+    void Image::Resize(u32 width, u32 height) {
+        mWidth  = width;
+        mHeight = height;
+        mPixels.resize(GetStride() * height);
+    }
+
+    void Image::FlipVertically() {
+        for (u32 top = 0, bottom = mHeight > 0 ? mHeight - 1 : 0; top < bottom; ++top, --bottom) {
+            std::swap_ranges(GetRow(top), GetRow(top) + GetStride(), GetRow(bottom));
+        }
+    }
+
+    bool Image::WritePPM(const string& path) const {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            std::cerr << "Failed to open " << path << " for writing\n";
+            return false;
+        }
+
+        file << "P6\n" << mWidth << " " << mHeight << "\n255\n";
+
+        vector<u8> row(CAST<size_t>(mWidth) * 3);
+        for (u32 y = 0; y < mHeight; ++y) {
+            const u8* source = GetRow(y);
+            for (u32 x = 0; x < mWidth; ++x) {
+                row[x * 3 + 0] = source[x * 4 + 0];
+                row[x * 3 + 1] = source[x * 4 + 1];
+                row[x * 3 + 2] = source[x * 4 + 2];
+            }
+            file.write(RCAST<const char*>(row.data()), CAST<std::streamsize>(row.size()));
+        }
+
+        if (!file) {
+            std::cerr << "Failed to write " << path << "\n";
+            return false;
+        }
+
+        return true;
+    }
+}  // namespace X
@@ -0,0 +1,62 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+
+namespace X {
+    /// @brief 8-bit RGBA pixels, rows stored top to bottom without padding
+    class Image {
+    public:
+        Image() = default;
+        Image(u32 width, u32 height);
+
+        /// @brief Reallocate for @p width x @p height. Existing contents are not preserved.
+        void Resize(u32 width, u32 height);
+
+        /// @brief Reverse the row order, e.g. after glReadPixels() which returns rows bottom to top
+        void FlipVertically();
+
+        /// @brief Write as binary PPM (P6), dropping alpha. Returns false if the file couldn't be written.
+        bool WritePPM(const string& path) const;
+
+        X_ND u32 GetWidth() const {
+            return mWidth;
+        }
+
+        X_ND u32 GetHeight() const {
+            return mHeight;
+        }
+
+        X_ND u64 GetStride() const {
+            return CAST<u64>(mWidth) * 4;
+        }
+
+        X_ND bool IsEmpty() const {
+            return mPixels.empty();
+        }
+
+        X_ND u8* GetPixels() {
+            return mPixels.data();
+        }
+
+        X_ND const u8* GetPixels() const {
+            return mPixels.data();
+        }
+
+        X_ND u8* GetRow(u32 y) {
+            return mPixels.data() + y * GetStride();
+        }
+
+        X_ND const u8* GetRow(u32 y) const {
+            return mPixels.data() + y * GetStride();
+        }
+
+    private:
+        u32 mWidth {0};
+        u32 mHeight {0};
+        vector<u8> mPixels;
+    };
+}  // namespace X
@@ -0,0 +1,79 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "ImageSaver.hpp"
+
+#include <cstring>
+
+namespace X {
+    ImageSaver::ImageSaver(JobSystem* jobs, u32 queueDepth) : mJobSystem(jobs), mQueueDepth(X_MAX(queueDepth, 1u)) {}
+
+    ImageSaver::~ImageSaver() {
+        {
+            std::lock_guard lock(mMutex);
+            mStopping = true;
+        }
+        mQueueChanged.notify_all();
+
+        // The thread drains the queue before it exits, so nothing saved is lost
+        if (mThread.joinable()) { mThread.join(); }
+    }
+
+    void ImageSaver::Save(const Image& image, const string& path, ImageFormat format) {
+        Image copy;
+        {
+            std::unique_lock lock(mMutex);
+            if (!mThread.joinable()) { mThread = std::thread(&ImageSaver::ThreadMain, this); }
+
+            mQueueChanged.wait(lock, [this] { return mQueue.size() + mCopying < mQueueDepth; });
+            ++mCopying;
+            if (!mSpareImages.empty()) {
+                copy = std::move(mSpareImages.back());
+                mSpareImages.pop_back();
+            }
+        }
+
+        copy.Resize(image.GetWidth(), image.GetHeight());
+        std::memcpy(copy.GetPixels(), image.GetPixels(), image.GetStride() * image.GetHeight());
+
+        {
+            std::lock_guard lock(mMutex);
+            --mCopying;
+            mQueue.push_back({std::move(copy), path, format});
+        }
+        mQueueChanged.notify_all();
+    }
+
+    void ImageSaver::Flush() {
+        std::unique_lock lock(mMutex);
+        mQueueChanged.wait(lock, [this] { return mQueue.empty() && mCopying == 0; });
+    }
+
+    bool ImageSaver::Write(const Image& image, const string& path, ImageFormat format, JobSystem* jobs) {
+        auto writer = ImageStreamWriter::Create(format);
+        writer->SetJobSystem(jobs);
+        if (!writer->Open(path, image.GetWidth(), image.GetHeight())) return false;
+        if (!writer->WriteRows(image.GetPixels(), image.GetHeight(), image.GetStride())) return false;
+        return writer->Close();
+    }
+
+    void ImageSaver::ThreadMain() {
+        std::unique_lock lock(mMutex);
+        while (true) {
+            mQueueChanged.wait(lock, [this] { return !mQueue.empty() || mStopping; });
+            if (mQueue.empty()) return;
+
+            // Only this thread pops, so the front stays put while the lock is released
+            Request& request = mQueue.front();
+            lock.unlock();
+            const bool written = Write(request.image, request.path, request.format, mJobSystem);
+            lock.lock();
+
+            if (!written) { mFailures.fetch_add(1, std::memory_order_relaxed); }
+            if (mSpareImages.size() < mQueueDepth) { mSpareImages.push_back(std::move(request.image)); }
+            mQueue.pop_front();
+            mQueueChanged.notify_all();
+        }
+    }
+}  // namespace X
@@ -0,0 +1,70 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+#include "Image.hpp"
+#include "ImageStreamWriter.hpp"
+#include "JobSystem.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace X {
+    /**
+     * @brief Encodes and writes images in the background so saving a frame costs the caller one copy.
+     *
+     * Save() copies the image into a queue and returns. A thread of the saver's own streams each one through an
+     * ImageStreamWriter; the parallel parts of an encoder (PNG's deflate pieces) run on the JobSystem. Only the
+     * fine-grained pieces go to the pool, never a whole encode, so a frame's WaitFrame() that helps out with
+     * pending jobs is held up by at most one piece. At most @p queueDepth images wait at once: Save() blocks while
+     * the queue is full, so frames produced faster than the disk takes them can't pile up without bound.
+     */
+    class ImageSaver {
+    public:
+        explicit ImageSaver(JobSystem* jobs = nullptr, u32 queueDepth = 4);
+        ~ImageSaver();
+
+        ImageSaver(const ImageSaver&)            = delete;
+        ImageSaver& operator=(const ImageSaver&) = delete;
+
+        /// @brief Queue a copy of @p image to be written to @p path. Any thread.
+        void Save(const Image& image, const string& path, ImageFormat format);
+
+        /// @brief Block until every image queued so far is on disk (or failed)
+        void Flush();
+
+        /// @brief Images that couldn't be written; the reason was reported on std::cerr
+        X_ND u64 GetFailureCount() const {
+            return mFailures.load(std::memory_order_relaxed);
+        }
+
+        /// @brief Encode and write @p image on the calling thread, with @p jobs helping where the format allows
+        static bool Write(const Image& image, const string& path, ImageFormat format, JobSystem* jobs = nullptr);
+
+    private:
+        struct Request {
+            Image image;
+            string path;
+            ImageFormat format;
+        };
+
+        void ThreadMain();
+
+        JobSystem* mJobSystem;
+        u32 mQueueDepth;
+        std::mutex mMutex;
+        std::condition_variable mQueueChanged;
+        std::deque<Request> mQueue;  // The front one is being written
+        u32 mCopying {0};            // Save() calls holding a queue slot while they copy outside the lock
+        vector<Image> mSpareImages;  // Written images kept so the next Save() reuses their allocation
+        bool mStopping {false};
+        std::atomic<u64> mFailures {0};
+        std::thread mThread;  // Started by the first Save()
+    };
+}  // namespace X
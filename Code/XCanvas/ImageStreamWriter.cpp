@@ -0,0 +1,517 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "ImageStreamWriter.hpp"
+#include "Deflate.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace X {
+    static void PutBE32(vector<u8>& out, u32 value) {
+        out.push_back(CAST<u8>(value >> 24));
+        out.push_back(CAST<u8>(value >> 16));
+        out.push_back(CAST<u8>(value >> 8));
+        out.push_back(CAST<u8>(value));
+    }
+
+    static void PutLE(vector<u8>& out, u64 value, u32 bytes) {
+        for (u32 i = 0; i < bytes; ++i) {
+            out.push_back(CAST<u8>(value >> (i * 8)));
+        }
+    }
+
+    void PngStreamWriter::FilterRow(const u8* row, const u8* above, size_t size, u8* scratch, u8* out) {
+        static constexpr size_t kPixelSize = 4;
+        u8* sub   = scratch;
+        u8* up    = scratch + size;
+        u8* avg   = scratch + 2 * size;
+        u8* paeth = scratch + 3 * size;
+
+        // Residuals count as signed bytes
+        const auto cost = [](u8 residual) -> u32 {
+            return residual < 128 ? residual : 256 - residual;
+        };
+
+        u64 costs[5] = {};
+        for (size_t i = 0; i < size; ++i) {
+            const i32 x = row[i];
+            const i32 a = i >= kPixelSize ? row[i - kPixelSize] : 0;
+            const i32 b = above[i];
+            const i32 c = i >= kPixelSize ? above[i - kPixelSize] : 0;
+
+            const i32 pa      = std::abs(b - c), pb = std::abs(a - c), pc = std::abs(a + b - 2 * c);
+            const i32 nearest = pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+
+            sub[i]   = CAST<u8>(x - a);
+            up[i]    = CAST<u8>(x - b);
+            avg[i]   = CAST<u8>(x - (a + b) / 2);
+            paeth[i] = CAST<u8>(x - nearest);
+            costs[0] += cost(CAST<u8>(x));
+            costs[1] += cost(sub[i]);
+            costs[2] += cost(up[i]);
+            costs[3] += cost(avg[i]);
+            costs[4] += cost(paeth[i]);
+        }
+
+        u32 best = 0;
+        for (u32 filter = 1; filter < 5; ++filter) {
+            if (costs[filter] < costs[best]) { best = filter; }
+        }
+
+        out[0] = CAST<u8>(best);
+        std::memcpy(out + 1, best == 0 ? row : scratch + (best - 1) * size, size);
+    }
+
+    unique_ptr<ImageStreamWriter> ImageStreamWriter::Create(ImageFormat format) {
+        switch (format) {
+            case ImageFormat::TIFF:
+                return make_unique<TiffStreamWriter>();
+            case ImageFormat::QOI:
+                return make_unique<QoiStreamWriter>();
+            case ImageFormat::PPM:
+                return make_unique<PpmStreamWriter>();
+            case ImageFormat::PNG:
+            default:
+                return make_unique<PngStreamWriter>();
+        }
+    }
+
+    const char* ImageStreamWriter::GetExtension(ImageFormat format) {
+        switch (format) {
+            case ImageFormat::TIFF:
+                return "tiff";
+            case ImageFormat::QOI:
+                return "qoi";
+            case ImageFormat::PPM:
+                return "ppm";
+            case ImageFormat::PNG:
+            default:
+                return "png";
+        }
+    }
+
+    bool ImageStreamWriter::OpenFile(const string& path, u32 width, u32 height) {
+        if (width == 0 || height == 0) {
+            std::cerr << "Cannot write an empty image to " << path << "\n";
+            return false;
+        }
+
+        mFile.open(path, std::ios::binary | std::ios::trunc);
+        if (!mFile) {
+            std::cerr << "Failed to open " << path << " for writing\n";
+            return false;
+        }
+
+        mPath        = path;
+        mWidth       = width;
+        mHeight      = height;
+        mRowsWritten = 0;
+        return true;
+    }
+
+    bool ImageStreamWriter::CheckFile() {
+        if (mFile) return true;
+
+        std::cerr << "Failed to write " << mPath << "\n";
+        return false;
+    }
+
+    void ImageStreamWriter::Write(const vector<u8>& bytes) {
+        mFile.write(RCAST<const char*>(bytes.data()), CAST<std::streamsize>(bytes.size()));
+    }
+
+    void ImageStreamWriter::ForEach(u32 count,
+                                    u32 grainSize,
+                                    const std::function<void(u32 begin, u32 end)>& body) const {
+        if (mJobSystem) {
+            mJobSystem->ParallelFor(count, grainSize, body);
+            return;
+        }
+        if (count > 0) { body(0, count); }
+    }
+
+    bool PngStreamWriter::Open(const string& path, u32 width, u32 height) {
+        if (!OpenFile(path, width, height)) return false;
+
+        static constexpr u8 kSignature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        mFile.write(RCAST<const char*>(kSignature), sizeof(kSignature));
+
+        vector<u8> header;
+        PutBE32(header, width);
+        PutBE32(header, height);
+        header.insert(header.end(), {8, 6, 0, 0, 0});  // 8-bit RGBA, deflate, adaptive filtering, no interlace
+        WriteChunk("IHDR", header.data(), header.size());
+
+        mAdler = 1;
+        mPreviousRow.assign(CAST<size_t>(width) * 4, 0);  // Filters see zeros above the first row
+        mFiltered.clear();
+        return CheckFile();
+    }
+
+    bool PngStreamWriter::WriteRows(const u8* pixels, u32 rows, size_t stride) {
+        if (mRowsWritten + rows > mHeight) {
+            std::cerr << "Too many rows written to " << mPath << "\n";
+            return false;
+        }
+        if (rows == 0) return CheckFile();
+
+        // Big enough that block headers and the restarted match search cost nothing measurable, small enough that
+        // a 4K frame still splits into a few pieces per worker
+        static constexpr size_t kPieceSize = 256 * 1024;
+        static constexpr size_t kWindow    = 32 * 1024;
+
+        const size_t pixelBytes = CAST<size_t>(mWidth) * 4;
+        const size_t rowBytes   = 1 + pixelBytes;
+        const size_t size       = rowBytes * rows;
+
+        // Keep the end of the previous rows' filtered bytes so the first piece can match across the seam. When
+        // they all fit they're already in place, and copying a range onto itself isn't allowed.
+        const size_t history = X_MIN(mFiltered.size(), kWindow);
+        if (history < mFiltered.size()) {
+            std::copy(mFiltered.end() - CAST<std::ptrdiff_t>(history), mFiltered.end(), mFiltered.begin());
+        }
+        mFiltered.resize(history + size);
+        u8* filtered = mFiltered.data() + history;
+
+        ForEach(rows, X_MAX(CAST<u32>(kPieceSize / rowBytes), 1u), [&](u32 begin, u32 end) {
+            vector<u8> scratch(pixelBytes * 4);
+            for (u32 y = begin; y < end; ++y) {
+                const u8* above = y > 0 ? pixels + (y - 1) * stride : mPreviousRow.data();
+                FilterRow(pixels + y * stride, above, pixelBytes, scratch.data(), filtered + y * rowBytes);
+            }
+        });
+        mPreviousRow.assign(pixels + (rows - 1) * stride, pixels + (rows - 1) * stride + pixelBytes);
+
+        const bool final      = mRowsWritten + rows == mHeight;
+        const bool first      = mRowsWritten == 0;
+        const auto pieceCount = CAST<u32>((size + kPieceSize - 1) / kPieceSize);
+        if (mPieces.size() < pieceCount) { mPieces.resize(pieceCount); }
+
+        ForEach(pieceCount, 1, [&](u32 begin, u32 end) {
+            for (u32 i = begin; i < end; ++i) {
+                const size_t offset = i * kPieceSize;
+                const size_t length = X_MIN(kPieceSize, size - offset);
+                const bool last     = final && i == pieceCount - 1;
+
+                Piece& piece = mPieces[i];
+                piece.chunk.assign({0, 0, 0, 0, 'I', 'D', 'A', 'T'});
+                if (first && i == 0) { piece.chunk.insert(piece.chunk.end(), {0x78, 0x01}); }  // zlib, 32K window
+                Deflate::Compress(filtered + offset, length, history + offset, last, piece.chunk);
+                piece.adler = Deflate::Adler32(1, filtered + offset, length);
+
+                // The stream's last piece still needs the Adler-32 of everything, which only exists once all are done
+                if (!last) {
+                    const auto dataSize = CAST<u32>(piece.chunk.size() - 8);
+                    for (u32 byte = 0; byte < 4; ++byte) {
+                        piece.chunk[byte] = CAST<u8>(dataSize >> (24 - byte * 8));
+                    }
+                    PutBE32(piece.chunk, Deflate::Crc32(0, piece.chunk.data() + 4, piece.chunk.size() - 4));
+                }
+            }
+        });
+
+        for (u32 i = 0; i < pieceCount; ++i) {
+            Piece& piece = mPieces[i];
+            mAdler       = Deflate::CombineAdler32(mAdler, piece.adler, X_MIN(kPieceSize, size - i * kPieceSize));
+            if (final && i == pieceCount - 1) {
+                PutBE32(piece.chunk, mAdler);
+                WriteChunk("IDAT", piece.chunk.data() + 8, piece.chunk.size() - 8);
+                continue;
+            }
+            Write(piece.chunk);
+        }
+        mRowsWritten += rows;
+        return CheckFile();
+    }
+
+    bool PngStreamWriter::Close() {
+        if (mRowsWritten != mHeight) {
+            std::cerr << "Only " << mRowsWritten << " of " << mHeight << " rows were written to " << mPath << "\n";
+            return false;
+        }
+
+        WriteChunk("IEND", nullptr, 0);
+        mFile.close();
+        return CheckFile();
+    }
+
+    void PngStreamWriter::WriteChunk(const char* type, const u8* data, size_t size) {
+        vector<u8> header;
+        PutBE32(header, CAST<u32>(size));
+        header.insert(header.end(), type, type + 4);
+
+        u32 crc = Deflate::Crc32(0, header.data() + 4, 4);
+        crc     = Deflate::Crc32(crc, data, size);
+
+        vector<u8> footer;
+        PutBE32(footer, crc);
+
+        Write(header);
+        if (size > 0) { mFile.write(RCAST<const char*>(data), CAST<std::streamsize>(size)); }
+        Write(footer);
+    }
+
+    bool TiffStreamWriter::Open(const string& path, u32 width, u32 height) {
+        if (!OpenFile(path, width, height)) return false;
+
+        // Strips of roughly 1 MiB keep the offset tables small without making readers load huge strips
+        static constexpr u64 kStripBytes = 1u << 20;
+        static constexpr u64 kTagCount   = 11;
+
+        const u64 rowBytes     = CAST<u64>(width) * 4;
+        const u64 dataBytes    = rowBytes * height;
+        const u64 rowsPerStrip = X_MIN(X_MAX(kStripBytes / rowBytes, CAST<u64>(1)), CAST<u64>(height));
+        const u64 stripCount   = (height + rowsPerStrip - 1) / rowsPerStrip;
+
+        // Classic TIFF: 8-byte header, 12-byte IFD entries, 4-byte offsets. BigTIFF widens all three.
+        const u64 classicEnd = 8 + 2 + kTagCount * 12 + 4 + 8 + stripCount * 8 + dataBytes;
+        const bool big       = classicEnd > 0xFFFFFFFFull;
+
+        const u32 offsetSize = big ? 8 : 4;
+        const u64 ifdOffset  = big ? 16 : 8;
+        const u64 ifdSize    = big ? 8 + kTagCount * 20 + 8 : 2 + kTagCount * 12 + 4;
+        // BitsPerSample's four shorts only fit inline in a BigTIFF entry, a single strip's tables always do
+        const u64 tableSize     = stripCount > 1 ? stripCount * offsetSize : 0;
+        const u64 bitsOffset    = ifdOffset + ifdSize;
+        const u64 offsetsOffset = bitsOffset + (big ? 0 : 8);
+        const u64 countsOffset  = offsetsOffset + tableSize;
+        const u64 dataOffset    = countsOffset + tableSize;
+
+        vector<u8> out;
+        out.insert(out.end(), {'I', 'I'});
+        if (big) {
+            PutLE(out, 43, 2);
+            PutLE(out, 8, 2);
+            PutLE(out, 0, 2);
+            PutLE(out, ifdOffset, 8);
+            PutLE(out, kTagCount, 8);
+        } else {
+            PutLE(out, 42, 2);
+            PutLE(out, ifdOffset, 4);
+            PutLE(out, kTagCount, 2);
+        }
+
+        enum : u16 { kShort = 3, kLong = 4, kLong8 = 16 };
+        const u16 offsetType = big ? kLong8 : kLong;
+        // Values that fit the entry's value field are stored inline, left-justified; anything else is an offset
+        const auto entry = [&](u16 tag, u16 type, u64 count, u64 value) {
+            PutLE(out, tag, 2);
+            PutLE(out, type, 2);
+            PutLE(out, count, offsetSize);
+            PutLE(out, value, offsetSize);
+        };
+        const u64 strips = stripCount == 1 ? dataOffset : offsetsOffset;
+        const u64 counts = stripCount == 1 ? dataBytes : countsOffset;
+
+        entry(256, kLong, 1, width);  // ImageWidth
+        entry(257, kLong, 1, height);  // ImageLength
+        entry(258, kShort, 4, big ? 0x0008000800080008ull : bitsOffset);  // BitsPerSample
+        entry(259, kShort, 1, 1);  // Compression: none
+        entry(262, kShort, 1, 2);  // Photometric: RGB
+        entry(273, offsetType, stripCount, strips);  // StripOffsets
+        entry(277, kShort, 1, 4);  // SamplesPerPixel
+        entry(278, kLong, 1, rowsPerStrip);  // RowsPerStrip
+        entry(279, offsetType, stripCount, counts);  // StripByteCounts
+        entry(284, kShort, 1, 1);  // PlanarConfiguration: chunky
+        entry(338, kShort, 1, 2);  // ExtraSamples: unassociated alpha
+        PutLE(out, 0, offsetSize);  // No further IFDs
+
+        if (!big) {
+            for (u32 i = 0; i < 4; ++i) {
+                PutLE(out, 8, 2);
+            }
+        }
+        if (stripCount > 1) {
+            for (u64 i = 0; i < stripCount; ++i) {
+                PutLE(out, dataOffset + i * rowsPerStrip * rowBytes, offsetSize);
+            }
+            for (u64 i = 0; i < stripCount; ++i) {
+                const u64 rows = X_MIN(rowsPerStrip, height - i * rowsPerStrip);
+                PutLE(out, rows * rowBytes, offsetSize);
+            }
+        }
+        X_ASSERT(out.size() == dataOffset, "TiffStreamWriter::Open() - header layout mismatch!");
+
+        mFile.write(RCAST<const char*>(out.data()), CAST<std::streamsize>(out.size()));
+        return CheckFile();
+    }
+
+    bool TiffStreamWriter::WriteRows(const u8* pixels, u32 rows, size_t stride) {
+        if (mRowsWritten + rows > mHeight) {
+            std::cerr << "Too many rows written to " << mPath << "\n";
+            return false;
+        }
+
+        const auto rowBytes = CAST<size_t>(mWidth) * 4;
+        if (stride == rowBytes) {
+            mFile.write(RCAST<const char*>(pixels), CAST<std::streamsize>(rowBytes * rows));
+        } else {
+            for (u32 y = 0; y < rows; ++y) {
+                mFile.write(RCAST<const char*>(pixels + y * stride), CAST<std::streamsize>(rowBytes));
+            }
+        }
+        mRowsWritten += rows;
+        return CheckFile();
+    }
+
+    bool TiffStreamWriter::Close() {
+        if (mRowsWritten != mHeight) {
+            std::cerr << "Only " << mRowsWritten << " of " << mHeight << " rows were written to " << mPath << "\n";
+            return false;
+        }
+
+        mFile.close();
+        return CheckFile();
+    }
+
+    bool QoiStreamWriter::Open(const string& path, u32 width, u32 height) {
+        if (!OpenFile(path, width, height)) return false;
+
+        vector<u8> header = {'q', 'o', 'i', 'f'};
+        PutBE32(header, width);
+        PutBE32(header, height);
+        header.insert(header.end(), {4, 0});  // RGBA, sRGB color with linear alpha
+        Write(header);
+
+        static constexpr u8 kStart[4] = {0, 0, 0, 255};
+        std::memcpy(&mPrevious, kStart, sizeof(mPrevious));
+        mIndex.fill(0);
+        mRun = 0;
+        return CheckFile();
+    }
+
+    bool QoiStreamWriter::WriteRows(const u8* pixels, u32 rows, size_t stride) {
+        if (mRowsWritten + rows > mHeight) {
+            std::cerr << "Too many rows written to " << mPath << "\n";
+            return false;
+        }
+
+        // Worst case is a full RGBA op, five bytes, for every pixel
+        mEncoded.resize(CAST<size_t>(rows) * mWidth * 5);
+        u8* out = mEncoded.data();
+        for (u32 y = 0; y < rows; ++y) {
+            const u8* row = pixels + y * stride;
+            for (u32 x = 0; x < mWidth; ++x) {
+                const u8* p = row + x * 4;
+                u32 pixel;
+                std::memcpy(&pixel, p, sizeof(pixel));
+
+                if (pixel == mPrevious) {
+                    if (++mRun == 62) {
+                        *out++ = 0xC0 | 61;
+                        mRun   = 0;
+                    }
+                    continue;
+                }
+                if (mRun > 0) {
+                    *out++ = CAST<u8>(0xC0 | (mRun - 1));
+                    mRun   = 0;
+                }
+
+                const u32 hash = (p[0] * 3 + p[1] * 5 + p[2] * 7 + p[3] * 11) % 64;
+                if (mIndex[hash] == pixel) {
+                    *out++ = CAST<u8>(hash);
+                } else {
+                    mIndex[hash] = pixel;
+
+                    u8 previous[4];
+                    std::memcpy(previous, &mPrevious, sizeof(previous));
+                    if (p[3] == previous[3]) {
+                        const auto dr = CAST<i8>(p[0] - previous[0]);
+                        const auto dg = CAST<i8>(p[1] - previous[1]);
+                        const auto db = CAST<i8>(p[2] - previous[2]);
+                        const auto rg = CAST<i8>(dr - dg);
+                        const auto bg = CAST<i8>(db - dg);
+                        if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                            *out++ = CAST<u8>(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+                        } else if (rg >= -8 && rg <= 7 && dg >= -32 && dg <= 31 && bg >= -8 && bg <= 7) {
+                            *out++ = CAST<u8>(0x80 | (dg + 32));
+                            *out++ = CAST<u8>((rg + 8) << 4 | (bg + 8));
+                        } else {
+                            *out++ = 0xFE;
+                            *out++ = p[0];
+                            *out++ = p[1];
+                            *out++ = p[2];
+                        }
+                    } else {
+                        *out++ = 0xFF;
+                        *out++ = p[0];
+                        *out++ = p[1];
+                        *out++ = p[2];
+                        *out++ = p[3];
+                    }
+                }
+                mPrevious = pixel;
+            }
+        }
+
+        mEncoded.resize(CAST<size_t>(out - mEncoded.data()));
+        Write(mEncoded);
+        mRowsWritten += rows;
+        return CheckFile();
+    }
+
+    bool QoiStreamWriter::Close() {
+        if (mRowsWritten != mHeight) {
+            std::cerr << "Only " << mRowsWritten << " of " << mHeight << " rows were written to " << mPath << "\n";
+            return false;
+        }
+
+        FlushRun();
+        Write({0, 0, 0, 0, 0, 0, 0, 1});  // End marker
+        mFile.close();
+        return CheckFile();
+    }
+
+    void QoiStreamWriter::FlushRun() {
+        if (mRun == 0) return;
+
+        Write({CAST<u8>(0xC0 | (mRun - 1))});
+        mRun = 0;
+    }
+
+    bool PpmStreamWriter::Open(const string& path, u32 width, u32 height) {
+        if (!OpenFile(path, width, height)) return false;
+
+        mFile << "P6\n" << width << " " << height << "\n255\n";
+        return CheckFile();
+    }
+
+    bool PpmStreamWriter::WriteRows(const u8* pixels, u32 rows, size_t stride) {
+        if (mRowsWritten + rows > mHeight) {
+            std::cerr << "Too many rows written to " << mPath << "\n";
+            return false;
+        }
+
+        const size_t rowBytes = CAST<size_t>(mWidth) * 3;
+        mConverted.resize(rowBytes * rows);
+        ForEach(rows, 64, [&](u32 begin, u32 end) {
+            for (u32 y = begin; y < end; ++y) {
+                const u8* source = pixels + y * stride;
+                u8* target       = mConverted.data() + y * rowBytes;
+                for (u32 x = 0; x < mWidth; ++x) {
+                    target[x * 3 + 0] = source[x * 4 + 0];
+                    target[x * 3 + 1] = source[x * 4 + 1];
+                    target[x * 3 + 2] = source[x * 4 + 2];
+                }
+            }
+        });
+
+        Write(mConverted);
+        mRowsWritten += rows;
+        return CheckFile();
+    }
+
+    bool PpmStreamWriter::Close() {
+        if (mRowsWritten != mHeight) {
+            std::cerr << "Only " << mRowsWritten << " of " << mHeight << " rows were written to " << mPath << "\n";
+            return false;
+        }
+
+        mFile.close();
+        return CheckFile();
+    }
+}  // namespace X
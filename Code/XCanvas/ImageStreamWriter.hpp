@@ -0,0 +1,153 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+#include "JobSystem.hpp"
+
+#include <array>
+#include <fstream>
+
+namespace X {
+    enum class ImageFormat : u8 { PNG, TIFF, QOI, PPM };
+
+    /**
+     * @brief Writes an RGBA8 image to disk top to bottom, a band of rows at a time.
+     *
+     * Only the band being written is ever in memory, so the output can be far larger than RAM. Open() writes the
+     * header, WriteRows() appends rows below those already written and Close() finishes the file once all rows
+     * are in. Failures are reported on std::cerr and by the return values.
+     */
+    class ImageStreamWriter {
+    public:
+        virtual ~ImageStreamWriter() = default;
+
+        static unique_ptr<ImageStreamWriter> Create(ImageFormat format);
+
+        /// @brief File extension for @p format, without the dot
+        static const char* GetExtension(ImageFormat format);
+
+        /// @brief Encode in parallel on @p jobs where the format allows it; nullptr encodes on the calling thread
+        void SetJobSystem(JobSystem* jobs) {
+            mJobSystem = jobs;
+        }
+
+        virtual bool Open(const string& path, u32 width, u32 height) = 0;
+
+        /// @brief Append @p rows rows of @p stride bytes each, starting at @p pixels
+        virtual bool WriteRows(const u8* pixels, u32 rows, size_t stride) = 0;
+
+        /// @brief Finish the file. Fails if fewer rows than the image height were written.
+        virtual bool Close() = 0;
+
+        X_ND u32 GetWidth() const {
+            return mWidth;
+        }
+
+        X_ND u32 GetHeight() const {
+            return mHeight;
+        }
+
+        X_ND u32 GetRowsWritten() const {
+            return mRowsWritten;
+        }
+
+    protected:
+        bool OpenFile(const string& path, u32 width, u32 height);
+        bool CheckFile();
+        void Write(const vector<u8>& bytes);
+
+        /// @brief Run @p body over [0, count) in chunks of @p grainSize, on the job system when there is one
+        void ForEach(u32 count, u32 grainSize, const std::function<void(u32 begin, u32 end)>& body) const;
+
+        JobSystem* mJobSystem {nullptr};
+        std::ofstream mFile;
+        string mPath;
+        u32 mWidth {0};
+        u32 mHeight {0};
+        u32 mRowsWritten {0};
+    };
+
+    /**
+     * @brief Non-interlaced RGBA8 PNG, compressed as a single zlib stream.
+     *
+     * Each row gets the PNG filter with the smallest sum of absolute residuals. The filtered bytes of every
+     * WriteRows() are cut into fixed-size pieces that Deflate::Compress() handles independently, in parallel when a
+     * job system is set, each piece still matching against the 32 KiB before it. Every piece becomes its own IDAT
+     * chunk, so stitching the pieces' checksums together is the only serial work.
+     */
+    class PngStreamWriter final : public ImageStreamWriter {
+    public:
+        bool Open(const string& path, u32 width, u32 height) override;
+        bool WriteRows(const u8* pixels, u32 rows, size_t stride) override;
+        bool Close() override;
+
+        /**
+         * @brief Filter one RGBA row of @p size bytes into a filter type byte and residuals at @p out.
+         *
+         * @p above is the previous row, all zeros for the first. Every filter's residuals are computed in one pass
+         * into @p scratch (four rows) and the one with the smallest sum of magnitudes, the usual heuristic, is kept.
+         */
+        static void FilterRow(const u8* row, const u8* above, size_t size, u8* scratch, u8* out);
+
+    private:
+        struct Piece {
+            vector<u8> chunk;  // Complete IDAT chunk: length, type, compressed bytes and, once known, the CRC
+            u32 adler {1};     // Of the uncompressed bytes
+        };
+
+        void WriteChunk(const char* type, const u8* data, size_t size);
+
+        u32 mAdler {1};
+        vector<u8> mPreviousRow;  // Row above the next one written, zeros before the first
+        vector<u8> mFiltered;     // Tail of the previous rows' filtered bytes as history, then the rows being written
+        vector<Piece> mPieces;
+    };
+
+    /**
+     * @brief Uncompressed, contiguous RGBA8 TIFF with unassociated alpha.
+     *
+     * Strip offsets are all known up front, so the header and IFD are written by Open() and the pixels stream
+     * straight after them. Images whose data won't fit in 32-bit offsets are written as BigTIFF.
+     */
+    class TiffStreamWriter final : public ImageStreamWriter {
+    public:
+        bool Open(const string& path, u32 width, u32 height) override;
+        bool WriteRows(const u8* pixels, u32 rows, size_t stride) override;
+        bool Close() override;
+    };
+
+    /**
+     * @brief RGBA QOI ("Quite OK Image"), a single pass of run, index and small-delta codes over the pixels.
+     *
+     * Usually within a factor of two of PNG's size at a small fraction of its encoding cost. The format is
+     * inherently sequential, so it never uses the job system.
+     */
+    class QoiStreamWriter final : public ImageStreamWriter {
+    public:
+        bool Open(const string& path, u32 width, u32 height) override;
+        bool WriteRows(const u8* pixels, u32 rows, size_t stride) override;
+        bool Close() override;
+
+    private:
+        void FlushRun();
+
+        std::array<u32, 64> mIndex {};  // Recently seen pixels by hash, as loaded from memory
+        u32 mPrevious {0};
+        u32 mRun {0};
+        vector<u8> mEncoded;
+    };
+
+    /// @brief Binary PPM (P6). Alpha is dropped.
+    class PpmStreamWriter final : public ImageStreamWriter {
+    public:
+        bool Open(const string& path, u32 width, u32 height) override;
+        bool WriteRows(const u8* pixels, u32 rows, size_t stride) override;
+        bool Close() override;
+
+    private:
+        vector<u8> mConverted;
+    };
+}  // namespace X
@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include "Shared.hpp"
+
+#include <bitset>
+
 namespace X {
     /**
      * @brief Key code definitions for keyboard input
@@ -157,4 +161,107 @@ namespace X {
         static constexpr u16 Right   = Button2;
         static constexpr u16 Middle  = Button3;
     }  // namespace MouseButtons
-}  // namespace X
\ No newline at end of file
+
+    /**
+     * @brief Modifier bits reported with key and mouse button events
+     */
+    namespace KeyMods {
+        static constexpr u16 Shift    = 0x0001;
+        static constexpr u16 Control  = 0x0002;
+        static constexpr u16 Alt      = 0x0004;
+        static constexpr u16 Super    = 0x0008;
+        static constexpr u16 CapsLock = 0x0010;
+        static constexpr u16 NumLock  = 0x0020;
+    }  // namespace KeyMods
+
+    enum class InputEventType : u8 {
+        KeyPress,
+        KeyRelease,
+        KeyRepeat,
+        MouseButtonPress,
+        MouseButtonRelease,
+        CursorMove,
+        Scroll,
+    };
+
+    /// @brief A single input event, stamped with Clock::Now() when the window system reported it
+    struct InputEvent {
+        InputEventType type {InputEventType::KeyPress};
+        u16 code {0};  ///< Key or mouse button code
+        u16 mods {0};  ///< KeyMods bits
+        f64 x {0.0};   ///< Cursor position or scroll offset
+        f64 y {0.0};
+        f64 timestamp {0.0};
+    };
+
+    /**
+     * @brief Which keys and mouse buttons are held, plus the cursor position and active modifiers.
+     *
+     * Application applies each event right before its handler runs, so queries from a handler see the state as of
+     * that event and queries from OnUpdate() see the state after the frame's last event.
+     */
+    class InputState {
+    public:
+        X_ND bool IsKeyDown(u16 key) const {
+            return key <= Keys::Last && mKeys.test(key);
+        }
+
+        X_ND bool IsMouseButtonDown(u16 button) const {
+            return button <= MouseButtons::Last && mButtons.test(button);
+        }
+
+        X_ND u16 GetMods() const {
+            return mMods;
+        }
+
+        X_ND f64 GetCursorX() const {
+            return mCursorX;
+        }
+
+        X_ND f64 GetCursorY() const {
+            return mCursorY;
+        }
+
+        /// @brief Timestamp of the most recently applied event, 0 before any input
+        X_ND f64 GetLastEventTime() const {
+            return mLastEventTime;
+        }
+
+        void Apply(const InputEvent& event) {
+            switch (event.type) {
+                case InputEventType::KeyPress:
+                case InputEventType::KeyRepeat:
+                    if (event.code <= Keys::Last) { mKeys.set(event.code); }
+                    mMods = event.mods;
+                    break;
+                case InputEventType::KeyRelease:
+                    if (event.code <= Keys::Last) { mKeys.reset(event.code); }
+                    mMods = event.mods;
+                    break;
+                case InputEventType::MouseButtonPress:
+                    if (event.code <= MouseButtons::Last) { mButtons.set(event.code); }
+                    mMods = event.mods;
+                    break;
+                case InputEventType::MouseButtonRelease:
+                    if (event.code <= MouseButtons::Last) { mButtons.reset(event.code); }
+                    mMods = event.mods;
+                    break;
+                case InputEventType::CursorMove:
+                    mCursorX = event.x;
+                    mCursorY = event.y;
+                    break;
+                case InputEventType::Scroll:
+                    break;
+            }
+            mLastEventTime = event.timestamp;
+        }
+
+    private:
+        std::bitset<Keys::Last + 1> mKeys;
+        std::bitset<MouseButtons::Last + 1> mButtons;
+        u16 mMods {0};
+        f64 mCursorX {0.0};
+        f64 mCursorY {0.0};
+        f64 mLastEventTime {0.0};
+    };
+}  // namespace X
@@ -0,0 +1,95 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "InputRecording.hpp"
+#include "CommandList.hpp"
+
+#include <stdexcept>
+
+namespace X {
+    static constexpr u32 kRecordingMagic   = 0x52494358;  // "XCIR"
+    static constexpr u32 kRecordingVersion = 1;
+    static constexpr u64 kEventSize        = sizeof(u8) + 2 * sizeof(u16) + 2 * sizeof(f64);  // As written to the file
+
+    template<typename T>
+    static void Write(std::ofstream& file, const T& value) {
+        file.write(RCAST<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    static bool Read(std::ifstream& file, T& value) {
+        return CAST<bool>(file.read(RCAST<char*>(&value), sizeof(T)));
+    }
+
+    InputRecorder::InputRecorder(const string& path, u64 seed, u32 width, u32 height)
+        : mFile(path, std::ios::binary | std::ios::trunc) {
+        if (!mFile) { throw std::runtime_error("Failed to create input recording: " + path); }
+
+        Write(mFile, kRecordingMagic);
+        Write(mFile, kRecordingVersion);
+        Write(mFile, seed);
+        Write(mFile, width);
+        Write(mFile, height);
+    }
+
+    void InputRecorder::EndFrame(f64 deltaTime, u32 width, u32 height) {
+        Write(mFile, deltaTime);
+        Write(mFile, width);
+        Write(mFile, height);
+        Write(mFile, CAST<u32>(mEvents.size()));
+        for (const auto& event : mEvents) {
+            Write(mFile, CAST<u8>(event.type));
+            Write(mFile, event.code);
+            Write(mFile, event.mods);
+            Write(mFile, event.x);
+            Write(mFile, event.y);
+        }
+        mEvents.clear();
+    }
+
+    InputPlayer::InputPlayer(const string& path) : mFile(path, std::ios::binary) {
+        if (!mFile) { throw std::runtime_error("Failed to open input recording: " + path); }
+        mFile.seekg(0, std::ios::end);
+        mFileSize = CAST<u64>(mFile.tellg());
+        mFile.seekg(0);
+
+        u32 magic   = 0;
+        u32 version = 0;
+        if (!Read(mFile, magic) || magic != kRecordingMagic) {
+            throw std::runtime_error("Not an input recording: " + path);
+        }
+        if (!Read(mFile, version) || version != kRecordingVersion) {
+            throw std::runtime_error("Unsupported input recording version: " + path);
+        }
+        if (!Read(mFile, mSeed) || !Read(mFile, mWidth) || !Read(mFile, mHeight)) {
+            throw std::runtime_error("Truncated input recording: " + path);
+        }
+        if (!CanvasFrame::IsValidSize(mWidth, mHeight)) {
+            throw std::runtime_error("Damaged input recording: " + path);
+        }
+    }
+
+    bool InputPlayer::ReadFrame(InputFrame& frame) {
+        u32 eventCount = 0;
+        if (!Read(mFile, frame.deltaTime) || !Read(mFile, frame.width) || !Read(mFile, frame.height) ||
+            !Read(mFile, eventCount)) {
+            return false;
+        }
+        // Damaged counts and sizes end the replay before they reach an allocation or the framebuffer
+        if (!CanvasFrame::IsValidSize(frame.width, frame.height)) return false;
+        if (eventCount > (mFileSize - CAST<u64>(mFile.tellg())) / kEventSize) return false;
+
+        frame.events.resize(eventCount);
+        for (auto& event : frame.events) {
+            u8 type = 0;
+            if (!Read(mFile, type) || !Read(mFile, event.code) || !Read(mFile, event.mods) || !Read(mFile, event.x) ||
+                !Read(mFile, event.y)) {
+                return false;  // A frame cut short by a crash mid-write is dropped
+            }
+            event.type = CAST<InputEventType>(type);
+        }
+
+        return true;
+    }
+}  // namespace X
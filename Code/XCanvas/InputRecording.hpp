@@ -0,0 +1,73 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+#include "Input.hpp"
+
+#include <fstream>
+
+namespace X {
+    /// @brief Everything Application::Run() consumed in one frame, as stored in an input recording
+    struct InputFrame {
+        f64 deltaTime {0.0};
+        u32 width {0};
+        u32 height {0};
+        vector<InputEvent> events;
+    };
+
+    /**
+     * @brief Writes an input recording: a header with the seed and initial window size, then one InputFrame per
+     * frame. Event timestamps are not stored; replayed events are stamped when they are delivered.
+     *
+     * The format is little-endian with fixed-size fields (21 bytes per event plus 20 per frame), so recordings are not
+     * portable to big-endian hosts.
+     */
+    class InputRecorder {
+    public:
+        /// @brief Throws std::runtime_error if @p path can't be created
+        InputRecorder(const string& path, u64 seed, u32 width, u32 height);
+
+        void Record(const InputEvent& event) {
+            mEvents.push_back(event);
+        }
+
+        /// @brief Write the events recorded since the last call as one frame
+        void EndFrame(f64 deltaTime, u32 width, u32 height);
+
+    private:
+        std::ofstream mFile;
+        vector<InputEvent> mEvents;
+    };
+
+    /// @brief Reads a recording written by InputRecorder back one frame at a time
+    class InputPlayer {
+    public:
+        /// @brief Throws std::runtime_error if @p path can't be opened or isn't a compatible recording
+        explicit InputPlayer(const string& path);
+
+        /// @brief Read the next frame into @p frame. Returns false at the end of the recording or a damaged frame.
+        bool ReadFrame(InputFrame& frame);
+
+        X_ND u64 GetSeed() const {
+            return mSeed;
+        }
+
+        X_ND u32 GetWidth() const {
+            return mWidth;
+        }
+
+        X_ND u32 GetHeight() const {
+            return mHeight;
+        }
+
+    private:
+        std::ifstream mFile;
+        u64 mFileSize {0};
+        u64 mSeed {0};
+        u32 mWidth {0};
+        u32 mHeight {0};
+    };
+}  // namespace X
@@ -0,0 +1,273 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "JobSystem.hpp"
+#include "Clock.hpp"
+
+#include <iostream>
+
+namespace X {
+    // Identifies pool threads so nested scheduling goes to the caller's own deque
+    static thread_local const JobSystem* tOwner = nullptr;
+    static thread_local i32 tWorkerIndex        = -1;
+
+    JobSystem::JobSystem(u32 workerCount) {
+        if (workerCount == 0) {
+            const u32 hardware = std::thread::hardware_concurrency();
+            workerCount        = hardware > 1 ? hardware - 1 : 1;
+        }
+
+        mStatsStart = Clock::Now();
+        for (u32 i = 0; i < workerCount; ++i) {
+            mWorkers.push_back(make_unique<Worker>());
+        }
+        for (u32 i = 0; i < workerCount; ++i) {
+            mWorkers[i]->thread = std::thread(&JobSystem::WorkerMain, this, i);
+        }
+    }
+
+    JobSystem::~JobSystem() {
+        WaitFrame();
+
+        {
+            std::lock_guard lock(mSleepMutex);
+            mShutdown = true;
+        }
+        mWakeCondition.notify_all();
+
+        for (const auto& worker : mWorkers) {
+            if (worker->thread.joinable()) { worker->thread.join(); }
+        }
+    }
+
+    void JobSystem::Schedule(Job job, JobCounter& counter) {
+        counter.mPending.fetch_add(1, std::memory_order_relaxed);
+        Push({std::move(job), &counter});
+    }
+
+    void JobSystem::Schedule(Job job) {
+        Schedule(std::move(job), mFrameCounter);
+    }
+
+    void JobSystem::Wait(const JobCounter& counter) {
+        const i32 workerIndex = GetCurrentWorkerIndex();
+        while (true) {
+            const u64 completions = mCompletions.load(std::memory_order_acquire);
+            if (counter.IsDone()) return;
+            if (TryRunOne(workerIndex)) continue;
+
+            // Everything left is running elsewhere; sleep until some job completes
+            mCompletions.wait(completions, std::memory_order_acquire);
+        }
+    }
+
+    void JobSystem::WaitFrame() {
+        Wait(mFrameCounter);
+    }
+
+    void JobSystem::ParallelFor(u32 count, u32 grainSize, const std::function<void(u32 begin, u32 end)>& body) {
+        if (count == 0) return;
+        grainSize = X_MAX(grainSize, 1u);
+
+        JobCounter counter;
+        for (u32 begin = grainSize; begin < count; begin += grainSize) {
+            const u32 end = X_MIN(begin + grainSize, count);
+            Schedule([&body, begin, end] { body(begin, end); }, counter);
+        }
+
+        // First chunk inline, the rest are picked up by workers (and by Wait() below)
+        body(0, X_MIN(grainSize, count));
+        Wait(counter);
+    }
+
+    i32 JobSystem::GetCurrentWorkerIndex() const {
+        return tOwner == this ? tWorkerIndex : -1;
+    }
+
+    vector<JobSystem::WorkerStats> JobSystem::GetWorkerStats() const {
+        const f64 elapsed = Clock::Now() - mStatsStart;
+
+        vector<WorkerStats> stats;
+        stats.reserve(mWorkers.size());
+        for (const auto& worker : mWorkers) {
+            WorkerStats entry;
+            entry.jobsExecuted = worker->jobsExecuted.load(std::memory_order_relaxed);
+            entry.jobsStolen   = worker->jobsStolen.load(std::memory_order_relaxed);
+            entry.busyTime     = CAST<f64>(worker->busyNanoseconds.load(std::memory_order_relaxed)) * 1e-9;
+            entry.utilization  = elapsed > 0.0 ? X_MIN(entry.busyTime / elapsed, 1.0) : 0.0;
+            stats.push_back(entry);
+        }
+
+        return stats;
+    }
+
+    void JobSystem::ResetStats() {
+        for (const auto& worker : mWorkers) {
+            worker->jobsExecuted    = 0;
+            worker->jobsStolen      = 0;
+            worker->busyNanoseconds = 0;
+        }
+        mStatsStart = Clock::Now();
+    }
+
+    void JobSystem::WorkerMain(u32 index) {
+        tOwner       = this;
+        tWorkerIndex = CAST<i32>(index);
+
+        static constexpr u32 kSpinsBeforeSleep = 64;
+        u32 idleSpins                          = 0;
+        while (!mShutdown.load(std::memory_order_acquire)) {
+            if (TryRunOne(tWorkerIndex)) {
+                idleSpins = 0;
+                continue;
+            }
+
+            if (++idleSpins < kSpinsBeforeSleep) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock lock(mSleepMutex);
+            mWakeCondition.wait(lock, [this] {
+                return mQueuedTasks.load(std::memory_order_acquire) > 0 || mShutdown.load(std::memory_order_acquire);
+            });
+            idleSpins = 0;
+        }
+    }
+
+    void JobSystem::Push(Task task) {
+        // Pool threads keep their own work local; everyone else spreads it round-robin
+        const i32 current  = GetCurrentWorkerIndex();
+        const u32 index    = current >= 0 ? CAST<u32>(current)
+                                          : mNextWorker.fetch_add(1, std::memory_order_relaxed) % mWorkers.size();
+        Worker& worker     = *mWorkers[index];
+        {
+            std::lock_guard lock(worker.mutex);
+            worker.tasks.push_back(std::move(task));
+        }
+
+        mQueuedTasks.fetch_add(1, std::memory_order_seq_cst);
+        {
+            // Pairs with the predicate check in WorkerMain() so a worker about to sleep can't miss this task
+            std::lock_guard lock(mSleepMutex);
+        }
+        mWakeCondition.notify_one();
+    }
+
+    bool JobSystem::TryRunOne(i32 workerIndex) {
+        Task task;
+        if (workerIndex >= 0 && TryPop(CAST<u32>(workerIndex), task)) {
+            Run(task, workerIndex);
+            return true;
+        }
+
+        if (TrySteal(workerIndex, task)) {
+            Run(task, workerIndex);
+            return true;
+        }
+
+        return false;
+    }
+
+    bool JobSystem::TryPop(u32 workerIndex, Task& task) {
+        Worker& worker = *mWorkers[workerIndex];
+        std::lock_guard lock(worker.mutex);
+        if (worker.tasks.empty()) return false;
+
+        task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+        mQueuedTasks.fetch_sub(1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    bool JobSystem::TrySteal(i32 thiefIndex, Task& task) {
+        if (mQueuedTasks.load(std::memory_order_relaxed) == 0) return false;
+
+        // Threads outside the pool start their scan after worker 0 and aren't credited with the steal
+        const u32 start  = thiefIndex >= 0 ? CAST<u32>(thiefIndex) : 0;
+        const auto count = CAST<u32>(mWorkers.size());
+        for (u32 offset = 1; offset <= count; ++offset) {
+            Worker& victim = *mWorkers[(start + offset) % count];
+            std::unique_lock lock(victim.mutex, std::try_to_lock);
+            if (!lock.owns_lock() || victim.tasks.empty()) continue;
+
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            mQueuedTasks.fetch_sub(1, std::memory_order_relaxed);
+            if (thiefIndex >= 0) { mWorkers[thiefIndex]->jobsStolen.fetch_add(1, std::memory_order_relaxed); }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    void JobSystem::Run(Task& task, i32 workerIndex) {
+        const auto start = std::chrono::steady_clock::now();
+        task.job();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        if (workerIndex >= 0) {
+            Worker& worker = *mWorkers[workerIndex];
+            worker.jobsExecuted.fetch_add(1, std::memory_order_relaxed);
+            worker.busyNanoseconds.fetch_add(
+              CAST<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+              std::memory_order_relaxed);
+        }
+
+        // The counter may be destroyed the moment it drains, so wake waiters through the pool instead
+        task.counter->mPending.fetch_sub(1, std::memory_order_acq_rel);
+        mCompletions.fetch_add(1, std::memory_order_release);
+        mCompletions.notify_all();
+    }
+
+    TaskGraph::TaskId TaskGraph::Add(Job job, std::initializer_list<TaskId> dependencies) {
+        const auto id = CAST<TaskId>(mNodes.size());
+
+        Node node;
+        node.job             = std::move(job);
+        node.dependencyCount = CAST<u32>(dependencies.size());
+        mNodes.push_back(std::move(node));
+
+        for (const TaskId dependency : dependencies) {
+            X_ASSERT(dependency < id, "TaskGraph dependencies must be added before their dependents");
+            mNodes[dependency].dependents.push_back(id);
+        }
+
+        return id;
+    }
+
+    void TaskGraph::Run(JobSystem& jobs) {
+        for (auto& node : mNodes) {
+            node.remaining.store(node.dependencyCount, std::memory_order_relaxed);
+        }
+
+        JobCounter counter;
+        for (TaskId id = 0; id < mNodes.size(); ++id) {
+            if (mNodes[id].dependencyCount == 0) { Launch(jobs, id, counter); }
+        }
+        jobs.Wait(counter);
+    }
+
+    void TaskGraph::Clear() {
+        mNodes.clear();
+    }
+
+    void TaskGraph::Launch(JobSystem& jobs, TaskId id, JobCounter& counter) {
+        jobs.Schedule(
+          [this, &jobs, &counter, id] {
+              Node& node = mNodes[id];
+              node.job();
+
+              // Dependents are scheduled before this job retires, so the counter can't drain early
+              for (const TaskId dependent : node.dependents) {
+                  if (mNodes[dependent].remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                      Launch(jobs, dependent, counter);
+                  }
+              }
+          },
+          counter);
+    }
+}  // namespace X
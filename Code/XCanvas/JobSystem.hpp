@@ -0,0 +1,158 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace X {
+    using Job = std::function<void()>;
+
+    /// @brief Completion counter for a group of jobs. JobSystem::Wait() returns once every attached job has run.
+    class JobCounter {
+    public:
+        X_ND bool IsDone() const {
+            return mPending.load(std::memory_order_acquire) == 0;
+        }
+
+    private:
+        friend class JobSystem;
+        std::atomic<u32> mPending {0};
+    };
+
+    /**
+     * @brief Work-stealing thread pool.
+     *
+     * Every worker owns a deque: it pushes and pops its own jobs at the back (LIFO, cache friendly) while idle
+     * workers steal from the front of others (FIFO, oldest and usually largest work first). Jobs scheduled from
+     * outside the pool are spread round-robin across the deques. Waiting never blocks a thread outright; Wait()
+     * runs pending jobs until its counter drains, so nested waits inside jobs can't deadlock the pool.
+     *
+     * Jobs scheduled without an explicit counter belong to the current frame and are drained by WaitFrame(),
+     * which Application::Run() calls once per frame after OnPaint().
+     */
+    class JobSystem {
+    public:
+        /// @brief Per-worker counters, accumulated since construction or the last ResetStats()
+        struct WorkerStats {
+            u64 jobsExecuted {0};
+            u64 jobsStolen {0};
+            f64 busyTime {0.0};     // Seconds spent running jobs
+            f64 utilization {0.0};  // busyTime over wall time since the last reset, 0-1
+        };
+
+        /// @param workerCount Number of worker threads, 0 sizes the pool to the hardware concurrency minus the
+        /// calling thread (which helps out while waiting)
+        explicit JobSystem(u32 workerCount = 0);
+        ~JobSystem();
+
+        JobSystem(const JobSystem&)            = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        void Schedule(Job job, JobCounter& counter);
+
+        /// @brief Schedule a job that is part of the current frame, see WaitFrame()
+        void Schedule(Job job);
+
+        /// @brief Run pending jobs on this thread until @p counter drains
+        void Wait(const JobCounter& counter);
+
+        /// @brief Wait for every frame job scheduled since the previous WaitFrame()
+        void WaitFrame();
+
+        /**
+         * @brief Split [0, count) into chunks of @p grainSize and run @p body(begin, end) over them in parallel.
+         *
+         * Blocks until every chunk finished; the calling thread processes chunks too.
+         */
+        void ParallelFor(u32 count, u32 grainSize, const std::function<void(u32 begin, u32 end)>& body);
+
+        X_ND u32 GetWorkerCount() const {
+            return CAST<u32>(mWorkers.size());
+        }
+
+        /// @brief Index of the calling worker, or -1 for threads outside the pool
+        X_ND i32 GetCurrentWorkerIndex() const;
+
+        X_ND vector<WorkerStats> GetWorkerStats() const;
+        void ResetStats();
+
+    private:
+        struct Task {
+            Job job;
+            JobCounter* counter;
+        };
+
+        struct alignas(64) Worker {
+            std::thread thread;
+            std::mutex mutex;
+            std::deque<Task> tasks;
+
+            std::atomic<u64> jobsExecuted {0};
+            std::atomic<u64> jobsStolen {0};
+            std::atomic<u64> busyNanoseconds {0};
+        };
+
+        void WorkerMain(u32 index);
+        void Push(Task task);
+        bool TryRunOne(i32 workerIndex);
+        bool TryPop(u32 workerIndex, Task& task);
+        bool TrySteal(i32 thiefIndex, Task& task);
+        void Run(Task& task, i32 workerIndex);
+
+        vector<unique_ptr<Worker>> mWorkers;
+        std::atomic<u32> mNextWorker {0};
+        std::atomic<u32> mQueuedTasks {0};
+        std::atomic<u64> mCompletions {0};
+        std::atomic<bool> mShutdown {false};
+
+        std::mutex mSleepMutex;
+        std::condition_variable mWakeCondition;
+
+        JobCounter mFrameCounter;
+        f64 mStatsStart {0.0};
+    };
+
+    /**
+     * @brief Set of jobs with dependencies between them, run on a JobSystem.
+     *
+     * A task is scheduled as soon as every task it depends on has finished. Dependencies must refer to tasks added
+     * earlier, which makes cycles impossible.
+     */
+    class TaskGraph {
+    public:
+        using TaskId = u32;
+
+        TaskId Add(Job job, std::initializer_list<TaskId> dependencies = {});
+
+        /// @brief Run every task and block until the graph completed. The graph can be run again afterwards.
+        void Run(JobSystem& jobs);
+
+        void Clear();
+
+    private:
+        struct Node {
+            Job job;
+            vector<TaskId> dependents;
+            u32 dependencyCount {0};
+            std::atomic<u32> remaining {0};
+
+            Node() = default;
+            Node(Node&& other) noexcept
+                : job(std::move(other.job)), dependents(std::move(other.dependents)),
+                  dependencyCount(other.dependencyCount) {}
+        };
+
+        void Launch(JobSystem& jobs, TaskId id, JobCounter& counter);
+
+        vector<Node> mNodes;
+    };
+}  // namespace X
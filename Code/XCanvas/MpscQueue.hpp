@@ -0,0 +1,64 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+
+#include <atomic>
+
+namespace X {
+    /**
+     * @brief Unbounded lock-free multi-producer/single-consumer queue (Vyukov's intrusive node design).
+     *
+     * Push() is wait-free for producers: one atomic exchange plus a store. TryPop() must only be called from a
+     * single consumer thread. An item whose producer is between those two steps may be reported as not yet
+     * available; it shows up on a later TryPop().
+     */
+    template<typename T>
+    class MpscQueue {
+    public:
+        MpscQueue() = default;
+
+        ~MpscQueue() {
+            T discarded;
+            while (TryPop(discarded)) {}
+            if (mTail != &mStub) { delete mTail; }
+        }
+
+        MpscQueue(const MpscQueue&)            = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        void Push(T value) {
+            auto* node  = new Node;
+            node->value = std::move(value);
+
+            Node* previous = mHead.exchange(node, std::memory_order_acq_rel);
+            previous->next.store(node, std::memory_order_release);
+        }
+
+        bool TryPop(T& value) {
+            Node* tail = mTail;
+            Node* next = tail->next.load(std::memory_order_acquire);
+            if (!next) return false;
+
+            // The popped node stays behind as the new sentinel
+            value = std::move(next->value);
+            mTail = next;
+            if (tail != &mStub) { delete tail; }
+
+            return true;
+        }
+
+    private:
+        struct Node {
+            std::atomic<Node*> next {nullptr};
+            T value {};
+        };
+
+        Node mStub;
+        alignas(64) std::atomic<Node*> mHead {&mStub};
+        alignas(64) Node* mTail {&mStub};
+    };
+}  // namespace X
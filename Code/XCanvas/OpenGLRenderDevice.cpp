@@ -0,0 +1,197 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "OpenGLRenderDevice.hpp"
+#include "Shaders.hpp"
+
+#include <iostream>
+#include <cmath>
+#include <cstddef>
+
+namespace X {
+    OpenGLRenderDevice::OpenGLRenderDevice() {
+        InitShaders();
+        SetupBuffers();
+    }
+
+    OpenGLRenderDevice::~OpenGLRenderDevice() {
+        DestroyBackBuffer();
+        glDeleteVertexArrays(1, &mVAO);
+        glDeleteBuffers(1, &mVBO);
+        glDeleteProgram(mShaderProgram);
+    }
+
+    void OpenGLRenderDevice::Clear(const Color& color, u32, u32) {
+        if (mShaderProgram == 0) { std::cout << "Canvas::Clear() - No currently bound shader program\n"; }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, mOutputFramebuffer);
+        glClearColor(color.R(), color.G(), color.B(), color.A());
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    void OpenGLRenderDevice::Submit(const RenderFrame& frame) {
+        const auto width  = CAST<GLint>(frame.width);
+        const auto height = CAST<GLint>(frame.height);
+
+        glUseProgram(mShaderProgram);
+        glBindVertexArray(mVAO);
+        if (frame.vertexCount > 0) {
+            glUniform2f(mViewportLocation, (f32)frame.width, (f32)frame.height);
+
+            // Orphan the previous frame's storage so the upload doesn't wait on in-flight draws
+            const auto size = CAST<GLsizeiptr>(frame.vertexCount * sizeof(Vertex));
+            glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+            glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, size, frame.vertices);
+        }
+
+        // Canvas relies on painter's order, never on the depth buffer
+        glDisable(GL_DEPTH_TEST);
+        glBindFramebuffer(GL_FRAMEBUFFER, mOutputFramebuffer);
+        glViewport(0, 0, width, height);
+
+        const Color* clearColor = frame.clearColor;
+        if (!frame.damage) {
+            // Damage tracking is off, the back buffer won't be needed again until it's turned back on
+            DestroyBackBuffer();
+
+            if (clearColor) {
+                glClearColor(clearColor->R(), clearColor->G(), clearColor->B(), clearColor->A());
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            }
+            DrawBatches(*frame.batches);
+        } else {
+            EnsureBackBuffer(frame.width, frame.height);
+            glBindFramebuffer(GL_FRAMEBUFFER, mBackBuffer);
+            glViewport(0, 0, width, height);
+            glEnable(GL_SCISSOR_TEST);
+            if (clearColor) { glClearColor(clearColor->R(), clearColor->G(), clearColor->B(), clearColor->A()); }
+            for (const auto& region : *frame.damage) {
+                // GL scissor origin is bottom-left
+                const auto x0 = (GLint)std::floor(region.left);
+                const auto y0 = (GLint)std::floor((f32)frame.height - region.bottom);
+                const auto x1 = (GLint)std::ceil(region.right);
+                const auto y1 = (GLint)std::ceil((f32)frame.height - region.top);
+                glScissor(x0, y0, x1 - x0, y1 - y0);
+
+                if (clearColor) { glClear(GL_COLOR_BUFFER_BIT); }
+                DrawBatches(*frame.batches);
+            }
+            glDisable(GL_SCISSOR_TEST);
+
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, mBackBuffer);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mOutputFramebuffer);
+            glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            glBindFramebuffer(GL_FRAMEBUFFER, mOutputFramebuffer);
+        }
+
+        glBindVertexArray(0);
+        glUseProgram(0);
+    }
+
+    void OpenGLRenderDevice::DrawBatches(const vector<DrawBatch>& batches) const {
+        for (const auto& batch : batches) {
+            if (batch.blend == BlendMode::Opaque) {
+                glDisable(GL_BLEND);
+            } else {
+                glEnable(GL_BLEND);
+            }
+            glDrawArrays(batch.pipeline == Pipeline::Triangles ? GL_TRIANGLES : GL_LINES,
+                         (GLint)batch.firstVertex,
+                         (GLsizei)batch.vertexCount);
+        }
+        glEnable(GL_BLEND);
+    }
+
+    void OpenGLRenderDevice::EnsureBackBuffer(u32 width, u32 height) {
+        if (mBackBuffer != 0 && mBackBufferWidth == width && mBackBufferHeight == height) return;
+        DestroyBackBuffer();
+
+        glGenTextures(1, &mBackBufferTexture);
+        glBindTexture(GL_TEXTURE_2D, mBackBufferTexture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, (GLsizei)width, (GLsizei)height);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &mBackBuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, mBackBuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mBackBufferTexture, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Canvas back buffer is incomplete\n";
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        mBackBufferWidth  = width;
+        mBackBufferHeight = height;
+    }
+
+    void OpenGLRenderDevice::DestroyBackBuffer() {
+        if (mBackBuffer != 0) { glDeleteFramebuffers(1, &mBackBuffer); }
+        if (mBackBufferTexture != 0) { glDeleteTextures(1, &mBackBufferTexture); }
+        mBackBuffer        = 0;
+        mBackBufferTexture = 0;
+        mBackBufferWidth   = 0;
+        mBackBufferHeight  = 0;
+    }
+
+    void OpenGLRenderDevice::InitShaders() {
+        const GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertexShader, 1, &Shaders::kVertexShaderSource, nullptr);
+        glCompileShader(vertexShader);
+
+        GLint success;
+        glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            char infoLog[512];
+            glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
+            std::cerr << "Vertex shader compilation failed:\n" << infoLog << std::endl;
+        }
+
+        const GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragmentShader, 1, &Shaders::kFragmentShaderSource, nullptr);
+        glCompileShader(fragmentShader);
+
+        glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            char infoLog[512];
+            glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
+            std::cerr << "Fragment shader compilation failed:\n" << infoLog << std::endl;
+        }
+
+        mShaderProgram = glCreateProgram();
+        glAttachShader(mShaderProgram, vertexShader);
+        glAttachShader(mShaderProgram, fragmentShader);
+        glLinkProgram(mShaderProgram);
+
+        glGetProgramiv(mShaderProgram, GL_LINK_STATUS, &success);
+        if (!success) {
+            char infoLog[512];
+            glGetProgramInfoLog(mShaderProgram, 512, nullptr, infoLog);
+            std::cerr << "Shader program linking failed:\n" << infoLog << std::endl;
+        }
+
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+
+        mViewportLocation = glGetUniformLocation(mShaderProgram, "uViewport");
+    }
+
+    void OpenGLRenderDevice::SetupBuffers() {
+        glGenVertexArrays(1, &mVAO);
+        glGenBuffers(1, &mVBO);
+
+        glBindVertexArray(mVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+
+        // Position attribute
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, x));
+        glEnableVertexAttribArray(0);
+
+        // Color attribute, packed RGBA8
+        glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, color));
+        glEnableVertexAttribArray(1);
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+}  // namespace X
@@ -0,0 +1,55 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include "RenderDevice.hpp"
+
+namespace X {
+    /**
+     * @brief Draws Canvas frames through the current OpenGL context, one glDrawArrays per batch.
+     *
+     * Frames with damage regions repaint just those regions under glScissor into a persistent offscreen buffer,
+     * which is then copied whole to the output; the window's back buffer is undefined after a swap so it can't hold
+     * the previous frame itself.
+     */
+    class OpenGLRenderDevice final : public RenderDevice {
+    public:
+        OpenGLRenderDevice();
+        ~OpenGLRenderDevice() override;
+
+        X_ND CanvasBackend GetBackend() const override {
+            return CanvasBackend::OpenGL;
+        }
+
+        void Clear(const Color& color, u32 width, u32 height) override;
+        void Submit(const RenderFrame& frame) override;
+
+        /// @brief Framebuffer that frames end up in, 0 (the window) by default
+        void SetOutputFramebuffer(const GLuint framebuffer) {
+            mOutputFramebuffer = framebuffer;
+        }
+
+    private:
+        void InitShaders();
+        void SetupBuffers();
+        void DrawBatches(const vector<DrawBatch>& batches) const;
+        void EnsureBackBuffer(u32 width, u32 height);
+        void DestroyBackBuffer();
+
+        GLuint mOutputFramebuffer {0};
+        GLuint mBackBuffer {0};
+        GLuint mBackBufferTexture {0};
+        u32 mBackBufferWidth {0};
+        u32 mBackBufferHeight {0};
+
+        GLuint mShaderProgram {0};
+        GLuint mVAO {0};
+        GLuint mVBO {0};
+
+        GLint mViewportLocation {0};
+    };
+}  // namespace X
@@ -0,0 +1,62 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+
+namespace X {
+    /// @brief Axis-aligned rectangle in screen space, stored as edges rather than origin/extent
+    struct Rect {
+        f32 left {0.0f};
+        f32 top {0.0f};
+        f32 right {0.0f};
+        f32 bottom {0.0f};
+
+        Rect() = default;
+        Rect(f32 left, f32 top, f32 right, f32 bottom) : left(left), top(top), right(right), bottom(bottom) {}
+
+        static Rect FromSize(f32 x, f32 y, f32 width, f32 height) {
+            return {X_MIN(x, x + width), X_MIN(y, y + height), X_MAX(x, x + width), X_MAX(y, y + height)};
+        }
+
+        X_ND f32 Width() const {
+            return right - left;
+        }
+
+        X_ND f32 Height() const {
+            return bottom - top;
+        }
+
+        X_ND bool IsEmpty() const {
+            return right <= left || bottom <= top;
+        }
+
+        X_ND bool Overlaps(const Rect& other) const {
+            return left < other.right && other.left < right && top < other.bottom && other.top < bottom;
+        }
+
+        X_ND bool Contains(const Rect& other) const {
+            return left <= other.left && top <= other.top && right >= other.right && bottom >= other.bottom;
+        }
+
+        X_ND Rect Union(const Rect& other) const {
+            return {X_MIN(left, other.left),
+                    X_MIN(top, other.top),
+                    X_MAX(right, other.right),
+                    X_MAX(bottom, other.bottom)};
+        }
+
+        X_ND Rect Intersect(const Rect& other) const {
+            return {X_MAX(left, other.left),
+                    X_MAX(top, other.top),
+                    X_MIN(right, other.right),
+                    X_MIN(bottom, other.bottom)};
+        }
+
+        X_ND Rect Inflate(f32 amount) const {
+            return {left - amount, top - amount, right + amount, bottom + amount};
+        }
+    };
+}  // namespace X
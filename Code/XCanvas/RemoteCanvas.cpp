@@ -0,0 +1,439 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "RemoteCanvas.hpp"
+#include "Clock.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+namespace X {
+    // A record claiming to be larger than this is taken as damage rather than buffered
+    static constexpr size_t kMaxRecordSize = 1ull << 30;
+    // Free space the receive buffer is grown to before each read
+    static constexpr size_t kReceiveChunk = 64 * 1024;
+
+    // Socket plumbing. Unix domain sockets are POSIX only here; on Windows these fail and report why.
+#if !defined(_WIN32)
+    #if defined(MSG_NOSIGNAL)
+    static constexpr i32 kSendFlags = MSG_NOSIGNAL;
+    #else
+    static constexpr i32 kSendFlags = 0;  // SO_NOSIGPIPE is set on the socket instead
+    #endif
+
+    static i32 CreateSocket(const string& path, sockaddr_un& address) {
+        if (path.size() >= sizeof(address.sun_path)) {
+            errno = ENAMETOOLONG;
+            return -1;
+        }
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        const i32 fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    #if defined(SO_NOSIGPIPE)
+        const i32 on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+    #endif
+        return fd;
+    }
+
+    static i32 ConnectSocket(const string& path) {
+        sockaddr_un address {};
+        const i32 fd = CreateSocket(path, address);
+        if (fd < 0) return -1;
+        if (connect(fd, RCAST<const sockaddr*>(&address), sizeof(address)) != 0) {
+            const i32 error = errno;
+            close(fd);
+            errno = error;
+            return -1;
+        }
+        return fd;
+    }
+
+    static i32 ListenSocket(const string& path) {
+        // A socket file left by a server that didn't shut down would make bind() fail
+        struct stat status {};
+        if (stat(path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) { unlink(path.c_str()); }
+
+        sockaddr_un address {};
+        const i32 fd = CreateSocket(path, address);
+        if (fd < 0) return -1;
+        if (bind(fd, RCAST<const sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, 1) != 0) {
+            const i32 error = errno;
+            close(fd);
+            errno = error;
+            return -1;
+        }
+        return fd;
+    }
+
+    static i32 AcceptSocket(i32 listener) {
+        const i32 fd = accept(listener, nullptr, nullptr);
+        if (fd >= 0) { fcntl(fd, F_SETFD, FD_CLOEXEC); }
+        return fd;
+    }
+
+    static void CloseSocket(i32 fd) {
+        close(fd);
+    }
+
+    /// @brief Wait up to @p timeout seconds (negative for ever) for @p fd to become readable
+    static bool WaitReadable(i32 fd, f64 timeout) {
+        pollfd entry {fd, POLLIN, 0};
+        const i32 milliseconds = timeout < 0.0 ? -1 : CAST<i32>(timeout * 1000.0 + 0.999);
+        i32 result;
+        do {
+            result = poll(&entry, 1, milliseconds);
+        } while (result < 0 && errno == EINTR);
+        return result > 0;
+    }
+
+    static bool SendAll(i32 fd, const u8* data, size_t size) {
+        while (size > 0) {
+            const ssize_t sent = send(fd, data, size, kSendFlags);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += sent;
+            size -= CAST<size_t>(sent);
+        }
+        return true;
+    }
+
+    /// @brief Read what is available without blocking. Returns the bytes read, 0 if none, -1 on EOF or error.
+    static i64 ReceiveAvailable(i32 fd, u8* data, size_t size) {
+        while (true) {
+            const ssize_t received = recv(fd, data, size, MSG_DONTWAIT);
+            if (received > 0) return received;
+            if (received == 0) return -1;
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+        }
+    }
+#else
+    static i32 ConnectSocket(const string&) {
+        errno = ENOSYS;
+        return -1;
+    }
+
+    static i32 ListenSocket(const string&) {
+        errno = ENOSYS;
+        return -1;
+    }
+
+    static i32 AcceptSocket(i32) {
+        return -1;
+    }
+
+    static void CloseSocket(i32) {}
+
+    static bool WaitReadable(i32, f64) {
+        return false;
+    }
+
+    static bool SendAll(i32, const u8*, size_t) {
+        return false;
+    }
+
+    static i64 ReceiveAvailable(i32, u8*, size_t) {
+        return -1;
+    }
+#endif
+
+    RemoteCanvas::RemoteCanvas(u32 width, u32 height)
+        : mWidth(width), mHeight(height), mEncoder(kGeometryCacheSlots) {
+        if (!CanvasFrame::IsValidSize(width, height)) { throw std::invalid_argument("Invalid remote canvas size"); }
+        SetTarget(nullptr);
+    }
+
+    RemoteCanvas::~RemoteCanvas() {
+        Disconnect();
+    }
+
+    bool RemoteCanvas::Connect(const string& socketPath) {
+        Disconnect();
+
+        const i32 fd = ConnectSocket(socketPath);
+        if (fd < 0) {
+            std::cerr << "Failed to connect to remote canvas at " << socketPath << ": " << std::strerror(errno) << '\n';
+            return false;
+        }
+
+        // A new connection starts with an empty geometry cache and color table on both ends
+        mSocket         = fd;
+        mEncoder        = CommandStreamEncoder(kGeometryCacheSlots);
+        mFramesInFlight = 0;
+        mFrameStarted   = false;
+        mRecord.clear();
+        CommandStreamEncoder::WriteHeader(mRecord);
+        if (!SendAll(mSocket, mRecord.data(), mRecord.size())) {
+            std::cerr << "Failed to connect to remote canvas at " << socketPath << ": " << std::strerror(errno) << '\n';
+            Disconnect();
+            return false;
+        }
+        return true;
+    }
+
+    void RemoteCanvas::Disconnect() {
+        if (mSocket < 0) return;
+        CloseSocket(mSocket);
+        mSocket = -1;
+    }
+
+    void RemoteCanvas::Clear(const Color& clearColor) {
+        // Everything recorded so far would be painted over, drop it
+        if (mRecording) { mQueue.Reset(); }
+        mClearColor   = clearColor;
+        mClearPending = true;
+    }
+
+    void RemoteCanvas::Resize(u32 width, u32 height) {
+        if (!CanvasFrame::IsValidSize(width, height)) return;
+        mWidth  = width;
+        mHeight = height;
+    }
+
+    void RemoteCanvas::Begin() {
+        mQueue.Reset();
+        mRecording = true;
+        SetTarget(&mQueue);
+    }
+
+    void RemoteCanvas::End() {
+        mRecording = false;
+        SetTarget(nullptr);
+
+        if (!IsConnected()) {
+            mFrameStarted = false;
+            ++mStats.framesDropped;
+            return;
+        }
+        // Once part of the frame is out the rest has to follow, credit or not
+        if (!mFrameStarted && !AcquireCredit(!mDropWhenBusy)) {
+            ++mStats.framesDropped;
+            return;
+        }
+        SendRecord(true);
+    }
+
+    void RemoteCanvas::Execute(const CommandList& list) {
+        X_ASSERT(mRecording, "RemoteCanvas::Execute() must be called between Begin() and End()");
+        Append(list.GetQueue());
+    }
+
+    bool RemoteCanvas::OnQueueFull() {
+        // Send what fits as the first part of the frame
+        if (IsConnected() && (mFrameStarted || AcquireCredit(true))) { SendRecord(false); }
+        mQueue.Reset();
+        return true;
+    }
+
+    bool RemoteCanvas::AcquireCredit(bool wait) {
+        ReadCredits(false);
+        if (mFramesInFlight < mMaxFramesInFlight) return true;
+        if (!wait) return false;
+
+        const f64 start = Clock::Now();
+        while (IsConnected() && mFramesInFlight >= mMaxFramesInFlight) {
+            ReadCredits(true);
+        }
+        mStats.blockedTime += Clock::Now() - start;
+        return IsConnected();
+    }
+
+    void RemoteCanvas::ReadCredits(bool wait) {
+        // The renderer sends one byte per executed frame
+        u8 credits[64];
+        if (wait) { WaitReadable(mSocket, -1.0); }
+        while (IsConnected()) {
+            const i64 received = ReceiveAvailable(mSocket, credits, sizeof(credits));
+            if (received == 0) return;
+            if (received < 0) {
+                std::cerr << "Remote canvas renderer disconnected\n";
+                Disconnect();
+                return;
+            }
+            mFramesInFlight -= X_MIN(CAST<u32>(received), mFramesInFlight);
+        }
+    }
+
+    bool RemoteCanvas::SendRecord(bool complete) {
+        mRecord.clear();
+        mEncoder.Encode(mQueue, mWidth, mHeight, mClearPending ? &mClearColor : nullptr, complete, mRecord);
+        mClearPending = false;
+
+        if (!SendAll(mSocket, mRecord.data(), mRecord.size())) {
+            std::cerr << "Remote canvas connection lost: " << std::strerror(errno) << '\n';
+            Disconnect();
+            mFrameStarted = false;
+            ++mStats.framesDropped;
+            return false;
+        }
+
+        mStats.commandsSent += mQueue.GetCount();
+        mStats.commandsCached += mEncoder.GetCachedCount();
+        mStats.bytesSent += mRecord.size();
+        mFrameStarted = !complete;
+        if (complete) {
+            ++mStats.framesSent;
+            ++mFramesInFlight;
+        }
+        return true;
+    }
+
+    RemoteCanvasServer::RemoteCanvasServer(const string& socketPath) : mPath(socketPath) {
+        mListener = ListenSocket(socketPath);
+        if (mListener < 0) {
+            throw std::runtime_error("Failed to listen for remote canvases on " + socketPath + ": " +
+                                     std::strerror(errno));
+        }
+    }
+
+    RemoteCanvasServer::~RemoteCanvasServer() {
+        CloseConnection(nullptr);
+        CloseSocket(mListener);
+#if !defined(_WIN32)
+        unlink(mPath.c_str());
+#endif
+    }
+
+    bool RemoteCanvasServer::WaitForFrame(f64 timeout) {
+        const f64 deadline = Clock::Now() + timeout;
+        while (!IsConnected() || !FindFrame()) {
+            const f64 remaining = X_MAX(deadline - Clock::Now(), 0.0);
+            if (!(IsConnected() ? Receive(remaining) : Accept(remaining))) return false;
+        }
+        return true;
+    }
+
+    void RemoteCanvasServer::ExecuteFrame(FrameTarget& canvas) {
+        X_ASSERT(IsConnected() && mFrameEnd > mBegin, "RemoteCanvasServer::ExecuteFrame() without a frame");
+        if (!IsConnected() || mFrameEnd <= mBegin) return;
+
+        // Records were split off by FindFrame()
+        bool intact = true;
+        canvas.Begin();
+        for (size_t offset = mBegin; offset < mFrameEnd && intact;) {
+            size_t size = 0;
+            CommandStreamDecoder::ReadRecordSize(mBuffer.data() + offset, mFrameEnd - offset, size);
+            intact = mDecoder->Replay(mBuffer.data() + offset, size, canvas);
+            offset += size;
+        }
+        canvas.End();
+        mBegin = mFrameEnd;
+        ++mFramesExecuted;
+
+        if (!intact) {
+            CloseConnection("sent a damaged frame");
+            return;
+        }
+        // A producer that left may still have whole frames in the buffer; Receive() notices once they are executed
+        const u8 credit = 1;
+        SendAll(mConnection, &credit, 1);
+    }
+
+    bool RemoteCanvasServer::Accept(f64 timeout) {
+        if (!WaitReadable(mListener, timeout)) return false;
+
+        const i32 fd = AcceptSocket(mListener);
+        if (fd < 0) return false;
+
+        mConnection = fd;
+        mDecoder    = make_unique<CommandStreamDecoder>(RemoteCanvas::kGeometryCacheSlots);
+        mBegin      = 0;
+        mEnd        = 0;
+        mHeaderRead = false;
+        return true;
+    }
+
+    bool RemoteCanvasServer::Receive(f64 timeout) {
+        if (!WaitReadable(mConnection, timeout)) return false;
+
+        if (mBuffer.size() - mEnd < kReceiveChunk) {
+            // Move the unconsumed bytes to the front before growing. The buffer starts out empty, with no storage.
+            if (mBegin > 0) {
+                std::memmove(mBuffer.data(), mBuffer.data() + mBegin, mEnd - mBegin);
+                mEnd -= mBegin;
+                mBegin = 0;
+            }
+            if (mBuffer.size() - mEnd < kReceiveChunk) { mBuffer.resize(X_MAX(mBuffer.size() * 2, kReceiveChunk)); }
+        }
+
+        const i64 received = ReceiveAvailable(mConnection, mBuffer.data() + mEnd, mBuffer.size() - mEnd);
+        if (received < 0) {
+            CloseConnection(nullptr);
+        } else {
+            mEnd += CAST<size_t>(received);
+        }
+        return true;
+    }
+
+    bool RemoteCanvasServer::FindFrame() {
+        if (!mHeaderRead) {
+            if (mEnd - mBegin < CommandStreamDecoder::kHeaderSize) return false;
+            if (!CommandStreamDecoder::ReadHeader(mBuffer.data() + mBegin, mEnd - mBegin)) {
+                CloseConnection("is not a compatible remote canvas");
+                return false;
+            }
+            mBegin += CommandStreamDecoder::kHeaderSize;
+            mHeaderRead = true;
+        }
+
+        // Walk the record headers up to one that completes a frame
+        for (size_t offset = mBegin; offset < mEnd;) {
+            size_t size            = 0;
+            const u8* record       = mBuffer.data() + offset;
+            const size_t available = mEnd - offset;
+            if (!CommandStreamDecoder::ReadRecordSize(record, available, size)) {
+                // A size prefix is at most 10 bytes
+                if ((size == 0 && available >= 10) || size > kMaxRecordSize) {
+                    CloseConnection("sent a damaged record");
+                }
+                return false;
+            }
+
+            CommandRecordInfo info;
+            if (!CommandStreamDecoder::ReadRecordInfo(record, size, info)) {
+                CloseConnection("sent a damaged record");
+                return false;
+            }
+            if (offset == mBegin) {
+                mFrameWidth  = info.width;
+                mFrameHeight = info.height;
+            }
+            offset += size;
+            if (!info.continues) {
+                mFrameEnd = offset;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void RemoteCanvasServer::CloseConnection(const char* reason) {
+        if (mConnection < 0) return;
+        if (reason) { std::cerr << "Remote canvas producer " << reason << ", disconnecting\n"; }
+        CloseSocket(mConnection);
+        mConnection = -1;
+        mDecoder.reset();
+        mBegin    = 0;
+        mEnd      = 0;
+        mFrameEnd = 0;
+    }
+}  // namespace X
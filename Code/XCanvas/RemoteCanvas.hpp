@@ -0,0 +1,198 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+#include "Color.hpp"
+#include "CommandList.hpp"
+#include "CommandStream.hpp"
+
+namespace X {
+
+    /**
+     * @brief Canvas that draws in another process, streaming its frames over a Unix domain socket.
+     *
+     * Frames are recorded like on a Canvas and End() sends each as one command stream record (see
+     * CommandStreamEncoder) in a single write, with a geometry cache so that what didn't change since the previous
+     * frame costs a few bytes. Nothing here touches a graphics API, so the producer needs no context or window; the
+     * renderer process runs a RemoteCanvasServer, for example through Application::ServeRemoteCanvas().
+     *
+     * Flow control is credit based: the renderer acknowledges every frame it executed, and at most
+     * SetMaxFramesInFlight() frames may be unacknowledged. That keeps the socket busy while the renderer works on
+     * earlier frames without letting the producer run arbitrarily far ahead. When no credit is left End() waits for
+     * one, or with SetDropWhenBusy() skips the frame.
+     */
+    class RemoteCanvas : protected CommandList {
+    public:
+        using CommandList::DrawCircle;
+        using CommandList::DrawLine;
+        using CommandList::DrawPolygon;
+        using CommandList::DrawRectangle;
+        using CommandList::SetFillColor;
+        using CommandList::SetStrokeColor;
+        using CommandList::SetStrokeWidth;
+
+        /// @brief Slots in the geometry cache on both ends of the connection
+        static constexpr u32 kGeometryCacheSlots = 4096;
+
+        struct Stats {
+            u64 framesSent {0};
+            u64 framesDropped {0};  // Skipped for lack of credit or a connection
+            u64 commandsSent {0};
+            u64 commandsCached {0};  // Of those, sent as geometry cache references
+            u64 bytesSent {0};
+            f64 blockedTime {0.0};  // Seconds End() spent waiting for credit
+        };
+
+        /// @brief Throws std::invalid_argument unless both sides are between 1 and CanvasFrame::kMaxSize
+        RemoteCanvas(u32 width, u32 height);
+        ~RemoteCanvas() override;
+
+        RemoteCanvas(const RemoteCanvas&)            = delete;
+        RemoteCanvas& operator=(const RemoteCanvas&) = delete;
+
+        /// @brief Connect to the RemoteCanvasServer listening at @p socketPath. Reports failures to stderr.
+        bool Connect(const string& socketPath);
+        void Disconnect();
+
+        X_ND bool IsConnected() const {
+            return mSocket >= 0;
+        }
+
+        /// @brief Clear the frame being recorded or, outside Begin() and End(), the next one
+        void Clear(const Color& clearColor = Colors::Black);
+        /// @brief Ignores sizes the constructor would reject
+        void Resize(u32 width, u32 height);
+
+        void Begin();
+        void End();
+
+        /// @brief Append pre-recorded commands to the current frame, as if drawn here at this point
+        void Execute(const CommandList& list);
+
+        /// @brief Frames sent but not yet executed by the renderer before End() waits or drops (2 by default)
+        void SetMaxFramesInFlight(u32 frames) {
+            mMaxFramesInFlight = X_MAX(frames, 1u);
+        }
+
+        /// @brief Skip frames instead of waiting when the renderer is behind (off by default)
+        void SetDropWhenBusy(const bool enabled) {
+            mDropWhenBusy = enabled;
+        }
+
+        X_ND u32 GetWidth() const {
+            return mWidth;
+        }
+
+        X_ND u32 GetHeight() const {
+            return mHeight;
+        }
+
+        X_ND const Stats& GetStats() const {
+            return mStats;
+        }
+
+    protected:
+        bool OnQueueFull() override;
+
+    private:
+        bool SendRecord(bool complete);
+        /// @brief Make room for another frame in flight. Returns false if there is none and @p wait is false.
+        bool AcquireCredit(bool wait);
+        /// @brief Collect the renderer's acknowledgements, waiting for some if @p wait
+        void ReadCredits(bool wait);
+
+        u32 mWidth;
+        u32 mHeight;
+        CommandQueue mQueue;
+        Color mClearColor {Colors::Black};
+        bool mClearPending {false};
+        bool mRecording {false};
+        bool mFrameStarted {false};  // Part of the frame went out early, so the rest must follow
+
+        i32 mSocket {-1};
+        CommandStreamEncoder mEncoder;
+        vector<u8> mRecord;  // Reused across frames
+        u32 mFramesInFlight {0};
+        u32 mMaxFramesInFlight {2};
+        bool mDropWhenBusy {false};
+        Stats mStats;
+    };
+
+    /// @brief Frames drawn in another process, painted by Application::ServeRemoteCanvas() and ServeSharedCanvas()
+    class RemoteFrameSource {
+    public:
+        virtual ~RemoteFrameSource() = default;
+
+        /// @brief Wait up to @p timeout seconds for a frame to arrive
+        virtual bool WaitForFrame(f64 timeout) = 0;
+
+        /// @brief Size of the canvas the frame WaitForFrame() found was drawn on
+        X_ND virtual u32 GetFrameWidth() const = 0;
+        X_ND virtual u32 GetFrameHeight() const = 0;
+
+        /// @brief Execute the frame WaitForFrame() found on @p canvas, Begin() to End()
+        virtual void ExecuteFrame(FrameTarget& canvas) = 0;
+    };
+
+    /**
+     * @brief Renderer end of RemoteCanvas: listens on a Unix domain socket and executes the frames it receives.
+     *
+     * One producer is served at a time; when it disconnects the server waits for the next. Received bytes are
+     * decoded in place from a reusable buffer, and every executed frame is acknowledged so the producer may send
+     * another. Frames are executed in order, never skipped, since each one updates the geometry cache.
+     */
+    class RemoteCanvasServer final : public RemoteFrameSource {
+    public:
+        /// @brief Throws std::runtime_error if @p socketPath can't be listened on. Replaces a stale socket file.
+        explicit RemoteCanvasServer(const string& socketPath);
+        ~RemoteCanvasServer() override;
+
+        RemoteCanvasServer(const RemoteCanvasServer&)            = delete;
+        RemoteCanvasServer& operator=(const RemoteCanvasServer&) = delete;
+
+        /// @brief Wait up to @p timeout seconds for a whole frame to arrive, accepting a producer if needed
+        bool WaitForFrame(f64 timeout) override;
+
+        X_ND u32 GetFrameWidth() const override {
+            return mFrameWidth;
+        }
+
+        X_ND u32 GetFrameHeight() const override {
+            return mFrameHeight;
+        }
+
+        /// @brief Execute the frame WaitForFrame() found on @p canvas (Begin() to End()) and acknowledge it
+        void ExecuteFrame(FrameTarget& canvas) override;
+
+        X_ND bool IsConnected() const {
+            return mConnection >= 0;
+        }
+
+        X_ND u64 GetFramesExecuted() const {
+            return mFramesExecuted;
+        }
+
+    private:
+        bool Accept(f64 timeout);
+        bool Receive(f64 timeout);
+        /// @brief Whether the buffer holds a whole frame; sets mFrameEnd
+        bool FindFrame();
+        void CloseConnection(const char* reason);
+
+        string mPath;
+        i32 mListener {-1};
+        i32 mConnection {-1};
+        unique_ptr<CommandStreamDecoder> mDecoder;  // Recreated per connection, the cache starts empty
+        vector<u8> mBuffer;
+        size_t mBegin {0};     // Unconsumed bytes are [mBegin, mEnd)
+        size_t mEnd {0};
+        size_t mFrameEnd {0};  // Of the frame FindFrame() found
+        bool mHeaderRead {false};
+        u32 mFrameWidth {0};
+        u32 mFrameHeight {0};
+        u64 mFramesExecuted {0};
+    };
+}  // namespace X
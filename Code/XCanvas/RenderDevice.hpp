@@ -0,0 +1,69 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+#include "Color.hpp"
+#include "Image.hpp"
+#include "JobSystem.hpp"
+#include "Rect.hpp"
+#include "Tessellator.hpp"
+
+namespace X {
+    /// @brief Where a Canvas executes its frames
+    enum class CanvasBackend : u8 {
+        OpenGL,    ///< The current GL context, into the window or SetOutputFramebuffer()
+        Software,  ///< SoftwareRasterizer into an in-memory image (Canvas::GetImage()), no GL context needed
+        Null,      ///< NullRenderDevice, which discards every frame. Measures Canvas without any draw cost.
+    };
+
+    /// @brief One executed Canvas frame, already culled, sorted, batched and tessellated
+    struct RenderFrame {
+        u32 width {0};
+        u32 height {0};
+        const Vertex* vertices {nullptr};
+        u32 vertexCount {0};
+        const vector<DrawBatch>* batches {nullptr};
+        const vector<Rect>* damage {nullptr};  // Regions to repaint over the previous frame, nullptr for all of it
+        const Color* clearColor {nullptr};     // Cleared to before drawing, nullptr to draw over what's there
+        JobSystem* jobs {nullptr};             // Optional pool for devices that render on the CPU
+    };
+
+    /**
+     * @brief What Canvas draws through, below command recording, sorting and tessellation.
+     *
+     * A device is created and used on the thread that executes Canvas frames, the GL context thread for
+     * OpenGLRenderDevice.
+     */
+    class RenderDevice {
+    public:
+        virtual ~RenderDevice() = default;
+
+        X_ND virtual CanvasBackend GetBackend() const = 0;
+
+        /// @brief Clear the whole @p width x @p height output right away, outside of any frame
+        virtual void Clear(const Color& color, u32 width, u32 height) = 0;
+
+        /// @brief Draw @p frame. Pixels outside its damage regions must keep their previous contents.
+        virtual void Submit(const RenderFrame& frame) = 0;
+
+        /// @brief The last submitted frame for devices that render into memory, nullptr for the rest
+        X_ND virtual const Image* GetImage() const {
+            return nullptr;
+        }
+    };
+
+    /// @brief Accepts and discards every frame, leaving only the cost of recording and tessellating it
+    class NullRenderDevice final : public RenderDevice {
+    public:
+        X_ND CanvasBackend GetBackend() const override {
+            return CanvasBackend::Null;
+        }
+
+        void Clear(const Color&, u32, u32) override {}
+
+        void Submit(const RenderFrame&) override {}
+    };
+}  // namespace X
@@ -5,20 +5,28 @@
 #pragma once
 
 namespace X::Shaders {
-    const char* kVertexShaderSource = R""(#version 460 core
+    const char* kVertexShaderSource = R""(#version 450 core
 layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec4 aColor;
+
+uniform vec2 uViewport;
+
+out vec4 vColor;
 
 void main() {
-    gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0);
+    // Screen space (origin top-left) to clip space
+    vec2 clip   = vec2(2.0 * aPos.x / uViewport.x - 1.0, 1.0 - 2.0 * aPos.y / uViewport.y);
+    gl_Position = vec4(clip, 0.0, 1.0);
+    vColor      = aColor;
 }
     )"";
 
-    const char* kFragmentShaderSource = R""(#version 460 core
+    const char* kFragmentShaderSource = R""(#version 450 core
+in vec4 vColor;
 out vec4 FragColor;
-uniform vec4 uColor;
 
 void main() {
-    FragColor = uColor;
+    FragColor = vColor;
 }
     )"";
 } // X
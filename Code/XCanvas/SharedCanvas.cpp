@@ -0,0 +1,544 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "SharedCanvas.hpp"
+#include "Clock.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <signal.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+#if defined(__linux__)
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+#endif
+
+namespace X {
+    static constexpr u32 kRingMagic   = 0x52434358;  // "XCCR"
+    static constexpr u32 kRingVersion = 1;
+
+    static constexpr u32 kSlotContinues = 1u << 0;  // The frame continues in the next slot
+    static constexpr u32 kSlotClear     = 1u << 1;
+
+    static_assert(std::atomic<u32>::is_always_lock_free && sizeof(std::atomic<u32>) == sizeof(u32),
+                  "Ring counters must be plain words shared between processes");
+    static_assert(std::is_trivially_copyable_v<DrawCommand> && std::is_trivially_copyable_v<Point>,
+                  "Commands are copied into the ring as raw bytes");
+
+    /// @brief Start of the shared memory region, followed by the slots
+    struct SharedRing {
+        u32 magic;
+        u32 version;
+        u32 commandSize;  // sizeof(DrawCommand) and sizeof(Point) of the server's build
+        u32 pointSize;
+        u32 slotCount;
+        u32 slotSize;
+        u32 serverPid;
+        std::atomic<u32> closed;       // Set when the server shuts down
+        std::atomic<u32> producerPid;  // 0 when no producer is attached
+        std::atomic<u32> connection;   // Incremented by every Connect()
+
+        // Each counter is a futex word only its one writer changes; the other side sleeps on it while it says so
+        alignas(64) std::atomic<u32> written;  // Slots published by the producer
+        std::atomic<u32> rendererWaiting;
+        alignas(64) std::atomic<u32> read;  // Slots released by the renderer
+        std::atomic<u32> producerWaiting;
+    };
+
+    struct SlotHeader {
+        u64 submitTime;  // Nanoseconds on the host's monotonic clock
+        u32 connection;
+        u32 width;
+        u32 height;
+        u32 commandCount;  // Followed by the commands, then their points
+        u32 pointCount;
+        u32 clearColor;  // Packed like DrawCommand::color
+        u32 flags;
+    };
+
+    static constexpr size_t kRingHeaderSize = (sizeof(SharedRing) + 63) & ~size_t(63);
+    static constexpr size_t kSlotHeaderSize = (sizeof(SlotHeader) + 15) & ~size_t(15);
+
+    static u8* GetSlot(SharedRing* ring, u32 index) {
+        return RCAST<u8*>(ring) + kRingHeaderSize + CAST<size_t>(index % ring->slotCount) * ring->slotSize;
+    }
+
+    /// @brief Unlike Clock::Now(), which counts from when each process first asked, comparable across processes
+    static u64 GetMonotonicTime() {
+        using namespace std::chrono;
+        return CAST<u64>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Cross-process wakeups. The futex words live in the shared mapping, so the process-private variants (and
+    // std::atomic::wait(), which uses them) can't be used.
+#if defined(__linux__)
+    static void FutexWait(std::atomic<u32>& word, u32 expected, f64 timeout) {
+        timespec relative {};
+        relative.tv_sec  = CAST<time_t>(timeout);
+        relative.tv_nsec = CAST<long>((timeout - CAST<f64>(relative.tv_sec)) * 1e9);
+        syscall(SYS_futex, RCAST<u32*>(&word), FUTEX_WAIT, expected, &relative, nullptr, 0);
+    }
+
+    static void FutexWake(std::atomic<u32>& word) {
+        syscall(SYS_futex, RCAST<u32*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+#else
+    // No cross-process futex here, poll instead
+    static void FutexWait(std::atomic<u32>& word, u32 expected, f64 timeout) {
+        if (word.load() == expected) { std::this_thread::sleep_for(std::chrono::duration<f64>(X_MIN(timeout, 1e-4))); }
+    }
+
+    static void FutexWake(std::atomic<u32>&) {}
+#endif
+
+    // Shared memory plumbing. POSIX only; on Windows these fail and report why.
+#if !defined(_WIN32)
+    static u32 GetProcessId() {
+        return CAST<u32>(getpid());
+    }
+
+    static bool IsProcessAlive(u32 pid) {
+        return kill(CAST<pid_t>(pid), 0) == 0 || errno == EPERM;
+    }
+
+    static void* CreateRegion(const string& name, size_t size) {
+        // A ring left by a server that didn't shut down would make the exclusive create fail
+        shm_unlink(name.c_str());
+        const i32 fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) return nullptr;
+
+        void* memory = MAP_FAILED;
+        if (ftruncate(fd, CAST<off_t>(size)) == 0) {
+            memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        const i32 error = errno;
+        close(fd);
+        if (memory == MAP_FAILED) {
+            shm_unlink(name.c_str());
+            errno = error;
+            return nullptr;
+        }
+        return memory;
+    }
+
+    static void* OpenRegion(const string& name, size_t& size) {
+        const i32 fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) return nullptr;
+
+        struct stat status {};
+        void* memory = MAP_FAILED;
+        if (fstat(fd, &status) == 0) {
+            size   = CAST<size_t>(status.st_size);
+            memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        const i32 error = errno;
+        close(fd);
+        errno = error;
+        return memory == MAP_FAILED ? nullptr : memory;
+    }
+
+    static void UnmapRegion(void* memory, size_t size) {
+        munmap(memory, size);
+    }
+
+    static void RemoveRegion(const string& name) {
+        shm_unlink(name.c_str());
+    }
+#else
+    static u32 GetProcessId() {
+        return 0;
+    }
+
+    static bool IsProcessAlive(u32) {
+        return false;
+    }
+
+    static void* CreateRegion(const string&, size_t) {
+        errno = ENOSYS;
+        return nullptr;
+    }
+
+    static void* OpenRegion(const string&, size_t&) {
+        errno = ENOSYS;
+        return nullptr;
+    }
+
+    static void UnmapRegion(void*, size_t) {}
+
+    static void RemoveRegion(const string&) {}
+#endif
+
+    SharedCanvas::SharedCanvas(u32 width, u32 height) : mWidth(width), mHeight(height) {
+        if (!CanvasFrame::IsValidSize(width, height)) { throw std::invalid_argument("Invalid shared canvas size"); }
+        SetTarget(nullptr);
+    }
+
+    SharedCanvas::~SharedCanvas() {
+        Disconnect();
+    }
+
+    bool SharedCanvas::Connect(const string& name) {
+        Disconnect();
+
+        size_t size = 0;
+        auto* ring  = CAST<SharedRing*>(OpenRegion(name, size));
+        if (!ring) {
+            std::cerr << "Failed to open shared canvas " << name << ": " << std::strerror(errno) << '\n';
+            return false;
+        }
+
+        const char* problem = nullptr;
+        if (size < kRingHeaderSize || ring->magic != kRingMagic || ring->version != kRingVersion ||
+            ring->commandSize != sizeof(DrawCommand) || ring->pointSize != sizeof(Point) ||
+            size < kRingHeaderSize + CAST<size_t>(ring->slotCount) * ring->slotSize) {
+            problem = "is not a compatible shared canvas";
+        } else if (ring->closed.load()) {
+            problem = "was closed by its renderer";
+        } else {
+            // One producer at a time; one that exited without disconnecting doesn't count
+            const u32 self = GetProcessId();
+            u32 owner      = ring->producerPid.load();
+            bool claimed   = false;
+            while (!claimed && (owner == 0 || owner == self || !IsProcessAlive(owner))) {
+                claimed = ring->producerPid.compare_exchange_weak(owner, self);
+            }
+            if (!claimed) { problem = "already has a producer"; }
+        }
+        if (problem) {
+            std::cerr << "Shared canvas " << name << ' ' << problem << '\n';
+            UnmapRegion(ring, size);
+            return false;
+        }
+
+        mRing         = ring;
+        mMappingSize  = size;
+        mConnection   = ring->connection.fetch_add(1) + 1;
+        mFrameStarted = false;
+        return true;
+    }
+
+    void SharedCanvas::Disconnect() {
+        if (!mRing) return;
+        u32 self = GetProcessId();
+        mRing->producerPid.compare_exchange_strong(self, 0);
+        // A renderer waiting for the rest of a frame notices sooner
+        FutexWake(mRing->written);
+        UnmapRegion(mRing, mMappingSize);
+        mRing = nullptr;
+    }
+
+    void SharedCanvas::Clear(const Color& clearColor) {
+        // Everything recorded so far would be painted over, drop it
+        if (mRecording) { mQueue.Reset(); }
+        mClearColor   = clearColor;
+        mClearPending = true;
+    }
+
+    void SharedCanvas::Resize(u32 width, u32 height) {
+        if (!CanvasFrame::IsValidSize(width, height)) return;
+        mWidth  = width;
+        mHeight = height;
+    }
+
+    void SharedCanvas::Begin() {
+        mQueue.Reset();
+        mRecording = true;
+        SetTarget(&mQueue);
+    }
+
+    void SharedCanvas::End() {
+        mRecording = false;
+        SetTarget(nullptr);
+
+        // Once part of the frame is out the rest has to follow. A part OnQueueFull() couldn't send disconnected us,
+        // so the frame is counted as dropped here and only here.
+        if (!IsConnected() || !WriteFrame(true, !mDropWhenBusy || mFrameStarted)) {
+            mFrameStarted = false;
+            ++mStats.framesDropped;
+        }
+    }
+
+    void SharedCanvas::Execute(const CommandList& list) {
+        X_ASSERT(mRecording, "SharedCanvas::Execute() must be called between Begin() and End()");
+        Append(list.GetQueue());
+    }
+
+    bool SharedCanvas::OnQueueFull() {
+        // Send what fits as the first part of the frame
+        if (IsConnected()) { WriteFrame(false, true); }
+        mQueue.Reset();
+        return true;
+    }
+
+    bool SharedCanvas::WriteFrame(bool complete, bool wait) {
+        const u32 count    = mQueue.GetCount();
+        const auto& points = mQueue.GetPoints();
+        const size_t room  = mRing->slotSize - kSlotHeaderSize;
+        u32 next           = 0;
+
+        do {
+            u8* slot = AcquireSlot(wait);
+            if (!slot) return false;
+            wait = true;
+
+            // As many commands as fit along with their points
+            u32 end        = next;
+            u32 pointCount = 0;
+            size_t bytes   = 0;
+            while (true) {
+                for (; end < count; ++end) {
+                    const u32 commandPoints = mQueue.GetCommand(end).pointCount;
+                    const size_t size       = sizeof(DrawCommand) + CAST<size_t>(commandPoints) * sizeof(Point);
+                    if (bytes + size > room) break;
+                    bytes += size;
+                    pointCount += commandPoints;
+                }
+                if (end > next || end == count) break;
+
+                std::cerr << "Shared canvas slots are too small for a polygon of " << mQueue.GetCommand(end).pointCount
+                          << " points, dropping it\n";
+                next = ++end;
+            }
+
+            const u32 written = end - next;
+            auto* header      = RCAST<SlotHeader*>(slot);
+            auto* commands    = RCAST<DrawCommand*>(slot + kSlotHeaderSize);
+            auto* target      = RCAST<Point*>(commands + written);
+            if (written > 0) { std::memcpy(commands, &mQueue.GetCommand(next), written * sizeof(DrawCommand)); }
+
+            // Rebase point indices onto the slot's own point array
+            u32 firstPoint = 0;
+            for (u32 i = 0; i < written; ++i) {
+                DrawCommand& command = commands[i];
+                if (command.pointCount == 0) continue;
+                const Point* source = points.data() + command.firstPoint;
+                std::memcpy(target + firstPoint, source, command.pointCount * sizeof(Point));
+                command.firstPoint = firstPoint;
+                firstPoint += command.pointCount;
+            }
+
+            const bool last      = end == count;
+            header->connection   = mConnection;
+            header->width        = mWidth;
+            header->height       = mHeight;
+            header->commandCount = written;
+            header->pointCount   = pointCount;
+            header->clearColor   = mClearColor.ToU32_ABGR();
+            header->flags        = (mClearPending ? kSlotClear : 0) | (last && complete ? 0 : kSlotContinues);
+            header->submitTime   = GetMonotonicTime();
+            PublishSlot();
+
+            mClearPending = false;
+            mStats.commandsSent += written;
+            mStats.bytesSent += kSlotHeaderSize + bytes;
+            next = end;
+        } while (next < count);
+
+        mFrameStarted = !complete;
+        if (complete) { ++mStats.framesSent; }
+        return true;
+    }
+
+    u8* SharedCanvas::AcquireSlot(bool wait) {
+        const u32 written = mRing->written.load(std::memory_order_relaxed);
+        u32 read          = mRing->read.load();
+        if (wait && written - read >= mRing->slotCount) {
+            // Announce the wait before the last check, so the renderer either sees it or we see the freed slot
+            const f64 start = Clock::Now();
+            mRing->producerWaiting.store(1);
+            while (written - (read = mRing->read.load()) >= mRing->slotCount && !mRing->closed.load() &&
+                   IsProcessAlive(mRing->serverPid)) {
+                FutexWait(mRing->read, read, 0.1);
+            }
+            mRing->producerWaiting.store(0);
+            mStats.blockedTime += Clock::Now() - start;
+        }
+
+        if (mRing->closed.load() || (wait && written - read >= mRing->slotCount)) {
+            std::cerr << "Shared canvas renderer has gone away\n";
+            Disconnect();
+            return nullptr;
+        }
+        return written - read < mRing->slotCount ? GetSlot(mRing, written) : nullptr;
+    }
+
+    void SharedCanvas::PublishSlot() {
+        mRing->written.fetch_add(1);
+        if (mRing->rendererWaiting.load()) { FutexWake(mRing->written); }
+    }
+
+    SharedCanvasServer::SharedCanvasServer(const string& name, u32 slotCount, u32 slotSize)
+        : mName(name), mLatencies(1e-6, 10000) {
+        slotSize = (slotSize + 63) & ~63u;
+        if (slotCount == 0 || slotSize < kSlotHeaderSize + sizeof(DrawCommand)) {
+            throw std::runtime_error("Shared canvas " + name + " needs at least one slot that fits a command");
+        }
+
+        mMappingSize = kRingHeaderSize + CAST<size_t>(slotCount) * slotSize;
+        void* memory = CreateRegion(name, mMappingSize);
+        if (!memory) {
+            throw std::runtime_error("Failed to create shared canvas " + name + ": " + std::strerror(errno));
+        }
+
+        mRing              = new (memory) SharedRing {};
+        mRing->commandSize = sizeof(DrawCommand);
+        mRing->pointSize   = sizeof(Point);
+        mRing->slotCount   = slotCount;
+        mRing->slotSize    = slotSize;
+        mRing->serverPid   = GetProcessId();
+        mRing->version     = kRingVersion;
+        // Written last, a producer racing the setup sees an incompatible ring rather than a half-initialized one
+        std::atomic_thread_fence(std::memory_order_release);
+        mRing->magic = kRingMagic;
+    }
+
+    SharedCanvasServer::~SharedCanvasServer() {
+        mRing->closed.store(1);
+        FutexWake(mRing->read);
+        UnmapRegion(mRing, mMappingSize);
+        RemoveRegion(mName);
+    }
+
+    bool SharedCanvasServer::IsConnected() const {
+        const u32 pid = mRing->producerPid.load();
+        return pid != 0 && IsProcessAlive(pid);
+    }
+
+    bool SharedCanvasServer::WaitForFrame(f64 timeout) {
+        const f64 deadline = Clock::Now() + timeout;
+        while (WaitForSlot(X_MAX(deadline - Clock::Now(), 0.0))) {
+            // Read the size once; the producer can still change the slot
+            const auto* header = RCAST<const SlotHeader*>(GetSlot(mRing, mRing->read.load(std::memory_order_relaxed)));
+            const u32 width    = header->width;
+            const u32 height   = header->height;
+            if (CanvasFrame::IsValidSize(width, height)) {
+                mFrameWidth  = width;
+                mFrameHeight = height;
+                return true;
+            }
+            // Every slot of a frame carries its size, so the rest of this one is skipped too
+            std::cerr << "Shared canvas producer wrote a " << width << 'x' << height << " frame, skipping it\n";
+            ReleaseSlot();
+        }
+        return false;
+    }
+
+    void SharedCanvasServer::ExecuteFrame(FrameTarget& canvas) {
+        const u32 first = mRing->read.load(std::memory_order_relaxed);
+        X_ASSERT(mRing->written.load() != first, "SharedCanvasServer::ExecuteFrame() without a frame");
+        if (mRing->written.load() == first) return;
+
+        const auto* header   = RCAST<const SlotHeader*>(GetSlot(mRing, first));
+        const u32 connection = header->connection;
+        const u64 now        = GetMonotonicTime();
+        mLatencies.Add(now > header->submitTime ? CAST<f64>(now - header->submitTime) * 1e-9 : 0.0);
+
+        canvas.Begin();
+        while (true) {
+            const u8* slot = GetSlot(mRing, mRing->read.load(std::memory_order_relaxed));
+            header         = RCAST<const SlotHeader*>(slot);
+            if (header->connection != connection) break;  // The producer left mid-frame and a new one took over
+
+            if (header->flags & kSlotClear) {
+                const u32 c = header->clearColor;
+                canvas.Clear(Color(CAST<u8>(c), CAST<u8>(c >> 8), CAST<u8>(c >> 16), CAST<u8>(c >> 24)));
+            }
+            u32 pointCount = 0;
+            if (ReadCommands(slot, pointCount)) {
+                const u32 count    = CAST<u32>(mCommands.size());
+                const auto* points = RCAST<const Point*>(slot + kSlotHeaderSize + count * sizeof(DrawCommand));
+                canvas.Execute(mCommands.data(), count, points, pointCount);
+            } else {
+                std::cerr << "Shared canvas producer wrote a damaged slot, skipping it\n";
+            }
+
+            const bool continues = header->flags & kSlotContinues;
+            ReleaseSlot();
+            if (!continues) break;
+
+            // Wait for the rest of the frame, unless its producer is gone
+            bool arrived = WaitForSlot(0.1);
+            while (!arrived && IsConnected() && mRing->connection.load() == connection) {
+                arrived = WaitForSlot(0.1);
+            }
+            if (!arrived) {
+                std::cerr << "Shared canvas producer left mid-frame\n";
+                break;
+            }
+        }
+        canvas.End();
+        ++mFramesExecuted;
+    }
+
+    bool SharedCanvasServer::WaitForSlot(f64 timeout) {
+        const u32 read = mRing->read.load(std::memory_order_relaxed);
+        if (mRing->written.load() != read) return true;
+
+        // Announce the wait before the last check, so the producer either sees it or we see its slot
+        const f64 deadline = Clock::Now() + timeout;
+        mRing->rendererWaiting.store(1);
+        f64 remaining = timeout;
+        while (mRing->written.load() == read && remaining > 0.0) {
+            FutexWait(mRing->written, read, remaining);
+            remaining = deadline - Clock::Now();
+        }
+        mRing->rendererWaiting.store(0);
+        return mRing->written.load() != read;
+    }
+
+    bool SharedCanvasServer::ReadCommands(const u8* slot, u32& pointCount) {
+        // The producer can still write to the slot, so read the counts once and only trust the copy
+        const auto* header       = RCAST<const SlotHeader*>(slot);
+        const u32 commandCount   = header->commandCount;
+        pointCount               = header->pointCount;
+        const size_t commandSize = CAST<size_t>(commandCount) * sizeof(DrawCommand);
+        mCommands.clear();
+        if (commandSize + CAST<size_t>(pointCount) * sizeof(Point) > mRing->slotSize - kSlotHeaderSize) return false;
+
+        mCommands.resize(commandCount);
+        if (commandCount > 0) { std::memcpy(mCommands.data(), slot + kSlotHeaderSize, commandSize); }
+        for (const DrawCommand& command : mCommands) {
+            if (CAST<u64>(command.firstPoint) + command.pointCount > pointCount) return false;
+            if (command.pipeline != Pipeline::Triangles && command.pipeline != Pipeline::Lines) return false;
+            if (command.blend != BlendMode::Opaque && command.blend != BlendMode::Translucent) return false;
+
+            bool valid = false;
+            switch (command.shape) {
+                case ShapeType::Line:
+                case ShapeType::Rectangle:
+                    valid = true;
+                    break;
+                case ShapeType::Circle: {
+                    // The tessellator sizes its output from the segment count
+                    const f32 segments = command.params[3];
+                    valid              = segments >= 3.0f && segments <= CAST<f32>(DrawCommand::kMaxCircleSegments);
+                } break;
+                case ShapeType::Polygon:
+                    valid = command.pointCount >= 3;
+                    break;
+            }
+            if (!valid) return false;
+        }
+        return true;
+    }
+
+    void SharedCanvasServer::ReleaseSlot() {
+        mRing->read.fetch_add(1);
+        if (mRing->producerWaiting.load()) { FutexWake(mRing->read); }
+    }
+}  // namespace X
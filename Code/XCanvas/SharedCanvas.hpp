@@ -0,0 +1,182 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+#include "Color.hpp"
+#include "CommandList.hpp"
+#include "FrameStats.hpp"
+#include "RemoteCanvas.hpp"
+
+namespace X {
+    struct SharedRing;
+
+    /**
+     * @brief Canvas that draws in another process on the same host through a shared memory ring.
+     *
+     * The renderer creates the ring with a SharedCanvasServer, for example through Application::ServeSharedCanvas(),
+     * and this connects to it by name. End() copies the frame's commands and polygon points as they are, with no
+     * encoding, into the next free slot and publishes it; a frame too large for one slot continues in the next. The
+     * renderer sleeps on a futex while the ring is empty and is only woken when it actually sleeps, so a busy
+     * channel costs no system calls.
+     *
+     * Every slot is a frame in flight: when the renderer falls behind End() waits for one to be freed, or with
+     * SetDropWhenBusy() skips the frame. Producer and renderer must be the same build of the library, which
+     * Connect() checks.
+     */
+    class SharedCanvas : protected CommandList {
+    public:
+        using CommandList::DrawCircle;
+        using CommandList::DrawLine;
+        using CommandList::DrawPolygon;
+        using CommandList::DrawRectangle;
+        using CommandList::SetFillColor;
+        using CommandList::SetStrokeColor;
+        using CommandList::SetStrokeWidth;
+
+        struct Stats {
+            u64 framesSent {0};
+            u64 framesDropped {0};  // Skipped for lack of a free slot or a connection
+            u64 commandsSent {0};
+            u64 bytesSent {0};
+            f64 blockedTime {0.0};  // Seconds spent waiting for a free slot
+        };
+
+        /// @brief Throws std::invalid_argument unless both sides are between 1 and CanvasFrame::kMaxSize
+        SharedCanvas(u32 width, u32 height);
+        ~SharedCanvas() override;
+
+        SharedCanvas(const SharedCanvas&)            = delete;
+        SharedCanvas& operator=(const SharedCanvas&) = delete;
+
+        /// @brief Connect to the SharedCanvasServer that created @p name. Reports failures to stderr.
+        bool Connect(const string& name);
+        void Disconnect();
+
+        X_ND bool IsConnected() const {
+            return mRing != nullptr;
+        }
+
+        /// @brief Clear the frame being recorded or, outside Begin() and End(), the next one
+        void Clear(const Color& clearColor = Colors::Black);
+        /// @brief Ignores sizes the constructor would reject
+        void Resize(u32 width, u32 height);
+
+        void Begin();
+        void End();
+
+        /// @brief Append pre-recorded commands to the current frame, as if drawn here at this point
+        void Execute(const CommandList& list);
+
+        /// @brief Skip frames instead of waiting when every slot is in use (off by default)
+        void SetDropWhenBusy(const bool enabled) {
+            mDropWhenBusy = enabled;
+        }
+
+        X_ND u32 GetWidth() const {
+            return mWidth;
+        }
+
+        X_ND u32 GetHeight() const {
+            return mHeight;
+        }
+
+        X_ND const Stats& GetStats() const {
+            return mStats;
+        }
+
+    protected:
+        bool OnQueueFull() override;
+
+    private:
+        /// @brief Copy the queue into as many slots as it takes. Returns false if a slot couldn't be had.
+        bool WriteFrame(bool complete, bool wait);
+        /// @brief The next slot once it is free, nullptr if it isn't and @p wait is false or the renderer is gone
+        u8* AcquireSlot(bool wait);
+        void PublishSlot();
+
+        u32 mWidth;
+        u32 mHeight;
+        CommandQueue mQueue;
+        Color mClearColor {Colors::Black};
+        bool mClearPending {false};
+        bool mRecording {false};
+        bool mFrameStarted {false};  // Part of the frame went out early, so the rest must follow
+
+        SharedRing* mRing {nullptr};
+        size_t mMappingSize {0};
+        u32 mConnection {0};
+        bool mDropWhenBusy {false};
+        Stats mStats;
+    };
+
+    /**
+     * @brief Renderer end of SharedCanvas: creates the shared memory ring and executes the frames written into it.
+     *
+     * The ring is a POSIX shared memory object named like "/xcanvas", removed again by the destructor. ExecuteFrame()
+     * copies each slot's commands out of the mapping and checks them there, where the producer can't change them
+     * afterwards, then appends them and the slot's points to the canvas' queue and frees the slot before the frame is
+     * rendered. A slot with a damaged command is skipped whole. One producer is served at a time and producers may
+     * come and go. Any process that can open the ring can write to it, so it is created accessible to the current
+     * user only.
+     */
+    class SharedCanvasServer final : public RemoteFrameSource {
+    public:
+        static constexpr u32 kDefaultSlotCount = 4;
+        static constexpr u32 kDefaultSlotSize  = 4 << 20;
+
+        /// @brief Throws std::runtime_error if the ring can't be created. Replaces one left by a server that crashed.
+        explicit SharedCanvasServer(const string& name,
+                                    u32 slotCount = kDefaultSlotCount,
+                                    u32 slotSize  = kDefaultSlotSize);
+        ~SharedCanvasServer() override;
+
+        SharedCanvasServer(const SharedCanvasServer&)            = delete;
+        SharedCanvasServer& operator=(const SharedCanvasServer&) = delete;
+
+        /// @brief Wait up to @p timeout seconds for the start of a frame; ExecuteFrame() waits for the rest. Slots
+        /// with a frame size Canvas can't take are skipped as damaged.
+        bool WaitForFrame(f64 timeout) override;
+
+        X_ND u32 GetFrameWidth() const override {
+            return mFrameWidth;
+        }
+
+        X_ND u32 GetFrameHeight() const override {
+            return mFrameHeight;
+        }
+
+        /// @brief Execute the frame WaitForFrame() found on @p canvas (Begin() to End())
+        void ExecuteFrame(FrameTarget& canvas) override;
+
+        /// @brief Whether a producer is attached and still running
+        X_ND bool IsConnected() const;
+
+        X_ND u64 GetFramesExecuted() const {
+            return mFramesExecuted;
+        }
+
+        /// @brief Seconds from a producer's End() publishing a frame to ExecuteFrame() picking it up
+        X_ND const Histogram& GetLatencies() const {
+            return mLatencies;
+        }
+
+    private:
+        /// @brief Wait up to @p timeout seconds for the next slot to be published
+        bool WaitForSlot(f64 timeout);
+        void ReleaseSlot();
+        /// @brief Copy the slot's commands into mCommands and check them against the slot's @p pointCount
+        bool ReadCommands(const u8* slot, u32& pointCount);
+
+        string mName;
+        SharedRing* mRing {nullptr};
+        size_t mMappingSize {0};
+        u32 mFrameWidth {0};
+        u32 mFrameHeight {0};
+        u64 mFramesExecuted {0};
+        Histogram mLatencies;
+        vector<DrawCommand> mCommands;
+    };
+}  // namespace X
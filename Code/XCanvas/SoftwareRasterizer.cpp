@@ -0,0 +1,379 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "SoftwareRasterizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #define X_RASTER_AVX2
+    #include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+    #define X_RASTER_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace X {
+    // Span kernels. Pixels are RGBA8 in memory, i.e. 0xAABBGGRR when loaded as a little-endian u32. Blending
+    // computes round((src * a + dst * (255 - a)) / 255) per color channel and round((255 * a + dst * (255 - a)) / 255)
+    // for alpha, as GL does for an RGBA8 target with the application's separate blend functions.
+
+    static u32 Div255(u32 value) {
+        value += 128;
+        return (value + (value >> 8)) >> 8;
+    }
+
+    static void FillSpanScalar(u32* dst, u32 count, u32 color) {
+        std::fill_n(dst, count, color);
+    }
+
+    static void BlendSpanScalar(u32* dst, u32 count, u32 color) {
+        const u32 alpha   = color >> 24;
+        const u32 inverse = 255 - alpha;
+        const u32 srcR    = (color & 0xFF) * alpha;
+        const u32 srcG    = ((color >> 8) & 0xFF) * alpha;
+        const u32 srcB    = ((color >> 16) & 0xFF) * alpha;
+        const u32 srcA    = alpha * 255;
+        for (u32 i = 0; i < count; ++i) {
+            const u32 pixel = dst[i];
+            const u32 r     = Div255((pixel & 0xFF) * inverse + srcR);
+            const u32 g     = Div255(((pixel >> 8) & 0xFF) * inverse + srcG);
+            const u32 b     = Div255(((pixel >> 16) & 0xFF) * inverse + srcB);
+            const u32 a     = Div255((pixel >> 24) * inverse + srcA);
+            dst[i]          = r | (g << 8) | (b << 16) | (a << 24);
+        }
+    }
+
+#if defined(X_RASTER_AVX2)
+    __attribute__((target("avx2"))) static void FillSpanAvx2(u32* dst, u32 count, u32 color) {
+        const __m256i value = _mm256_set1_epi32(CAST<i32>(color));
+        u32 i               = 0;
+        for (; i + 8 <= count; i += 8) {
+            _mm256_storeu_si256(RCAST<__m256i*>(dst + i), value);
+        }
+        FillSpanScalar(dst + i, count - i, color);
+    }
+
+    /// @brief Blend 16-bit channels: (dst * inverse + source) / 255, rounded
+    __attribute__((target("avx2"))) static inline __m256i BlendChannelsAvx2(__m256i channels,
+                                                                           __m256i inverse,
+                                                                           __m256i source) {
+        channels = _mm256_add_epi16(_mm256_mullo_epi16(channels, inverse), source);
+        channels = _mm256_add_epi16(channels, _mm256_set1_epi16(128));
+        return _mm256_srli_epi16(_mm256_add_epi16(channels, _mm256_srli_epi16(channels, 8)), 8);
+    }
+
+    __attribute__((target("avx2"))) static void BlendSpanAvx2(u32* dst, u32 count, u32 color) {
+        const u32 alpha = color >> 24;
+        const auto srcR = CAST<i16>((color & 0xFF) * alpha);
+        const auto srcG = CAST<i16>(((color >> 8) & 0xFF) * alpha);
+        const auto srcB = CAST<i16>(((color >> 16) & 0xFF) * alpha);
+        const auto srcA = CAST<i16>(alpha * 255);
+
+        // 16-bit lanes hold two pixels' channels per 128-bit half after unpacking
+        const __m256i inverse = _mm256_set1_epi16(CAST<i16>(255 - alpha));
+        const __m256i source  = _mm256_setr_epi16(
+          srcR, srcG, srcB, srcA, srcR, srcG, srcB, srcA, srcR, srcG, srcB, srcA, srcR, srcG, srcB, srcA);
+        const __m256i zero = _mm256_setzero_si256();
+
+        u32 i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m256i pixels = _mm256_loadu_si256(RCAST<const __m256i*>(dst + i));
+            const __m256i low    = BlendChannelsAvx2(_mm256_unpacklo_epi8(pixels, zero), inverse, source);
+            const __m256i high   = BlendChannelsAvx2(_mm256_unpackhi_epi8(pixels, zero), inverse, source);
+            // Unpack and pack both work within 128-bit halves, so the pixel order comes back unchanged
+            _mm256_storeu_si256(RCAST<__m256i*>(dst + i), _mm256_packus_epi16(low, high));
+        }
+        BlendSpanScalar(dst + i, count - i, color);
+    }
+#endif
+
+#if defined(X_RASTER_NEON)
+    static void FillSpanNeon(u32* dst, u32 count, u32 color) {
+        const uint32x4_t value = vdupq_n_u32(color);
+        u32 i                  = 0;
+        for (; i + 4 <= count; i += 4) {
+            vst1q_u32(dst + i, value);
+        }
+        FillSpanScalar(dst + i, count - i, color);
+    }
+
+    static void BlendSpanNeon(u32* dst, u32 count, u32 color) {
+        const u32 alpha         = color >> 24;
+        const auto srcR         = CAST<u16>((color & 0xFF) * alpha);
+        const auto srcG         = CAST<u16>(((color >> 8) & 0xFF) * alpha);
+        const auto srcB         = CAST<u16>(((color >> 16) & 0xFF) * alpha);
+        const auto srcA         = CAST<u16>(alpha * 255);
+        const u16 sourceLanes[] = {srcR, srcG, srcB, srcA, srcR, srcG, srcB, srcA};
+
+        const uint16x8_t inverse = vdupq_n_u16(CAST<u16>(255 - alpha));
+        const uint16x8_t source  = vld1q_u16(sourceLanes);
+        const uint16x8_t bias    = vdupq_n_u16(128);
+
+        const auto blend = [&](uint8x8_t channels) {
+            uint16x8_t value = vaddq_u16(vmlaq_u16(source, vmovl_u8(channels), inverse), bias);
+            return vshrn_n_u16(vaddq_u16(value, vshrq_n_u16(value, 8)), 8);
+        };
+
+        u32 i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const uint8x16_t pixels = vld1q_u8(RCAST<const u8*>(dst + i));
+            vst1q_u8(RCAST<u8*>(dst + i), vcombine_u8(blend(vget_low_u8(pixels)), blend(vget_high_u8(pixels))));
+        }
+        BlendSpanScalar(dst + i, count - i, color);
+    }
+#endif
+
+    using SpanKernel = void (*)(u32* dst, u32 count, u32 color);
+
+    struct SpanKernels {
+        SpanKernel fill;
+        SpanKernel blend;
+    };
+
+    static SpanKernels SelectSpanKernels() {
+#if defined(X_RASTER_AVX2)
+        __builtin_cpu_init();  // Runs from a static initializer, possibly before libgcc's own
+        if (__builtin_cpu_supports("avx2")) { return {FillSpanAvx2, BlendSpanAvx2}; }
+#endif
+#if defined(X_RASTER_NEON)
+        return {FillSpanNeon, BlendSpanNeon};
+#else
+        return {FillSpanScalar, BlendSpanScalar};
+#endif
+    }
+
+    static const SpanKernels kSpanKernels = SelectSpanKernels();
+
+    // Sample positions are 24.8 fixed point, the precision GL implementations snap to; vertices far outside the
+    // target are clamped to keep edge products inside 64 bits
+    static constexpr i64 kSubpixelScale = 256;
+    static constexpr i64 kHalfPixel     = kSubpixelScale / 2;
+    static constexpr f32 kGuardBand     = 1 << 20;
+
+    static i64 ToFixed(f32 value) {
+        return std::lround(std::clamp(value, -kGuardBand, kGuardBand) * CAST<f32>(kSubpixelScale));
+    }
+
+    static i64 FloorDiv(i64 numerator, i64 denominator) {
+        const i64 quotient = numerator / denominator;
+        return (numerator % denominator != 0 && numerator < 0) ? quotient - 1 : quotient;
+    }
+
+    static i64 CeilDiv(i64 numerator, i64 denominator) {
+        const i64 quotient = numerator / denominator;
+        return (numerator % denominator != 0 && numerator > 0) ? quotient + 1 : quotient;
+    }
+
+    void SoftwareRasterizer::Resize(u32 width, u32 height) {
+        if (width == mImage.GetWidth() && height == mImage.GetHeight()) return;
+
+        mImage.Resize(width, height);
+        mTilesX = (width + kTileSize - 1) / kTileSize;
+        mTilesY = (height + kTileSize - 1) / kTileSize;
+        mBins.assign(CAST<size_t>(mTilesX) * mTilesY, {});
+    }
+
+    void SoftwareRasterizer::Clear(const Color& color, u32 width, u32 height) {
+        Resize(width, height);
+
+        const u32 value = color.ToU32_ABGR();
+        for (u32 y = 0; y < mImage.GetHeight(); ++y) {
+            kSpanKernels.fill(RCAST<u32*>(mImage.GetRow(y)), mImage.GetWidth(), value);
+        }
+    }
+
+    void SoftwareRasterizer::Submit(const RenderFrame& frame) {
+        Resize(frame.width, frame.height);
+        const auto width  = CAST<i32>(frame.width);
+        const auto height = CAST<i32>(frame.height);
+
+        // Snap regions outward to whole pixels, the same way the GL device snaps its scissor rects
+        const vector<Rect> fullFrame {Rect(0.0f, 0.0f, (f32)width, (f32)height)};
+        mRegions.clear();
+        mRegionBounds = {width, height, 0, 0};
+        for (const auto& region : frame.damage ? *frame.damage : fullFrame) {
+            const PixelRect rect {X_MAX(0, (i32)std::floor(region.left)),
+                                  X_MAX(0, (i32)std::floor(region.top)),
+                                  X_MIN(width, (i32)std::ceil(region.right)),
+                                  X_MIN(height, (i32)std::ceil(region.bottom))};
+            if (rect.x0 >= rect.x1 || rect.y0 >= rect.y1) continue;
+
+            mRegions.push_back(rect);
+            mRegionBounds = {X_MIN(mRegionBounds.x0, rect.x0),
+                             X_MIN(mRegionBounds.y0, rect.y0),
+                             X_MAX(mRegionBounds.x1, rect.x1),
+                             X_MAX(mRegionBounds.y1, rect.y1)};
+        }
+        if (mRegions.empty()) return;
+
+        mPrimitives.clear();
+        for (auto& bin : mBins) {
+            bin.clear();
+        }
+
+        for (const auto& batch : *frame.batches) {
+            const bool blend    = batch.blend == BlendMode::Translucent;
+            const Vertex* first = frame.vertices + batch.firstVertex;
+            if (batch.pipeline == Pipeline::Triangles) {
+                for (u32 i = 0; i + 2 < batch.vertexCount; i += 3) {
+                    SetupTriangle(first[i], first[i + 1], first[i + 2], blend);
+                }
+            } else {
+                for (u32 i = 0; i + 1 < batch.vertexCount; i += 2) {
+                    SetupLine(first[i], first[i + 1], blend);
+                }
+            }
+        }
+
+        const u32 clear      = frame.clearColor ? frame.clearColor->ToU32_ABGR() : 0;
+        const u32* clearPtr  = frame.clearColor ? &clear : nullptr;
+        const auto tileCount = CAST<u32>(mBins.size());
+        const auto rasterize = [this, clearPtr](u32 begin, u32 end) {
+            for (u32 tile = begin; tile < end; ++tile) {
+                RasterizeTile(tile, clearPtr);
+            }
+        };
+
+        if (frame.jobs && tileCount > 1) {
+            frame.jobs->ParallelFor(tileCount, 1, rasterize);
+        } else {
+            rasterize(0, tileCount);
+        }
+    }
+
+    void SoftwareRasterizer::SetupTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2, bool blend) {
+        i64 x[3] = {ToFixed(v0.x), ToFixed(v1.x), ToFixed(v2.x)};
+        i64 y[3] = {ToFixed(v0.y), ToFixed(v1.y), ToFixed(v2.y)};
+
+        // Wind every triangle the same way so the inside is where all edge functions are positive
+        const i64 area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+        if (area == 0) return;
+        if (area < 0) {
+            std::swap(x[1], x[2]);
+            std::swap(y[1], y[2]);
+        }
+
+        const i64 minX = X_MIN(x[0], X_MIN(x[1], x[2]));
+        const i64 minY = X_MIN(y[0], X_MIN(y[1], y[2]));
+        const i64 maxX = X_MAX(x[0], X_MAX(x[1], x[2]));
+        const i64 maxY = X_MAX(y[0], X_MAX(y[1], y[2]));
+
+        // Pixels whose center can be covered, clipped to the regions being drawn
+        const PixelRect bounds {
+          CAST<i32>(X_MAX((i64)mRegionBounds.x0, CeilDiv(minX - kHalfPixel, kSubpixelScale))),
+          CAST<i32>(X_MAX((i64)mRegionBounds.y0, CeilDiv(minY - kHalfPixel, kSubpixelScale))),
+          CAST<i32>(X_MIN((i64)mRegionBounds.x1, FloorDiv(maxX - kHalfPixel, kSubpixelScale) + 1)),
+          CAST<i32>(X_MIN((i64)mRegionBounds.y1, FloorDiv(maxY - kHalfPixel, kSubpixelScale) + 1))};
+        if (bounds.x0 >= bounds.x1 || bounds.y0 >= bounds.y1) return;
+
+        Primitive primitive {};
+        for (u32 edge = 0; edge < 3; ++edge) {
+            const u32 next  = (edge + 1) % 3;
+            const i64 a     = y[edge] - y[next];
+            const i64 b     = x[next] - x[edge];
+            // GL's top-left rule applies with y up, which makes horizontal edges below the triangle the owned ones
+            const bool topLeft = a > 0 || (a == 0 && b < 0);
+
+            primitive.a[edge] = a;
+            primitive.b[edge] = b;
+            primitive.c[edge] = -(a * x[edge] + b * y[edge]) - (topLeft ? 0 : 1);
+        }
+        primitive.bounds = bounds;
+        primitive.color  = v0.color;  // Canvas commands are flat colored
+        primitive.blend  = blend;
+
+        const auto index = CAST<u32>(mPrimitives.size());
+        mPrimitives.push_back(primitive);
+
+        const u32 tileX0 = CAST<u32>(bounds.x0) / kTileSize;
+        const u32 tileY0 = CAST<u32>(bounds.y0) / kTileSize;
+        const u32 tileX1 = CAST<u32>(bounds.x1 - 1) / kTileSize;
+        const u32 tileY1 = CAST<u32>(bounds.y1 - 1) / kTileSize;
+        for (u32 tileY = tileY0; tileY <= tileY1; ++tileY) {
+            for (u32 tileX = tileX0; tileX <= tileX1; ++tileX) {
+                mBins[tileY * mTilesX + tileX].push_back(index);
+            }
+        }
+    }
+
+    void SoftwareRasterizer::SetupLine(const Vertex& v0, const Vertex& v1, bool blend) {
+        const f32 dx = v1.x - v0.x;
+        const f32 dy = v1.y - v0.y;
+        if (dx == 0.0f && dy == 0.0f) return;
+
+        // A parallelogram one pixel tall along the minor axis lights exactly one pixel per major-axis step, the
+        // same coverage GL's diamond-exit rule gives one pixel wide lines
+        const bool xMajor = std::abs(dx) >= std::abs(dy);
+        const f32 nx      = xMajor ? 0.0f : 0.5f;
+        const f32 ny      = xMajor ? 0.5f : 0.0f;
+        const Vertex a {v0.x + nx, v0.y + ny, v0.color};
+        const Vertex b {v1.x + nx, v1.y + ny, v0.color};
+        const Vertex c {v1.x - nx, v1.y - ny, v0.color};
+        const Vertex d {v0.x - nx, v0.y - ny, v0.color};
+        SetupTriangle(a, b, c, blend);
+        SetupTriangle(a, c, d, blend);
+    }
+
+    void SoftwareRasterizer::RasterizeTile(u32 tile, const u32* clearColor) {
+        const auto tileX0 = CAST<i32>((tile % mTilesX) * kTileSize);
+        const auto tileY0 = CAST<i32>((tile / mTilesX) * kTileSize);
+        const PixelRect tileRect {tileX0,
+                                  tileY0,
+                                  X_MIN(tileX0 + (i32)kTileSize, (i32)mImage.GetWidth()),
+                                  X_MIN(tileY0 + (i32)kTileSize, (i32)mImage.GetHeight())};
+
+        for (const auto& region : mRegions) {
+            const PixelRect clip {X_MAX(tileRect.x0, region.x0),
+                                  X_MAX(tileRect.y0, region.y0),
+                                  X_MIN(tileRect.x1, region.x1),
+                                  X_MIN(tileRect.y1, region.y1)};
+            if (clip.x0 >= clip.x1 || clip.y0 >= clip.y1) continue;
+
+            if (clearColor) {
+                for (i32 y = clip.y0; y < clip.y1; ++y) {
+                    auto* row = RCAST<u32*>(mImage.GetRow(CAST<u32>(y)));
+                    kSpanKernels.fill(row + clip.x0, CAST<u32>(clip.x1 - clip.x0), *clearColor);
+                }
+            }
+
+            for (const u32 index : mBins[tile]) {
+                RasterizePrimitive(mPrimitives[index], clip);
+            }
+        }
+    }
+
+    void SoftwareRasterizer::RasterizePrimitive(const Primitive& primitive, const PixelRect& clip) {
+        const i32 y0 = X_MAX(primitive.bounds.y0, clip.y0);
+        const i32 y1 = X_MIN(primitive.bounds.y1, clip.y1);
+        const i32 x0 = X_MAX(primitive.bounds.x0, clip.x0);
+        const i32 x1 = X_MIN(primitive.bounds.x1, clip.x1);
+        if (x0 >= x1) return;
+
+        const SpanKernel span = primitive.blend ? kSpanKernels.blend : kSpanKernels.fill;
+        for (i32 y = y0; y < y1; ++y) {
+            // Solve a * (256x + 128) + rowC >= 0 for x on each edge; the intersection is this row's span
+            const i64 sampleY = y * kSubpixelScale + kHalfPixel;
+            i64 left          = x0;
+            i64 right         = x1;
+            for (u32 edge = 0; edge < 3 && left < right; ++edge) {
+                const i64 a    = primitive.a[edge];
+                const i64 rowC = primitive.b[edge] * sampleY + primitive.c[edge] + a * kHalfPixel;
+                if (a > 0) {
+                    left = X_MAX(left, CeilDiv(-rowC, a * kSubpixelScale));
+                } else if (a < 0) {
+                    right = X_MIN(right, FloorDiv(rowC, -a * kSubpixelScale) + 1);
+                } else if (rowC < 0) {
+                    right = left;
+                }
+            }
+            if (left >= right) continue;
+
+            auto* row = RCAST<u32*>(mImage.GetRow(CAST<u32>(y)));
+            span(row + left, CAST<u32>(right - left), primitive.color);
+        }
+    }
+}  // namespace X
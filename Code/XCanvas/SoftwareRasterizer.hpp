@@ -0,0 +1,70 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "RenderDevice.hpp"
+
+namespace X {
+    /**
+     * @brief Rasterizes Canvas frames into an RGBA Image on the CPU.
+     *
+     * Primitives are set up once in 24.8 fixed point and binned into 64x64 pixel tiles; tiles are then rasterized
+     * independently, in parallel on the frame's JobSystem when it has one, each walking its bin in submission order.
+     * Every row of a primitive is solved analytically into a single span that SIMD kernels fill or blend. Coverage
+     * follows GL's top-left rule at pixel centers, in GL's y-up window space, so fills match GL pixel for pixel at
+     * GL's usual eight bits of subpixel precision. Lines light one pixel per major-axis step, and blending
+     * matches Application's GL blend state on an RGBA8 target: source-alpha blending for color, source-over for
+     * alpha, so translucent draws over an opaque background leave it opaque. The image persists between frames, so
+     * damaged regions are simply repainted in place.
+     */
+    class SoftwareRasterizer final : public RenderDevice {
+    public:
+        X_ND CanvasBackend GetBackend() const override {
+            return CanvasBackend::Software;
+        }
+
+        /// @brief Resize the target. Contents are discarded when the size changes.
+        void Resize(u32 width, u32 height);
+
+        void Clear(const Color& color, u32 width, u32 height) override;
+        void Submit(const RenderFrame& frame) override;
+
+        X_ND const Image* GetImage() const override {
+            return &mImage;
+        }
+
+    private:
+        /// @brief Integer pixel rectangle, half-open on the right and bottom
+        struct PixelRect {
+            i32 x0, y0, x1, y1;
+        };
+
+        struct Primitive {
+            // Edge functions E = a * x + b * y + c over 24.8 sample positions, inside where all are >= 0. The
+            // fill rule is folded into c.
+            i64 a[3];
+            i64 b[3];
+            i64 c[3];
+            PixelRect bounds;
+            u32 color;
+            bool blend;
+        };
+
+        static constexpr u32 kTileSize = 64;
+
+        void SetupTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2, bool blend);
+        void SetupLine(const Vertex& v0, const Vertex& v1, bool blend);
+        void RasterizeTile(u32 tile, const u32* clearColor);
+        void RasterizePrimitive(const Primitive& primitive, const PixelRect& clip);
+
+        Image mImage;
+        u32 mTilesX {0};
+        u32 mTilesY {0};
+        vector<Primitive> mPrimitives;
+        vector<vector<u32>> mBins;  // Primitive indices per tile, in submission order
+        vector<PixelRect> mRegions;
+        PixelRect mRegionBounds {0, 0, 0, 0};
+    };
+}  // namespace X
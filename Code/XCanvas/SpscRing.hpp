@@ -0,0 +1,53 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+
+#include <array>
+#include <atomic>
+
+namespace X {
+    /**
+     * @brief Fixed-capacity lock-free single-producer/single-consumer ring buffer.
+     *
+     * TryPush() may only be called from one thread and TryPop() from one (possibly different) thread. Neither
+     * allocates nor blocks; a full ring rejects the push.
+     */
+    template<typename T, u32 Capacity>
+    class SpscRing {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        bool TryPush(const T& value) {
+            const u32 head = mHead.load(std::memory_order_relaxed);
+            if (head - mTail.load(std::memory_order_acquire) == Capacity) return false;
+
+            mSlots[head & (Capacity - 1)] = value;
+            mHead.store(head + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        bool TryPop(T& value) {
+            const u32 tail = mTail.load(std::memory_order_relaxed);
+            if (tail == mHead.load(std::memory_order_acquire)) return false;
+
+            value = mSlots[tail & (Capacity - 1)];
+            mTail.store(tail + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        X_ND bool IsEmpty() const {
+            return mTail.load(std::memory_order_acquire) == mHead.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::array<T, Capacity> mSlots {};
+        alignas(64) std::atomic<u32> mHead {0};  // Written by the producer
+        alignas(64) std::atomic<u32> mTail {0};  // Written by the consumer
+    };
+}  // namespace X
@@ -0,0 +1,136 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "StripeExporter.hpp"
+
+#include <cmath>
+#include <iostream>
+
+namespace X {
+    StripeExporter::StripeExporter(u32 width, u32 height) : mWidth(width), mHeight(height) {}
+
+    u32 StripeExporter::GetStripesInFlight() const {
+        // Twice the thread count keeps every thread busy while the writer drains finished stripes in order
+        return mJobSystem ? 2 * (mJobSystem->GetWorkerCount() + 1) : 1;
+    }
+
+    bool StripeExporter::Export(const CommandList& list, const string& path, ImageFormat format) {
+        auto writer = ImageStreamWriter::Create(format);
+        writer->SetJobSystem(mJobSystem);
+        if (!writer->Open(path, mWidth, mHeight)) return false;
+
+        const CommandQueue& queue = list.GetQueue();
+        BinCommands(queue);
+
+        const u32 stripeCount = (mHeight + mStripeHeight - 1) / mStripeHeight;
+        const u32 slotCount   = X_MIN(GetStripesInFlight(), stripeCount);
+        vector<StripeSlot> slots(slotCount);
+
+        const auto schedule = [&](u32 stripe) {
+            StripeSlot& slot = slots[stripe % slotCount];
+            if (!mJobSystem) {
+                RenderStripe(queue, stripe, slot);
+                return;
+            }
+            mJobSystem->Schedule([this, &queue, stripe, &slot] { RenderStripe(queue, stripe, slot); }, slot.counter);
+        };
+
+        for (u32 stripe = 0; stripe < slotCount; ++stripe) {
+            schedule(stripe);
+        }
+
+        bool written = true;
+        for (u32 stripe = 0; stripe < stripeCount && written; ++stripe) {
+            StripeSlot& slot = slots[stripe % slotCount];
+            if (mJobSystem) { mJobSystem->Wait(slot.counter); }
+
+            const Image& image = *slot.rasterizer.GetImage();
+            written            = writer->WriteRows(image.GetPixels(), image.GetHeight(), image.GetStride());
+            if (written && stripe + slotCount < stripeCount) { schedule(stripe + slotCount); }
+        }
+
+        // Jobs still in flight after a failed write reference the slots
+        if (mJobSystem) {
+            for (const auto& slot : slots) {
+                mJobSystem->Wait(slot.counter);
+            }
+        }
+
+        return written && writer->Close();
+    }
+
+    void StripeExporter::BinCommands(const CommandQueue& queue) {
+        const u32 stripeCount = (mHeight + mStripeHeight - 1) / mStripeHeight;
+        const Rect page(0.0f, 0.0f, (f32)mWidth, (f32)mHeight);
+
+        // Counting sort: size every stripe's bin, then fill them in submission order
+        const auto forEachCommand = [&](auto&& visit) {
+            for (u32 i = 0; i < queue.GetCount(); ++i) {
+                const Rect& bounds = queue.GetCommand(i).bounds;
+                if (!bounds.Overlaps(page)) continue;
+
+                const auto top    = (u32)X_MAX(std::floor(bounds.top), 0.0f);
+                const auto bottom = (u32)X_MIN(std::ceil(bounds.bottom), (f32)mHeight);
+                if (top >= bottom) continue;
+
+                for (u32 stripe = top / mStripeHeight; stripe <= (bottom - 1) / mStripeHeight; ++stripe) {
+                    visit(stripe, i);
+                }
+            }
+        };
+
+        mStripeStart.assign(stripeCount + 1, 0);
+        forEachCommand([this](u32 stripe, u32) { ++mStripeStart[stripe + 1]; });
+        for (u32 stripe = 0; stripe < stripeCount; ++stripe) {
+            mStripeStart[stripe + 1] += mStripeStart[stripe];
+        }
+
+        mStripeCommands.resize(mStripeStart[stripeCount]);
+        vector<u32> cursor(mStripeStart.begin(), mStripeStart.end() - 1);
+        forEachCommand([this, &cursor](u32 stripe, u32 sequence) { mStripeCommands[cursor[stripe]++] = sequence; });
+    }
+
+    void StripeExporter::RenderStripe(const CommandQueue& queue, u32 stripe, StripeSlot& slot) const {
+        const u32 top  = stripe * mStripeHeight;
+        const u32 rows = X_MIN(mStripeHeight, mHeight - top);
+
+        // Same batching as Canvas: consecutive commands with equal state share a batch
+        slot.batches.clear();
+        u32 vertexCount = 0;
+        for (u32 i = mStripeStart[stripe]; i < mStripeStart[stripe + 1]; ++i) {
+            const DrawCommand& command = queue.GetCommand(mStripeCommands[i]);
+            const u32 vertices         = Tessellator::CountVertices(command);
+            if (vertices == 0) continue;
+
+            const u32 state = command.GetState();
+            if (slot.batches.empty() || slot.batches.back().state != state) {
+                slot.batches.push_back({command.pipeline, command.blend, state, vertexCount, 0});
+            }
+            slot.batches.back().vertexCount += vertices;
+            vertexCount += vertices;
+        }
+
+        slot.vertices.resize(vertexCount);
+        Vertex* out = slot.vertices.data();
+        for (u32 i = mStripeStart[stripe]; i < mStripeStart[stripe + 1]; ++i) {
+            const DrawCommand& command = queue.GetCommand(mStripeCommands[i]);
+            Tessellator::Tessellate(command, queue.GetPoints(), out);
+            out += Tessellator::CountVertices(command);
+        }
+
+        // Move the stripe to the origin of its own image
+        for (auto& vertex : slot.vertices) {
+            vertex.y -= (f32)top;
+        }
+
+        RenderFrame frame;
+        frame.width       = mWidth;
+        frame.height      = rows;
+        frame.vertices    = slot.vertices.data();
+        frame.vertexCount = vertexCount;
+        frame.batches     = &slot.batches;
+        frame.clearColor  = &mBackground;
+        slot.rasterizer.Submit(frame);
+    }
+}  // namespace X
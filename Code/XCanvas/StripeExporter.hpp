@@ -0,0 +1,76 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+#include "Color.hpp"
+#include "CommandList.hpp"
+#include "ImageStreamWriter.hpp"
+#include "JobSystem.hpp"
+#include "SoftwareRasterizer.hpp"
+
+namespace X {
+    /**
+     * @brief Renders a recorded CommandList into an image file of any size, one horizontal stripe at a time.
+     *
+     * Commands are binned by the stripes their bounds touch, so each stripe only tessellates what can reach it.
+     * Stripes render on the SoftwareRasterizer, in parallel on a JobSystem when one is set, and are streamed to an
+     * ImageStreamWriter strictly top to bottom as they complete. At most GetStripesInFlight() stripes exist at once,
+     * so peak memory is about that many times width x stripe height x 4 bytes regardless of the output height.
+     */
+    class StripeExporter {
+    public:
+        StripeExporter(u32 width, u32 height);
+
+        /// @brief Rows rendered per stripe (64 by default)
+        void SetStripeHeight(u32 rows) {
+            mStripeHeight = X_MAX(rows, 1u);
+        }
+
+        /// @brief Color of pixels no command covers (opaque white by default)
+        void SetBackground(const Color& color) {
+            mBackground = color;
+        }
+
+        /// @brief Render (and encode) stripes in parallel on @p jobs; nullptr does it all on the calling thread
+        void SetJobSystem(JobSystem* jobs) {
+            mJobSystem = jobs;
+        }
+
+        /// @brief Render @p list and write it to @p path. Returns false (reported on std::cerr) on any failure.
+        bool Export(const CommandList& list, const string& path, ImageFormat format);
+
+        X_ND u32 GetStripesInFlight() const;
+
+        X_ND u32 GetWidth() const {
+            return mWidth;
+        }
+
+        X_ND u32 GetHeight() const {
+            return mHeight;
+        }
+
+    private:
+        /// @brief Everything one in-flight stripe needs, reused for every stripe rendered in the slot
+        struct StripeSlot {
+            SoftwareRasterizer rasterizer;
+            vector<Vertex> vertices;
+            vector<DrawBatch> batches;
+            JobCounter counter;
+        };
+
+        void BinCommands(const CommandQueue& queue);
+        void RenderStripe(const CommandQueue& queue, u32 stripe, StripeSlot& slot) const;
+
+        u32 mWidth;
+        u32 mHeight;
+        u32 mStripeHeight {64};
+        Color mBackground {Colors::White};
+        JobSystem* mJobSystem {nullptr};
+
+        vector<u32> mStripeStart;     // First entry of each stripe in mStripeCommands, plus one past the end
+        vector<u32> mStripeCommands;  // Command sequences per stripe, in submission order
+    };
+}  // namespace X
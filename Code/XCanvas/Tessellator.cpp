@@ -0,0 +1,89 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "Tessellator.hpp"
+
+#include <cmath>
+
+namespace X::Tessellator {
+    u32 CountVertices(const DrawCommand& command) {
+        const bool filled = command.pipeline == Pipeline::Triangles;
+        switch (command.shape) {
+            case ShapeType::Line:
+                return 2;
+            case ShapeType::Rectangle:
+                return filled ? 6 : 8;
+            case ShapeType::Circle: {
+                const auto segments = CAST<u32>(command.params[3]);
+                return filled ? segments * 3 : segments * 2;
+            }
+            case ShapeType::Polygon:
+                return filled ? (command.pointCount - 2) * 3 : command.pointCount * 2;
+        }
+        return 0;
+    }
+
+    void Tessellate(const DrawCommand& command, const vector<Point>& points, Vertex* out) {
+        const bool filled = command.pipeline == Pipeline::Triangles;
+        const u32 color   = command.color;
+        const f32* p      = command.params;
+
+        auto emit = [&out, color](f32 x, f32 y) { *out++ = {x, y, color}; };
+
+        switch (command.shape) {
+            case ShapeType::Line: {
+                emit(p[0], p[1]);
+                emit(p[2], p[3]);
+            } break;
+
+            case ShapeType::Rectangle: {
+                const f32 x0 = p[0], y0 = p[1];
+                const f32 x1 = p[0] + p[2], y1 = p[1] + p[3];
+                if (filled) {
+                    // Two triangles for filled rectangle
+                    emit(x0, y0), emit(x1, y0), emit(x1, y1);
+                    emit(x0, y0), emit(x1, y1), emit(x0, y1);
+                } else {
+                    // Line list outline
+                    emit(x0, y0), emit(x1, y0);
+                    emit(x1, y0), emit(x1, y1);
+                    emit(x1, y1), emit(x0, y1);
+                    emit(x0, y1), emit(x0, y0);
+                }
+            } break;
+
+            case ShapeType::Circle: {
+                const f32 cx = p[0], cy = p[1], radius = p[2];
+                const auto segments = CAST<u32>(p[3]);
+                const f32 step      = 2.0f * CAST<f32>(M_PI) / CAST<f32>(segments);
+
+                f32 prevX = cx + radius, prevY = cy;
+                for (u32 i = 1; i <= segments; ++i) {
+                    const f32 angle = step * CAST<f32>(i);
+                    const f32 x     = i == segments ? cx + radius : cx + radius * std::cos(angle);
+                    const f32 y     = i == segments ? cy : cy + radius * std::sin(angle);
+                    if (filled) { emit(cx, cy); }
+                    emit(prevX, prevY), emit(x, y);
+                    prevX = x, prevY = y;
+                }
+            } break;
+
+            case ShapeType::Polygon: {
+                const Point* poly = points.data() + command.firstPoint;
+                const u32 count   = command.pointCount;
+                if (filled) {
+                    // Triangle fan expanded to a list (works for convex polygons)
+                    for (u32 i = 1; i + 1 < count; ++i) {
+                        emit(poly[0].x, poly[0].y), emit(poly[i].x, poly[i].y), emit(poly[i + 1].x, poly[i + 1].y);
+                    }
+                } else {
+                    for (u32 i = 0; i < count; ++i) {
+                        const Point& next = poly[(i + 1) % count];
+                        emit(poly[i].x, poly[i].y), emit(next.x, next.y);
+                    }
+                }
+            } break;
+        }
+    }
+}  // namespace X::Tessellator
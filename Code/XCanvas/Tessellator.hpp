@@ -0,0 +1,32 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "CommandQueue.hpp"
+
+namespace X {
+    /// @brief Screen-space vertex as uploaded to the GPU
+    struct Vertex {
+        f32 x, y;
+        u32 color;  // Packed RGBA8
+    };
+
+    /// @brief A run of consecutive vertices drawn with the same pipeline and blend state
+    struct DrawBatch {
+        Pipeline pipeline;
+        BlendMode blend;
+        u32 state;  // DrawCommand::GetState() of every command in the batch
+        u32 firstVertex;
+        u32 vertexCount;
+    };
+
+    namespace Tessellator {
+        /// @brief Exact number of vertices Tessellate() will emit for @p command
+        X_ND u32 CountVertices(const DrawCommand& command);
+
+        /// @brief Expand a command into triangle-list or line-list vertices, written starting at @p out
+        void Tessellate(const DrawCommand& command, const vector<Point>& points, Vertex* out);
+    }  // namespace Tessellator
+}  // namespace X
@@ -0,0 +1,54 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#pragma once
+
+#include "Shared.hpp"
+
+#include <atomic>
+
+namespace X {
+    /**
+     * @brief Lock-free single-producer/single-consumer handoff of the latest value.
+     *
+     * The writer fills GetWriteBuffer() and calls Publish(); the reader calls Acquire() and, if it returns true,
+     * reads GetReadBuffer(). Neither side ever blocks: the three slots rotate through one atomic index, so the
+     * writer always has a free slot and the reader always sees the most recently published one. Unread
+     * publications are overwritten, never queued. Slots are reused, not cleared, so containers keep their capacity.
+     */
+    template<typename T>
+    class TripleBuffer {
+    public:
+        X_ND T& GetWriteBuffer() {
+            return mBuffers[mWrite];
+        }
+
+        X_ND T& GetReadBuffer() {
+            return mBuffers[mRead];
+        }
+
+        /// @brief Hand the write slot to the reader and take over the slot it gave back
+        void Publish() {
+            const u8 previous = mShared.exchange(CAST<u8>(mWrite | kFreshBit), std::memory_order_acq_rel);
+            mWrite            = previous & kIndexMask;
+        }
+
+        /// @brief Swap in the newest published slot. Returns false if nothing was published since the last call.
+        bool Acquire() {
+            if ((mShared.load(std::memory_order_relaxed) & kFreshBit) == 0) return false;
+            const u8 previous = mShared.exchange(mRead, std::memory_order_acq_rel);
+            mRead             = previous & kIndexMask;
+            return true;
+        }
+
+    private:
+        static constexpr u8 kIndexMask = 0x3;
+        static constexpr u8 kFreshBit  = 0x4;
+
+        T mBuffers[3];
+        alignas(64) u8 mWrite {0};
+        alignas(64) u8 mRead {1};
+        alignas(64) std::atomic<u8> mShared {2};
+    };
+}  // namespace X
@@ -4,16 +4,38 @@
 
 #include "XCanvas/Application.hpp"
 #include "XCanvas/Canvas.hpp"
+#include "XCanvas/Clock.hpp"
+#include "XCanvas/SharedCanvas.hpp"
 
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
 #include <random>
+#include <thread>
+
+#if !defined(_WIN32)
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
 
 namespace X {
-    static f32 RandomInRange(f32 min, f32 max) {
+    /// @brief Parse a positive count from the command line, reporting anything else to stderr
+    static bool ParseCount(const char* text, u32& count) {
+        char* end       = nullptr;
+        const u64 value = std::strtoull(text, &end, 10);
+        if (!std::isdigit(CAST<u8>(text[0])) || *end != '\0' || value == 0 || value > UINT32_MAX) {
+            std::cerr << "Expected a positive count, got '" << text << "'\n";
+            return false;
+        }
+        count = CAST<u32>(value);
+        return true;
+    }
+
+    static f32 RandomInRange(std::mt19937_64& gen, f32 min, f32 max) {
         X_ASSERT(min != max, "RandomInRange() - min cannot equal max!");
 
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
         std::uniform_real_distribution<f32> dis(min, max);
 
         return dis(gen);
@@ -25,19 +47,59 @@ namespace X {
         Color color;
         f32 radius;
         f32 speed;
+        Point previous {0, 0};  // Position before the last simulation step
 
-        void Draw(Canvas* canvas) const {
+        void Draw(Canvas* canvas, f32 alpha) const {
             canvas->SetFillColor(color);
-            canvas->DrawCircle(position.x, position.y, radius, 32);
+            canvas->DrawCircle(Math::Lerp(previous.x, position.x, alpha),
+                               Math::Lerp(previous.y, position.y, alpha),
+                               radius,
+                               32);
         }
     };
 
     class TestbedApp final : public Application {
     public:
-        explicit TestbedApp(i32 argc, char* argv[]) : Application(argc, argv, "Testbed") {}
+        explicit TestbedApp(i32 argc, char* argv[]) : Application(argc, argv, "Testbed") {
+            // Simulate at a constant 120 Hz so hitches can't make circles tunnel through the walls
+            SetFixedTimestep(1.0 / 120.0);
+
+            // --record <file> captures a session, --replay <file> reruns it hidden and uncapped for benchmarking.
+            // --headless renders without a window (pair it with --replay) and --output <prefix> saves its frames.
+            // --software rasterizes headless frames on the CPU instead of through EGL, --null discards them to time
+            // just the CPU side of the canvas. --capture <command> streams raw YUV420 frames into the command's stdin,
+            // e.g. "ffmpeg -f rawvideo -pix_fmt yuv420p -video_size 1280x720 -framerate 60 -i - session.mp4".
+            // --animation <file.gif|file.png> collects headless frames into an animated GIF or APNG.
+            // --record-canvas <file> saves every frame's draw calls, --replay-canvas <file> paints them back.
+            // --serve-canvas <socket> paints the frames a RemoteCanvas in another process sends to the socket,
+            // --serve-shared-canvas <name> those a SharedCanvas on this host writes to the shared memory ring.
+            const auto args = GetArgs();
+            for (size_t i = 1; i < args.size(); ++i) {
+                if (args[i] == "--headless") { SetHeadless(true); }
+                if (args[i] == "--software") { SetCanvasBackend(CanvasBackend::Software); }
+                if (args[i] == "--null") { SetCanvasBackend(CanvasBackend::Null); }
+                if (i + 1 == args.size()) continue;
+                if (args[i] == "--record") { RecordInput(args[i + 1]); }
+                if (args[i] == "--replay") { ReplayInput(args[i + 1]); }
+                if (args[i] == "--output") { SetFrameOutput(args[i + 1]); }
+                if (args[i] == "--record-canvas") { RecordCanvas(args[i + 1]); }
+                if (args[i] == "--replay-canvas") { ReplayCanvas(args[i + 1]); }
+                if (args[i] == "--serve-canvas") { ServeRemoteCanvas(args[i + 1]); }
+                if (args[i] == "--serve-shared-canvas") { ServeSharedCanvas(args[i + 1]); }
+                if (args[i] == "--animation") {
+                    const bool gif = args[i + 1].ends_with(".gif");
+                    SetAnimationOutput(args[i + 1], gif ? AnimationFormat::GIF : AnimationFormat::APNG);
+                }
+                if (args[i] == "--capture") {
+                    auto capture = make_unique<FrameCapture>();
+                    if (capture->OpenProcess(args[i + 1])) { SetFrameCapture(std::move(capture)); }
+                }
+            }
+        }
 
         void OnStartup() override {
             Application::OnStartup();
+            mRandom.seed(GetSeed());
 
             const Circle c1 = {{100, 100}, {2, 2}, Colors::Green, 32.0f, 100.0f};
             const Circle c2 = {{200, 200},
@@ -51,10 +113,15 @@ namespace X {
 
             mCircles.push_back(c1);
             mCircles.push_back(c2);
+            for (auto& circle : mCircles) {
+                circle.previous = circle.position;
+            }
         }
 
         void OnUpdate(f32 dT) override {
             for (auto& circle : mCircles) {
+                circle.previous = circle.position;
+
                 // Simple, naive approach to collision detection with canvas borders.
                 // Only works for perfectly perpendicular walls
                 if (circle.position.x <= circle.radius || circle.position.x >= (f32)mWidth - circle.radius) {
@@ -77,13 +144,13 @@ namespace X {
             }
         }
 
-        void OnPaint(Canvas* canvas) override {
+        void OnPaint(Canvas* canvas, f32 alpha) override {
             canvas->Begin();
             {
                 canvas->Clear(Color("#2e2e2e"));
 
                 for (const auto& circle : mCircles) {
-                    circle.Draw(canvas);
+                    circle.Draw(canvas, alpha);
                 }
             }
             canvas->End();
@@ -91,34 +158,256 @@ namespace X {
 
         void OnKeyPress(u32 keyCode) override {
             if (keyCode == Keys::Escape) { Quit(); }
+            if (keyCode == Keys::F12) { SaveScreenshot("screenshot_" + std::to_string(mScreenshotCount++) + ".png"); }
             if (keyCode == Keys::Space) {
                 // Generate a random circle with random initial properties and spawn it
-                const f32 radius  = RandomInRange(8.0f, 128.0f);
-                f32 initPositionX = RandomInRange(radius, (f32)mWidth - radius);
-                f32 initPositionY = RandomInRange(radius, (f32)mHeight - radius);
-                const Color color(RandomInRange(0.0f, 1.0f),
-                                  RandomInRange(0.0f, 1.0f),
-                                  RandomInRange(0.0f, 1.0f),
+                const f32 radius  = RandomInRange(mRandom, 8.0f, 128.0f);
+                f32 initPositionX = RandomInRange(mRandom, radius, (f32)mWidth - radius);
+                f32 initPositionY = RandomInRange(mRandom, radius, (f32)mHeight - radius);
+                const Color color(RandomInRange(mRandom, 0.0f, 1.0f),
+                                  RandomInRange(mRandom, 0.0f, 1.0f),
+                                  RandomInRange(mRandom, 0.0f, 1.0f),
                                   1.0f);
-                const f32 speed   = RandomInRange(10.0f, 300.0f);
-                f32 initVelocityX = RandomInRange(-10.f, 10.f);
-                f32 initVelocityY = RandomInRange(-10.0f, 10.0f);
+                const f32 speed   = RandomInRange(mRandom, 10.0f, 300.0f);
+                f32 initVelocityX = RandomInRange(mRandom, -10.f, 10.f);
+                f32 initVelocityY = RandomInRange(mRandom, -10.0f, 10.0f);
 
                 const Circle newCircle {{initPositionX, initPositionY},
                                         {initVelocityX, initVelocityY},
                                         color,
                                         radius,
-                                        speed};
+                                        speed,
+                                        {initPositionX, initPositionY}};
                 mCircles.push_back(newCircle);
             }
         }
 
     private:
         vector<Circle> mCircles {};
+        std::mt19937_64 mRandom;
+        u32 mScreenshotCount {0};
+    };
+
+    /// @brief Headless app that paints one fixed scene of mixed shapes and hands back the first frame it renders
+    class BackendComparisonApp final : public Application {
+    public:
+        BackendComparisonApp(i32 argc, char* argv[], CanvasBackend backend) : Application(argc, argv, "Testbed") {
+            SetHeadless(true);
+            SetSize(640, 480);
+            SetCanvasBackend(backend);
+            SetFrameCallback([this](const Image& frame, u64) {
+                mFrame.assign(frame.GetPixels(), frame.GetPixels() + frame.GetHeight() * frame.GetStride());
+                Quit();
+            });
+        }
+
+        void OnPaint(Canvas* canvas) override {
+            std::mt19937_64 random(1);
+            canvas->Begin();
+            canvas->Clear(Color("#2e2e2e"));
+            for (u32 i = 0; i < 200; ++i) {
+                // Every third shape is translucent to cover blending as well as coverage
+                const Color color(RandomInRange(random, 0.0f, 1.0f),
+                                  RandomInRange(random, 0.0f, 1.0f),
+                                  RandomInRange(random, 0.0f, 1.0f),
+                                  i % 3 == 0 ? 0.5f : 1.0f);
+                const f32 x = RandomInRange(random, 0.0f, 640.0f);
+                const f32 y = RandomInRange(random, 0.0f, 480.0f);
+                canvas->SetFillColor(color);
+                canvas->SetStrokeColor(color);
+
+                switch (i % 5) {
+                    case 0: {
+                        const f32 width  = RandomInRange(random, 4.0f, 160.0f);
+                        const f32 height = RandomInRange(random, 4.0f, 120.0f);
+                        canvas->DrawRectangle(x, y, width, height);
+                    } break;
+                    case 1:
+                        canvas->DrawCircle(x, y, RandomInRange(random, 4.0f, 64.0f), 32);
+                        break;
+                    case 2:
+                        canvas->DrawPolygon({{x, y}, {x + 120.0f, y + 20.0f}, {x + 50.0f, y + 110.0f}});
+                        break;
+                    case 3:
+                        canvas->DrawCircle(x, y, RandomInRange(random, 4.0f, 64.0f), 24, false);
+                        break;
+                    default: {
+                        const f32 endX = RandomInRange(random, 0.0f, 640.0f);
+                        const f32 endY = RandomInRange(random, 0.0f, 480.0f);
+                        canvas->DrawLine(x, y, endX, endY);
+                    } break;
+                }
+            }
+            canvas->End();
+        }
+
+        X_ND const vector<u8>& GetFrame() const {
+            return mFrame;
+        }
+
+    private:
+        vector<u8> mFrame;
     };
+
+    /// @brief Render the same scene through OpenGL and the software rasterizer and compare the pixels
+    static i32 RunBackendComparison(i32 argc, char* argv[]) {
+        vector<u8> frames[2];
+        const CanvasBackend backends[2] = {CanvasBackend::OpenGL, CanvasBackend::Software};
+        for (u32 i = 0; i < 2; ++i) {
+            try {
+                BackendComparisonApp app(argc, argv, backends[i]);
+                app.Run();
+                frames[i] = app.GetFrame();
+            } catch (const std::exception& e) {
+                std::cerr << "Backend comparison failed: " << e.what() << "\n";
+                return EXIT_FAILURE;
+            }
+        }
+        if (frames[0].empty() || frames[0].size() != frames[1].size()) {
+            std::cerr << "Backend comparison failed: a backend delivered no frame\n";
+            return EXIT_FAILURE;
+        }
+
+        // Blending rounds differently on the GPU, so channels may differ by a couple of steps. Fills should cover
+        // the same pixels exactly; lines are stepped differently and may disagree on the odd pixel.
+        static constexpr i32 kChannelTolerance  = 2;
+        static constexpr f64 kMaxDifferingRatio = 0.001;
+
+        u64 differing = 0;
+        for (size_t pixel = 0; pixel < frames[0].size(); pixel += 4) {
+            for (size_t channel = pixel; channel < pixel + 4; ++channel) {
+                if (std::abs(CAST<i32>(frames[0][channel]) - CAST<i32>(frames[1][channel])) > kChannelTolerance) {
+                    ++differing;
+                    break;
+                }
+            }
+        }
+
+        const u64 pixels = frames[0].size() / 4;
+        std::cout << "Software vs OpenGL: " << differing << " of " << pixels << " pixels differ by more than "
+                  << kChannelTolerance << "\n";
+        return CAST<f64>(differing) <= kMaxDifferingRatio * CAST<f64>(pixels) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    /// @brief Time Canvas::End() on the null device for a fixed scene, so only vertex generation is measured
+    static i32 RunTessellationBenchmark(u32 frames) {
+        // Everything is on screen and culling and reordering are off, so End() is left sizing and tessellating the
+        // commands. The scene is recorded once up front; Execute() only copies it in.
+        CommandList scene;
+        std::mt19937_64 random(1);
+        for (u32 i = 0; i < 10000; ++i) {
+            const f32 x = RandomInRange(random, 64.0f, 1216.0f);
+            const f32 y = RandomInRange(random, 64.0f, 656.0f);
+            scene.SetFillColor(Color(RandomInRange(random, 0.0f, 1.0f), 0.5f, 0.5f, 1.0f));
+            scene.SetStrokeColor(Colors::White);
+            switch (i % 4) {
+                case 0:
+                    scene.DrawCircle(x, y, RandomInRange(random, 4.0f, 64.0f), 64);
+                    break;
+                case 1:
+                    scene.DrawRectangle(x - 32.0f, y - 32.0f, 64.0f, 64.0f, false);
+                    break;
+                case 2:
+                    scene.DrawPolygon({{x, y}, {x + 40.0f, y + 8.0f}, {x + 48.0f, y + 40.0f}, {x, y + 56.0f}});
+                    break;
+                default:
+                    scene.DrawLine(x, y, x + 48.0f, y - 48.0f);
+                    break;
+            }
+        }
+
+        JobSystem jobs;
+        for (JobSystem* system : {CAST<JobSystem*>(nullptr), &jobs}) {
+            Canvas canvas(1280, 720, CanvasBackend::Null);
+            canvas.SetCommandReordering(false);
+            canvas.SetOcclusionCulling(false);
+            canvas.SetJobSystem(system);
+
+            Histogram times(1e-6, 100000);
+            for (u32 frame = 0; frame < frames; ++frame) {
+                canvas.Begin();
+                canvas.Execute(scene);
+                const f64 start = Clock::Now();
+                canvas.End();
+                times.Add(Clock::Now() - start);
+            }
+
+            std::cout << std::fixed << std::setprecision(1) << "Tessellation of " << scene.GetQueue().GetCount()
+                      << " commands" << (system ? " on the job system" : "") << ": mean "
+                      << times.GetMean() * 1e6 << " us, p50 " << times.GetPercentile(0.5) * 1e6 << " us, p99 "
+                      << times.GetPercentile(0.99) * 1e6 << " us, min " << times.GetMin() * 1e6 << " us\n";
+        }
+        return EXIT_SUCCESS;
+    }
+
+#if !defined(_WIN32)
+    /// @brief Time frames a child process submits through a SharedCanvas, letting the renderer sleep between them
+    static i32 RunSharedCanvasBenchmark(u32 frames) {
+        const string name = "/xcanvas-benchmark-" + std::to_string(getpid());
+        SharedCanvasServer server(name);
+
+        const pid_t producer = fork();
+        if (producer == 0) {
+            SharedCanvas canvas(1280, 720);
+            if (!canvas.Connect(name)) { _exit(EXIT_FAILURE); }
+
+            std::mt19937_64 random(1);
+            for (u32 frame = 0; frame < frames; ++frame) {
+                canvas.Begin();
+                canvas.Clear(Color("#2e2e2e"));
+                for (u32 i = 0; i < 200; ++i) {
+                    canvas.SetFillColor(Color(RandomInRange(random, 0.0f, 1.0f),
+                                              RandomInRange(random, 0.0f, 1.0f),
+                                              RandomInRange(random, 0.0f, 1.0f),
+                                              1.0f));
+                    canvas.DrawCircle(RandomInRange(random, 0.0f, 1280.0f),
+                                      RandomInRange(random, 0.0f, 720.0f),
+                                      RandomInRange(random, 8.0f, 64.0f),
+                                      32);
+                }
+                canvas.End();
+
+                // Long enough for the renderer to go back to sleep, so every frame pays for a wakeup
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+            }
+            _exit(EXIT_SUCCESS);
+        }
+
+        Canvas canvas(1280, 720, CanvasBackend::Null);
+        while (server.GetFramesExecuted() < frames && server.WaitForFrame(5.0)) {
+            server.ExecuteFrame(canvas);
+        }
+        waitpid(producer, nullptr, 0);
+
+        const Histogram& latencies = server.GetLatencies();
+        std::cout << std::fixed << std::setprecision(1) << "Shared canvas submission latency over "
+                  << latencies.GetCount() << " frames: mean " << latencies.GetMean() * 1e6 << " us, p50 "
+                  << latencies.GetPercentile(0.5) * 1e6 << " us, p99 " << latencies.GetPercentile(0.99) * 1e6
+                  << " us, max " << latencies.GetMax() * 1e6 << " us\n";
+        return latencies.GetCount() == frames ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+#endif
 }  // namespace X
 
 int main(int argc, char* argv[]) {
+    // --benchmark-tessellation [frames] times Canvas::End() on the null device with and without the job system
+    if (argc > 1 && std::string(argv[1]) == "--benchmark-tessellation") {
+        X::u32 frames = 200;
+        if (argc > 2 && !X::ParseCount(argv[2], frames)) { return EXIT_FAILURE; }
+        return X::RunTessellationBenchmark(frames);
+    }
+
+    // --compare-backends renders a fixed scene headless on OpenGL and the software rasterizer, fails if they disagree
+    if (argc > 1 && std::string(argv[1]) == "--compare-backends") { return X::RunBackendComparison(argc, argv); }
+
+#if !defined(_WIN32)
+    // --benchmark-shared-canvas [frames] measures cross-process submission latency through a SharedCanvas and exits
+    if (argc > 1 && std::string(argv[1]) == "--benchmark-shared-canvas") {
+        X::u32 frames = 1000;
+        if (argc > 2 && !X::ParseCount(argv[2], frames)) { return EXIT_FAILURE; }
+        return X::RunSharedCanvasBenchmark(frames);
+    }
+#endif
     X::TestbedApp app(argc, argv);
     return app.Run();
 }
\ No newline at end of file
@@ -0,0 +1,282 @@
+// Author: Jake Rieger
+// Created: 10/19/26.
+//
+
+#include "XCanvas/Application.hpp"
+#include "XCanvas/Canvas.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+namespace X {
+    // Neither side is a multiple of the software rasterizer's 64 pixel tiles, so partial tiles are covered too
+    static constexpr u32 kSceneWidth  = 160;
+    static constexpr u32 kSceneHeight = 112;
+
+    // Blending rounds differently on the GPU and lines are stepped differently, so against OpenGL a channel may be
+    // off by a couple of steps and the odd line pixel may differ. The software rasterizer must reproduce its reference
+    // images exactly, except for the odd edge pixel where sin() and cos() round differently on another C library.
+    static constexpr i32 kOpenGLTolerance         = 2;
+    static constexpr f64 kOpenGLDifferingRatio    = 0.005;
+    static constexpr i32 kReferenceTolerance      = 0;
+    static constexpr f64 kReferenceDifferingRatio = 0.0005;
+
+    /// @brief Unlike std::uniform_real_distribution, gives the same sequence with every standard library
+    static f32 RandomInRange(std::mt19937& random, f32 min, f32 max) {
+        return min + (max - min) * CAST<f32>(random() >> 8) / CAST<f32>(1u << 24);
+    }
+
+    /// @brief A mix of every shape, a third of them translucent
+    static void DrawShapes(Canvas& canvas) {
+        std::mt19937 random(1);
+        canvas.Clear(Color("#2e2e2e"));
+        for (u32 i = 0; i < 60; ++i) {
+            const Color color(RandomInRange(random, 0.0f, 1.0f),
+                              RandomInRange(random, 0.0f, 1.0f),
+                              RandomInRange(random, 0.0f, 1.0f),
+                              i % 3 == 0 ? 0.5f : 1.0f);
+            const f32 x = RandomInRange(random, 0.0f, CAST<f32>(kSceneWidth));
+            const f32 y = RandomInRange(random, 0.0f, CAST<f32>(kSceneHeight));
+            canvas.SetFillColor(color);
+            canvas.SetStrokeColor(color);
+
+            switch (i % 5) {
+                case 0:
+                    canvas.DrawRectangle(x, y, RandomInRange(random, 2.0f, 60.0f), RandomInRange(random, 2.0f, 40.0f));
+                    break;
+                case 1:
+                    canvas.DrawCircle(x, y, RandomInRange(random, 2.0f, 30.0f), 32);
+                    break;
+                case 2:
+                    canvas.DrawPolygon({{x, y}, {x + 40.0f, y + 8.0f}, {x + 16.0f, y + 36.0f}});
+                    break;
+                case 3:
+                    canvas.DrawCircle(x, y, RandomInRange(random, 2.0f, 30.0f), 24, false);
+                    break;
+                default:
+                    canvas.DrawLine(x,
+                                    y,
+                                    RandomInRange(random, 0.0f, CAST<f32>(kSceneWidth)),
+                                    RandomInRange(random, 0.0f, CAST<f32>(kSceneHeight)));
+                    break;
+            }
+        }
+    }
+
+    /// @brief Edges on pixel centers and tile borders, where the fill rule decides which pixels are covered
+    static void DrawEdges(Canvas& canvas) {
+        canvas.Clear(Colors::Black);
+
+        // Translucent neighbours sharing edges: a pixel covered twice or not at all shows as a seam
+        canvas.SetFillColor(Color(1.0f, 0.5f, 0.25f, 0.5f));
+        for (u32 i = 0; i < 8; ++i) {
+            canvas.DrawRectangle(8.5f + CAST<f32>(i) * 7.5f, 8.0f, 7.5f, 20.0f);
+        }
+        canvas.DrawPolygon({{8.0f, 40.0f}, {72.0f, 40.0f}, {72.0f, 72.0f}, {8.0f, 72.0f}, {40.0f, 56.0f}});
+
+        // Straddling the tile borders at x = 64 and 128, and y = 64
+        canvas.SetFillColor(Color(0.25f, 0.75f, 1.0f, 0.5f));
+        canvas.DrawRectangle(60.0f, 60.0f, 8.0f, 8.0f);
+        canvas.DrawRectangle(124.5f, 4.5f, 8.0f, 100.0f);
+        canvas.DrawCircle(64.0f, 64.0f, 12.0f, 16);
+
+        // Slivers thinner than a pixel, which may cover a pixel center or fall between them
+        canvas.SetFillColor(Colors::White);
+        canvas.DrawPolygon({{80.0f, 8.0f}, {156.0f, 9.0f}, {80.0f, 9.5f}});
+        canvas.DrawRectangle(80.0f, 20.25f, 70.0f, 0.5f);
+        canvas.DrawRectangle(80.25f, 30.0f, 0.5f, 30.0f);
+
+        // Axis aligned and diagonal strokes ending on pixel centers
+        canvas.SetStrokeColor(Color(0.5f, 1.0f, 0.5f, 1.0f));
+        canvas.DrawLine(80.5f, 70.5f, 150.5f, 70.5f);
+        canvas.DrawLine(90.5f, 75.5f, 90.5f, 108.5f);
+        canvas.DrawLine(100.0f, 76.0f, 132.0f, 108.0f);
+        canvas.DrawRectangle(20.5f, 80.5f, 40.0f, 24.0f, false);
+    }
+
+    /// @brief Stacked translucent spans of every length from one pixel to the full width, for the SIMD kernels
+    static void DrawSpans(Canvas& canvas) {
+        canvas.Clear(Color(0.1f, 0.2f, 0.3f, 1.0f));
+        for (u32 i = 0; i < 20; ++i) {
+            const f32 t = CAST<f32>(i) / 20.0f;
+            canvas.SetFillColor(Color(t, 0.5f, 1.0f - t, 0.1f + 0.8f * t));
+            canvas.DrawRectangle(CAST<f32>(i), CAST<f32>(i) * 5.0f, CAST<f32>(i + 1), 4.0f);
+            canvas.DrawRectangle(CAST<f32>(i) * 3.0f, 0.0f, CAST<f32>(kSceneWidth) - CAST<f32>(i) * 6.0f, 112.0f);
+        }
+        canvas.SetFillColor(Color(1.0f, 1.0f, 1.0f, 0.75f));
+        canvas.DrawCircle(100.0f, 56.0f, 50.0f, 64);
+        canvas.SetFillColor(Color(0.0f, 0.0f, 0.0f, 0.25f));
+        canvas.DrawPolygon({{0.0f, 112.0f}, {160.0f, 0.0f}, {160.0f, 112.0f}});
+    }
+
+    using Scene = void (*)(Canvas& canvas);
+
+    struct SceneInfo {
+        const char* name;
+        Scene draw;
+    };
+
+    static constexpr SceneInfo kScenes[] = {
+      {"Shapes", DrawShapes},
+      {"Edges", DrawEdges},
+      {"Spans", DrawSpans},
+    };
+
+    class SceneApp final : public Application {
+    public:
+        SceneApp(i32 argc, char* argv[], CanvasBackend backend, Scene scene)
+            : Application(argc, argv, "CanvasBackendTests"), mScene(scene) {
+            SetHeadless(true);
+            SetSize(kSceneWidth, kSceneHeight);
+            SetCanvasBackend(backend);
+            SetFrameCallback([this](const Image& frame, u64) {
+                const size_t rowSize = CAST<size_t>(frame.GetWidth()) * 4;
+                mFrame.resize(rowSize * frame.GetHeight());
+                for (u32 y = 0; y < frame.GetHeight(); ++y) {
+                    std::memcpy(mFrame.data() + y * rowSize, frame.GetPixels() + y * frame.GetStride(), rowSize);
+                }
+                Quit();
+            });
+        }
+
+        void OnPaint(Canvas* canvas) override {
+            canvas->Begin();
+            mScene(*canvas);
+            canvas->End();
+        }
+
+        X_ND const vector<u8>& GetFrame() const {
+            return mFrame;
+        }
+
+    private:
+        Scene mScene;
+        vector<u8> mFrame;
+    };
+
+    /// @brief Render @p scene into tightly packed RGBA rows. Throws std::runtime_error if the backend can't start.
+    static bool Render(i32 argc, char* argv[], CanvasBackend backend, Scene scene, vector<u8>& pixels) {
+        SceneApp app(argc, argv, backend, scene);
+        app.Run();
+        pixels = app.GetFrame();
+        return pixels.size() == CAST<size_t>(kSceneWidth) * kSceneHeight * 4;
+    }
+
+    /// @brief Reference images are binary PPMs; alpha isn't stored, every scene is drawn over an opaque clear
+    static bool ReadReference(const string& path, vector<u8>& pixels) {
+        std::ifstream file(path, std::ios::binary);
+        string magic;
+        u32 width = 0, height = 0, maxValue = 0;
+        file >> magic >> width >> height >> maxValue;
+        file.get();
+        if (!file || magic != "P6" || width != kSceneWidth || height != kSceneHeight || maxValue != 255) return false;
+
+        pixels.resize(CAST<size_t>(width) * height * 4);
+        for (size_t pixel = 0; pixel < pixels.size(); pixel += 4) {
+            file.read(RCAST<char*>(pixels.data() + pixel), 3);
+            pixels[pixel + 3] = 255;
+        }
+        return CAST<bool>(file);
+    }
+
+    static bool WriteReference(const string& path, const vector<u8>& pixels) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << "P6\n" << kSceneWidth << ' ' << kSceneHeight << "\n255\n";
+        for (size_t pixel = 0; pixel < pixels.size(); pixel += 4) {
+            file.write(RCAST<const char*>(pixels.data() + pixel), 3);
+        }
+        return CAST<bool>(file);
+    }
+
+    /// @brief Whether at most @p ratio of the pixels in @p actual differ from @p expected by more than @p tolerance,
+    /// reporting how far off it is
+    static bool Compare(
+      const string& what, const vector<u8>& actual, const vector<u8>& expected, i32 tolerance, f64 ratio) {
+        u64 differing = 0;
+        for (size_t pixel = 0; pixel < actual.size(); pixel += 4) {
+            for (size_t channel = pixel; channel < pixel + 4; ++channel) {
+                if (std::abs(CAST<i32>(actual[channel]) - CAST<i32>(expected[channel])) > tolerance) {
+                    ++differing;
+                    break;
+                }
+            }
+        }
+
+        const u64 pixels  = actual.size() / 4;
+        const bool passed = CAST<f64>(differing) <= ratio * CAST<f64>(pixels);
+        std::cout << (passed ? "PASS " : "FAIL ") << what << ": " << differing << " of " << pixels
+                  << " pixels differ by more than " << tolerance << "\n";
+        return passed;
+    }
+}  // namespace X
+
+// CanvasBackendTests <reference dir> [--update-references]
+//
+// Renders each scene with the software rasterizer and compares it against the reference image and, where a
+// headless OpenGL context can be created, against the OpenGL backend. --update-references rewrites the reference
+// images from the software rasterizer instead.
+int main(int argc, char* argv[]) {
+    using namespace X;
+
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <reference dir> [--update-references]\n";
+        return EXIT_FAILURE;
+    }
+    const string referenceDir = argv[1];
+    const bool update         = argc > 2 && string(argv[2]) == "--update-references";
+
+    bool passed = true;
+    bool openGL = true;
+    for (const SceneInfo& scene : kScenes) {
+        const string path = referenceDir + "/" + scene.name + ".ppm";
+        const string name = scene.name;
+
+        vector<u8> software;
+        bool rendered = false;
+        try {
+            rendered = Render(argc, argv, CanvasBackend::Software, scene.draw, software);
+        } catch (const std::exception& e) { std::cerr << e.what() << "\n"; }
+        if (!rendered) {
+            std::cout << "FAIL " << name << ": the software rasterizer delivered no frame\n";
+            passed = false;
+            continue;
+        }
+
+        if (update) {
+            if (!WriteReference(path, software)) {
+                std::cerr << "Failed to write " << path << "\n";
+                passed = false;
+            }
+            continue;
+        }
+
+        vector<u8> reference;
+        if (ReadReference(path, reference)) {
+            passed &= Compare(
+              name + ", software vs reference", software, reference, kReferenceTolerance, kReferenceDifferingRatio);
+        } else {
+            std::cout << "FAIL " << name << ": can't read reference image " << path << "\n";
+            passed = false;
+        }
+
+        if (!openGL) continue;
+        vector<u8> gpu;
+        try {
+            if (Render(argc, argv, CanvasBackend::OpenGL, scene.draw, gpu)) {
+                passed &= Compare(
+                  name + ", software vs OpenGL", software, gpu, kOpenGLTolerance, kOpenGLDifferingRatio);
+            } else {
+                std::cout << "FAIL " << name << ": the OpenGL backend delivered no frame\n";
+                passed = false;
+            }
+        } catch (const std::exception& e) {
+            // Without a GPU or EGL there is nothing to compare against, which isn't a failure of this code
+            std::cout << "SKIP software vs OpenGL: " << e.what() << "\n";
+            openGL = false;
+        }
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}